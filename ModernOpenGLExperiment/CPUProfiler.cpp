@@ -0,0 +1,158 @@
+#include "CPUProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+std::atomic<bool> CPUProfiler::enabled(false);
+
+std::mutex CPUProfiler::ringsMutex;
+std::vector<CPUProfiler::ThreadRing*> CPUProfiler::rings;
+
+PROFILER_THREAD_LOCAL CPUProfiler::ThreadRing* CPUProfiler::threadRing = NULL;
+PROFILER_THREAD_LOCAL char CPUProfiler::threadName[PROFILER_THREAD_NAME_LENGTH];
+
+CPUProfiler::ThreadRing* CPUProfiler::GetThreadRing() {
+    if (threadRing == NULL) {
+        ThreadRing* ring = new ThreadRing();
+
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        ring->threadId = rings.size();
+        strcpy(ring->name, threadName);
+        rings.push_back(ring);
+
+        threadRing = ring;
+    }
+
+    return threadRing;
+}
+
+void CPUProfiler::SetThreadName(const char* name) {
+    strncpy(threadName, name, PROFILER_THREAD_NAME_LENGTH - 1);
+    threadName[PROFILER_THREAD_NAME_LENGTH - 1] = '\0';
+
+    // Without a ring yet, the name goes in when the ring is made
+    if (threadRing == NULL)
+        return;
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    strcpy(threadRing->name, threadName);
+}
+
+void CPUProfiler::Record(const char* name, uint64_t start, uint64_t end) {
+    ThreadRing* ring = GetThreadRing();
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+
+    ProfileEvent_t& event = ring->events[head & (PROFILER_RING_SIZE - 1)];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+
+    // Publishes the event to WriteChromeTrace
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+// Zone names are literals, but quotes or backslashes in one would still break the JSON
+static void WriteJSONString(FILE* file, const char* str) {
+    fputc('"', file);
+
+    for (; *str != '\0'; ++str) {
+        if (*str == '"' || *str == '\\')
+            fputc('\\', file);
+
+        if ((unsigned char)*str >= 0x20)
+            fputc(*str, file);
+    }
+
+    fputc('"', file);
+}
+
+bool CPUProfiler::WriteChromeTrace(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (file == NULL)
+        return false;
+
+    std::vector<ThreadRing*> threads;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        threads = rings;
+    }
+
+    // Times are relative to the earliest zone, in microseconds
+    uint64_t origin = UINT64_MAX;
+    std::vector<std::vector<ProfileEvent_t> > threadEvents(threads.size());
+
+    for (size_t t=0; t<threads.size(); ++t) {
+        ThreadRing* ring = threads[t];
+        std::vector<ProfileEvent_t>& events = threadEvents[t];
+
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = head > PROFILER_RING_SIZE ? head - PROFILER_RING_SIZE : 0;
+
+        for (uint64_t i=first; i<head; ++i)
+            events.push_back(ring->events[i & (PROFILER_RING_SIZE - 1)]);
+
+        // Anything the owner wrapped around onto while we were copying may be torn,
+        // including the slot it might be halfway through writing right now
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t newHead = ring->head.load(std::memory_order_relaxed);
+        uint64_t newFirst = newHead + 1 > PROFILER_RING_SIZE ? newHead + 1 - PROFILER_RING_SIZE : 0;
+
+        if (newFirst > first)
+            events.erase(events.begin(), events.begin() + (size_t)std::min(newFirst - first, (uint64_t)events.size()));
+
+        for (size_t i=0; i<events.size(); ++i)
+            origin = std::min(origin, events[i].start);
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    bool first = true;
+    for (size_t t=0; t<threads.size(); ++t) {
+        const ThreadRing* ring = threads[t];
+
+        char name[PROFILER_THREAD_NAME_LENGTH];
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            if (ring->name[0] != '\0')
+                strcpy(name, ring->name);
+            else
+                sprintf(name, "Thread %u", ring->threadId);
+        }
+
+        fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+            first ? "" : ",\n", ring->threadId);
+        WriteJSONString(file, name);
+        fprintf(file, "}}");
+        first = false;
+
+        const std::vector<ProfileEvent_t>& events = threadEvents[t];
+        for (size_t i=0; i<events.size(); ++i) {
+            const ProfileEvent_t& event = events[i];
+
+            fprintf(file, ",\n{\"ph\":\"X\",\"name\":");
+            WriteJSONString(file, event.name);
+            fprintf(file, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", ring->threadId,
+                Clock::ToMicroseconds(event.start - origin),
+                Clock::ToMicroseconds(event.end - event.start));
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+
+    bool ok = !ferror(file);
+    fclose(file);
+
+    return ok;
+}
+
+void CPUProfiler::Shutdown() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+
+    for (size_t i=0; i<rings.size(); ++i)
+        delete rings[i];
+
+    rings.clear();
+    threadRing = NULL;
+}
@@ -0,0 +1,131 @@
+#ifndef CPUPROFILER_H
+#define CPUPROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "Clock.h"
+
+// Zones each thread keeps before the oldest get overwritten; must be a power of two
+#define PROFILER_RING_SIZE 65536
+
+// Longest thread name kept, including the terminator
+#define PROFILER_THREAD_NAME_LENGTH 32
+
+#ifdef _MSC_VER
+#define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#define PROFILER_THREAD_LOCAL __thread
+#endif
+
+/**
+ * ProfileEvent_t - One finished zone, with its times from Clock::Now
+ */
+typedef struct {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+} ProfileEvent_t;
+
+/**
+ * CPUProfiler
+ * Records named, nestable zones of CPU time on any thread, to be exported as a Chrome
+ * trace (load it in chrome://tracing or Perfetto) for looking at startup and frame
+ * hitches.
+ *
+ * Each thread writes the zones it finishes into a ring buffer of its own, so recording
+ * never takes a lock or contends with other threads; the only locking is when a thread
+ * records its first zone and registers its ring. Once a ring fills up, new zones
+ * overwrite the oldest. Rings outlive their threads, so zones from threads that have
+ * already finished still end up in the trace.
+ *
+ * Recording is off until Enable is called, and costs next to nothing while it is. Rings
+ * are only allocated for threads that record a zone while it's on.
+ * Zone names aren't copied, so they have to outlive the profiler (string literals are ideal).
+ */
+class CPUProfiler {
+private:
+    typedef struct ThreadRing {
+        ProfileEvent_t events[PROFILER_RING_SIZE];
+
+        // Total events ever written; only the owning thread moves it
+        std::atomic<uint64_t> head;
+
+        uint32_t threadId;
+        char name[PROFILER_THREAD_NAME_LENGTH];
+
+        ThreadRing() : head(0), threadId(0) { name[0] = '\0'; }
+    } ThreadRing;
+
+    static std::atomic<bool> enabled;
+
+    static std::mutex ringsMutex;
+    static std::vector<ThreadRing*> rings;
+
+    static PROFILER_THREAD_LOCAL ThreadRing* threadRing;
+
+    // Kept until the thread gets a ring, which only happens once it records a zone
+    static PROFILER_THREAD_LOCAL char threadName[PROFILER_THREAD_NAME_LENGTH];
+
+    static ThreadRing* GetThreadRing();
+
+    CPUProfiler() {}
+
+public:
+    static void Enable(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * SetThreadName
+     * Names the calling thread in the trace. Threads without a name show up by number.
+     */
+    static void SetThreadName(const char* name);
+
+    /**
+     * Record
+     * Adds a finished zone to the calling thread's ring
+     */
+    static void Record(const char* name, uint64_t start, uint64_t end);
+
+    /**
+     * WriteChromeTrace
+     * Writes every zone still in any thread's ring to filename in the Chrome trace event
+     * JSON format. Can be called while other threads are recording; zones that get
+     * overwritten while they're being copied out are left out. Returns false if the
+     * file couldn't be written.
+     */
+    static bool WriteChromeTrace(const char* filename);
+
+    /**
+     * Shutdown
+     * Frees every thread's ring. No thread may record zones afterwards.
+     */
+    static void Shutdown();
+};
+
+/**
+ * CPUZone - Records the time between its construction and destruction as a zone
+ */
+class CPUZone {
+private:
+    const char* name;
+    uint64_t start;
+
+public:
+    CPUZone(const char* name) : name(name), start(CPUProfiler::IsEnabled() ? Clock::Now() : 0) {}
+
+    ~CPUZone() {
+        if (start != 0)
+            CPUProfiler::Record(name, start, Clock::Now());
+    }
+};
+
+#define PROFILE_ZONE_JOIN2(a, b) a##b
+#define PROFILE_ZONE_JOIN(a, b) PROFILE_ZONE_JOIN2(a, b)
+
+// Profiles the rest of the enclosing block
+#define PROFILE_ZONE(name) CPUZone PROFILE_ZONE_JOIN(profileZone, __LINE__)(name)
+
+#endif
@@ -0,0 +1,35 @@
+#include "Clock.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+uint64_t Clock::Now() {
+    static LARGE_INTEGER frequency = {0};
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    // Split the conversion up so that the multiplication can't overflow
+    uint64_t seconds   = counter.QuadPart / frequency.QuadPart;
+    uint64_t remainder = counter.QuadPart % frequency.QuadPart;
+
+    return seconds * 1000000000ull + remainder * 1000000000ull / frequency.QuadPart;
+}
+#else
+#include <time.h>
+
+uint64_t Clock::Now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
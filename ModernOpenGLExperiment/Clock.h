@@ -0,0 +1,26 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <cstdint>
+
+/**
+ * Clock
+ * Monotonic, high resolution time in integer nanoseconds. Unlike the float seconds
+ * we used to get out of glfwGetTime, this doesn't lose precision the longer the
+ * program runs, and it's safe to call from any thread.
+ */
+namespace Clock {
+    /**
+     * Now
+     * Nanoseconds since some arbitrary point before the program started
+     */
+    uint64_t Now();
+
+    inline double ToSeconds(uint64_t ns)      { return ns * 1e-9; }
+    inline double ToMilliseconds(uint64_t ns) { return ns * 1e-6; }
+    inline double ToMicroseconds(uint64_t ns) { return ns * 1e-3; }
+
+    inline uint64_t FromSeconds(double s)     { return (uint64_t)(s * 1e9); }
+};
+
+#endif
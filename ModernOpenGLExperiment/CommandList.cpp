@@ -0,0 +1,154 @@
+#include "CommandList.h"
+#include "GPUProfiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Keeps every command, and the arguments straight after its header, aligned well enough
+// for pointers and GLsizeiptr
+#define COMMAND_ALIGNMENT 8
+
+void* CommandList::Append(CommandType::CommandType type, size_t size) {
+    static_assert(sizeof(CommandHeader_t) % COMMAND_ALIGNMENT == 0, "Command arguments have to start aligned");
+
+    size_t total = (sizeof(CommandHeader_t) + size + COMMAND_ALIGNMENT - 1) & ~(COMMAND_ALIGNMENT - 1);
+    assert(total <= 0xFFFF);
+
+    if (head + total > commands.size())
+        commands.resize(std::max(commands.size() * 2, head + total));
+
+    CommandHeader_t* header = (CommandHeader_t*)&commands[head];
+    header->type = (uint16_t)type;
+    header->size = (uint16_t)total;
+
+    head += total;
+    ++commandCount;
+
+    return header + 1;
+}
+
+void CommandList::SetProgram(Program* program) {
+    Append<SetProgramCommand_t>(CommandType::SetProgram)->program = program;
+}
+
+void CommandList::SetTexture(GLuint unit, Texture* texture) {
+    SetTextureCommand_t* command = Append<SetTextureCommand_t>(CommandType::SetTexture);
+    command->unit = unit;
+    command->texture = texture;
+}
+
+void CommandList::SetUniformRange(GLuint binding, const UniformRange_t& range) {
+    SetUniformRangeCommand_t* command = Append<SetUniformRangeCommand_t>(CommandType::SetUniformRange);
+    command->binding = binding;
+    command->range = range;
+}
+
+void CommandList::SetUniformData(GLuint binding, const void* data, GLsizeiptr size) {
+    SetUniformDataCommand_t* command = Append<SetUniformDataCommand_t>(CommandType::SetUniformData, size);
+    command->binding = binding;
+    command->dataSize = size;
+    memset(&command->range, 0, sizeof(command->range));
+
+    memcpy(command + 1, data, size);
+}
+
+void CommandList::DrawMesh(const Mesh* mesh) {
+    Append<DrawMeshCommand_t>(CommandType::DrawMesh)->mesh = mesh;
+}
+
+void CommandList::DrawBatch(const MeshBatch* batch) {
+    Append<DrawBatchCommand_t>(CommandType::DrawBatch)->batch = batch;
+}
+
+void CommandList::BeginGPUScope(const char* name) {
+    Append<BeginGPUScopeCommand_t>(CommandType::BeginGPUScope)->name = name;
+}
+
+void CommandList::EndGPUScope() {
+    Append(CommandType::EndGPUScope, 0);
+}
+
+void CommandList::Clear() {
+    head = 0;
+    commandCount = 0;
+}
+
+void CommandList::UploadUniforms(UniformRing& ring) {
+    size_t offset = 0;
+    while (offset < head) {
+        CommandHeader_t* header = (CommandHeader_t*)&commands[offset];
+
+        if (header->type == CommandType::SetUniformData) {
+            SetUniformDataCommand_t* command = (SetUniformDataCommand_t*)(header + 1);
+
+            void* data;
+            command->range = ring.Allocate(command->dataSize, data);
+            memcpy(data, command + 1, command->dataSize);
+        }
+
+        offset += header->size;
+    }
+}
+
+void CommandList::Execute() const {
+    size_t offset = 0;
+    while (offset < head) {
+        const CommandHeader_t* header = (const CommandHeader_t*)&commands[offset];
+        const void* args = header + 1;
+
+        switch (header->type) {
+            case CommandType::SetProgram:
+                ((const SetProgramCommand_t*)args)->program->Bind();
+                break;
+
+            case CommandType::SetTexture: {
+                const SetTextureCommand_t* command = (const SetTextureCommand_t*)args;
+                Texture::Bind(command->unit, command->texture);
+                break;
+            }
+
+            case CommandType::SetUniformRange: {
+                const SetUniformRangeCommand_t* command = (const SetUniformRangeCommand_t*)args;
+                UniformRing::Bind(command->binding, command->range);
+                break;
+            }
+
+            case CommandType::SetUniformData: {
+                const SetUniformDataCommand_t* command = (const SetUniformDataCommand_t*)args;
+                UniformRing::Bind(command->binding, command->range);
+                break;
+            }
+
+            case CommandType::DrawMesh:
+                ((const DrawMeshCommand_t*)args)->mesh->Render();
+                break;
+
+            case CommandType::DrawBatch:
+                ((const DrawBatchCommand_t*)args)->batch->Render();
+                break;
+
+            case CommandType::BeginGPUScope:
+                GPUProfiler::BeginScope(((const BeginGPUScopeCommand_t*)args)->name);
+                break;
+
+            case CommandType::EndGPUScope:
+                GPUProfiler::EndScope();
+                break;
+
+            default:
+                assert(false);
+        }
+
+        offset += header->size;
+    }
+}
+
+void CommandList::Submit(CommandList* const* lists, size_t count, UniformRing& ring) {
+    for (size_t i=0; i<count; ++i)
+        lists[i]->UploadUniforms(ring);
+
+    ring.Flush();
+
+    for (size_t i=0; i<count; ++i)
+        lists[i]->Execute();
+}
@@ -0,0 +1,135 @@
+#ifndef COMMANDLIST_H
+#define COMMANDLIST_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Rendering.h"
+#include "Program.h"
+#include "Texture.h"
+#include "Mesh.h"
+#include "MeshBatch.h"
+#include "UniformRing.h"
+
+namespace CommandType {
+    enum CommandType {
+        SetProgram,
+        SetTexture,
+        SetUniformRange,
+        SetUniformData,
+        DrawMesh,
+        DrawBatch,
+        BeginGPUScope,
+        EndGPUScope
+    };
+};
+
+/**
+ * CommandList
+ * A linear buffer of compact draw and state commands, recorded now and executed later.
+ * Recording never touches GL, so any thread can record into a list of its own while
+ * the render thread is busy; only Submit, which replays lists into GL, has to happen on
+ * the thread that owns the context.
+ *
+ * Commands are a small header followed by their arguments, packed back to back. Lists
+ * keep their memory across Clear, so after the first few frames recording doesn't
+ * allocate.
+ *
+ * Uniform data can be recorded inline with SetUniformData, which copies it into the list.
+ * Submit uploads all inline uniform data from every list into the UniformRing in one go
+ * before executing anything, so recording threads never need to touch the ring either.
+ */
+class CommandList {
+private:
+    typedef struct {
+        uint16_t type;
+        uint16_t size; // Including the header, rounded up to keep commands aligned
+        uint32_t padding; // So the arguments that follow start aligned too
+    } CommandHeader_t;
+
+    typedef struct { Program* program; } SetProgramCommand_t;
+    typedef struct { GLuint unit; Texture* texture; } SetTextureCommand_t;
+    typedef struct { GLuint binding; UniformRange_t range; } SetUniformRangeCommand_t;
+
+    // Followed by dataSize bytes of uniform data. The range is filled in by Submit.
+    typedef struct { GLuint binding; GLsizeiptr dataSize; UniformRange_t range; } SetUniformDataCommand_t;
+
+    typedef struct { const Mesh* mesh; } DrawMeshCommand_t;
+    typedef struct { const MeshBatch* batch; } DrawBatchCommand_t;
+    typedef struct { const char* name; } BeginGPUScopeCommand_t;
+
+    std::vector<char> commands;
+    size_t head;
+    uint32_t commandCount;
+
+    void* Append(CommandType::CommandType type, size_t size);
+
+    template <typename T>
+    T* Append(CommandType::CommandType type, size_t extra = 0) {
+        return (T*)Append(type, sizeof(T) + extra);
+    }
+
+    // First half of Submit: moves inline uniform data into the ring
+    void UploadUniforms(UniformRing& ring);
+
+public:
+    CommandList() : head(0), commandCount(0) {}
+
+    void SetProgram(Program* program);
+    void SetTexture(GLuint unit, Texture* texture);
+
+    /**
+     * SetUniformRange
+     * Binds uniform data that is already in a uniform buffer
+     */
+    void SetUniformRange(GLuint binding, const UniformRange_t& range);
+
+    /**
+     * SetUniformData
+     * Copies size bytes of uniform block data into the list, to be uploaded and bound
+     * to the given block binding when the list is submitted
+     */
+    void SetUniformData(GLuint binding, const void* data, GLsizeiptr size);
+
+    template <typename T>
+    void SetUniformData(GLuint binding, const T& value) {
+        SetUniformData(binding, &value, sizeof(T));
+    }
+
+    void DrawMesh(const Mesh* mesh);
+    void DrawBatch(const MeshBatch* batch);
+
+    /**
+     * BeginGPUScope
+     * Starts timing the commands that follow under the given name, until the matching
+     * EndGPUScope (see GPUProfiler)
+     */
+    void BeginGPUScope(const char* name);
+    void EndGPUScope();
+
+    /**
+     * Clear
+     * Empties the list, keeping its memory around for the next recording
+     */
+    void Clear();
+
+    /**
+     * Execute
+     * Replays the list into GL. Only lists without any SetUniformData can be executed
+     * directly; anything else has to go through Submit so its uniform data gets uploaded.
+     */
+    void Execute() const;
+
+    uint32_t GetCommandCount() const { return commandCount; }
+    size_t GetSize() const { return head; }
+
+    /**
+     * Submit
+     * Executes the given lists in order. Must be called from the thread with the GL
+     * context, after every recording thread is done with the lists. Any uniform data
+     * already in the ring gets flushed along with the lists' own.
+     */
+    static void Submit(CommandList* const* lists, size_t count, UniformRing& ring);
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef FRAMEEXCHANGE_H
+#define FRAMEEXCHANGE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Yields before a waiting side goes to sleep, so that a side left waiting for a long
+// time (e.g. while the renderer idles) doesn't keep a core busy
+#define FRAME_EXCHANGE_SPINS 64
+
+/**
+ * FrameExchange
+ * Hands per-frame state from one producer thread (the simulation) to one consumer
+ * thread (the renderer) through two buffers, so that the producer can fill in frame
+ * N+1 while the consumer is still working on frame N.
+ *
+ * The only synchronization is a pair of frame counters. A side that gets a whole frame
+ * ahead of the other yields for a while, then sleeps until the other side moves its
+ * counter along, which is exactly the back pressure we want. Neither side takes a lock
+ * unless somebody is asleep, and an idle side costs nothing until it's woken.
+ *
+ * Either side can Close the exchange to shut the pipeline down, which wakes up
+ * whoever is waiting on the other side.
+ */
+template <typename T>
+class FrameExchange {
+private:
+    T frames[2];
+
+    // Number of frames written and read in total. written - read is 0, 1 or 2.
+    std::atomic<uint32_t> written;
+    std::atomic<uint32_t> read;
+
+    std::atomic<bool> closed;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<int32_t> sleepers;
+
+    // Returns once ready() is true, yielding and then sleeping until then
+    template <typename F>
+    void Wait(const F& ready) {
+        for (uint32_t i=0; i<FRAME_EXCHANGE_SPINS; ++i) {
+            if (ready())
+                return;
+
+            std::this_thread::yield();
+        }
+
+        // Counting ourselves as asleep before the last look means that whoever changes
+        // things after it is sure to see us and wake us up
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        ++sleepers;
+        wakeUp.wait(lock, ready);
+        --sleepers;
+    }
+
+    // The counters are stored sequentially consistent, so either a sleeper's last look
+    // saw the change, or this sees the sleeper
+    void WakeUp() {
+        if (sleepers.load() == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeUp.notify_all();
+    }
+
+public:
+    FrameExchange() : written(0), read(0), closed(false), sleepers(0) {}
+
+    /**
+     * BeginWrite
+     * Waits for a free buffer and returns it, or NULL if the exchange was closed
+     */
+    T* BeginWrite() {
+        uint32_t frame = written.load(std::memory_order_relaxed);
+
+        Wait([&]() { return frame - read.load() < 2 || closed.load(); });
+
+        if (frame - read.load() >= 2)
+            return NULL;
+
+        return &frames[frame & 1];
+    }
+
+    /**
+     * EndWrite
+     * Publishes the buffer returned by BeginWrite to the consumer
+     */
+    void EndWrite() {
+        written.store(written.load(std::memory_order_relaxed) + 1);
+        WakeUp();
+    }
+
+    /**
+     * BeginRead
+     * Waits for the next frame and returns it, or NULL if the exchange was closed
+     * and there's nothing left to read
+     */
+    const T* BeginRead() {
+        uint32_t frame = read.load(std::memory_order_relaxed);
+
+        Wait([&]() { return written.load() != frame || closed.load(); });
+
+        if (written.load() == frame)
+            return NULL;
+
+        return &frames[frame & 1];
+    }
+
+    /**
+     * EndRead
+     * Hands the buffer returned by BeginRead back to the producer
+     */
+    void EndRead() {
+        read.store(read.load(std::memory_order_relaxed) + 1);
+        WakeUp();
+    }
+
+    void Close() {
+        closed.store(true);
+        WakeUp();
+    }
+
+    bool IsClosed() const { return closed.load(std::memory_order_acquire); }
+};
+
+#endif
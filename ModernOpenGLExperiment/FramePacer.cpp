@@ -0,0 +1,106 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include "Clock.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+// Bounds on how early we stop sleeping and start spinning, in ns
+#define MIN_SPIN_MARGIN ((uint64_t)200000)
+#define MAX_SPIN_MARGIN ((uint64_t)4000000)
+
+FramePacer::FramePacer(double framesPerSecond) : spinMargin(2000000ull), intervalCount(0), intervalM2(0.0) {
+#if defined(_WIN32)
+    // The default scheduler tick is ~15ms, far too coarse to sleep with
+    timeBeginPeriod(1);
+#endif
+
+    memset(&stats, 0, sizeof(stats));
+
+    SetRate(framesPerSecond);
+    Reset();
+}
+
+FramePacer::~FramePacer() {
+#if defined(_WIN32)
+    timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::SetRate(double framesPerSecond) {
+    interval = Clock::FromSeconds(1.0 / framesPerSecond);
+}
+
+void FramePacer::Reset() {
+    lastFrame = 0;
+    deadline = Clock::Now() + interval;
+}
+
+void FramePacer::Wait() {
+    uint64_t now = Clock::Now();
+
+    if (deadline > now + spinMargin) {
+        uint64_t sleepUntil = deadline - spinMargin;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(sleepUntil - now));
+
+        uint64_t woke = Clock::Now();
+        stats.sleepTime += woke - now;
+
+        // Keep the margin a little over how much sleeps have been overshooting,
+        // slowly shrinking back down when they stop
+        uint64_t overshoot = woke > sleepUntil ? woke - sleepUntil : 0;
+        spinMargin = std::max(spinMargin - spinMargin / 64, overshoot + overshoot / 4);
+        spinMargin = std::min(std::max(spinMargin, MIN_SPIN_MARGIN), MAX_SPIN_MARGIN);
+
+        now = woke;
+    }
+
+    uint64_t spinStart = now;
+    while (now < deadline)
+        now = Clock::Now();
+
+    stats.spinTime += now - spinStart;
+
+    // Statistics
+    uint64_t lateness = now - deadline;
+    stats.meanLateness += (lateness - stats.meanLateness) / (stats.frames + 1);
+    stats.maxLateness = std::max(stats.maxLateness, lateness);
+
+    if (lastFrame != 0) {
+        uint64_t frameInterval = now - lastFrame;
+        uint32_t n = ++intervalCount;
+
+        double delta = frameInterval - stats.meanInterval;
+        stats.meanInterval += delta / n;
+        intervalM2 += delta * (frameInterval - stats.meanInterval);
+
+        stats.intervalStdDev = n > 1 ? sqrt(intervalM2 / (n - 1)) : 0.0;
+        stats.maxInterval = std::max(stats.maxInterval, frameInterval);
+    }
+
+    ++stats.frames;
+    lastFrame = now;
+
+    // Next deadline, unless we've fallen too far behind to catch up
+    if (lateness > interval) {
+        ++stats.missedFrames;
+        deadline = now + interval;
+    } else {
+        deadline += interval;
+    }
+}
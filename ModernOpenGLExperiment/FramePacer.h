@@ -0,0 +1,72 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <cstdint>
+
+/**
+ * FramePacerStats_t - How steadily frames have been coming out. Times are in ns.
+ * Lateness is how long after its deadline Wait actually returned.
+ */
+typedef struct {
+    uint32_t frames;
+    uint32_t missedFrames; // Frames that were more than a whole interval late
+
+    double meanInterval;
+    double intervalStdDev;
+    uint64_t maxInterval;
+
+    double meanLateness;
+    uint64_t maxLateness;
+
+    uint64_t sleepTime;
+    uint64_t spinTime;
+} FramePacerStats_t;
+
+/**
+ * FramePacer
+ * Caps the frame rate without burning a core. Wait sleeps until shortly before the next
+ * frame is due, then spins the rest of the way, since sleeping alone can overshoot by a
+ * millisecond or more. The spin margin tracks how much recent sleeps have overshot.
+ *
+ * Deadlines are spaced exactly one interval apart rather than measured from whenever the
+ * last frame finished, so small delays don't add up to a lower frame rate. A frame that
+ * misses its deadline by a whole interval gives up on catching up and starts afresh.
+ */
+class FramePacer {
+private:
+    uint64_t interval;
+    uint64_t deadline;
+    uint64_t lastFrame;
+
+    uint64_t spinMargin;
+
+    FramePacerStats_t stats;
+
+    // Running sums for the interval variance (Welford's method)
+    uint32_t intervalCount;
+    double intervalM2;
+
+public:
+    FramePacer(double framesPerSecond);
+    ~FramePacer();
+
+    /**
+     * Wait
+     * Blocks until the next frame is due
+     */
+    void Wait();
+
+    void SetRate(double framesPerSecond);
+
+    /**
+     * Reset
+     * Forgets the schedule, e.g. after the loop has been idle on purpose, so that the
+     * next Wait doesn't count as a missed frame. The next frame is due one interval
+     * from now.
+     */
+    void Reset();
+
+    const FramePacerStats_t& GetStats() const { return stats; }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "FrameSync.h"
+#include "Clock.h"
+
+#include <cstdio>
+
+// Report any single wait longer than this
+#define STALL_REPORT_THRESHOLD 1000000 // 1ms
+
+GLsync FrameSync::fences[FRAMES_IN_FLIGHT] = {0};
+GLuint FrameSync::frameIndex = 0;
+FrameSyncStats_t FrameSync::stats = {0};
+
+void FrameSync::BeginFrame() {
+    frameIndex = (frameIndex + 1) % FRAMES_IN_FLIGHT;
+
+    ++stats.frames;
+    stats.lastWaitTime = 0;
+
+    GLsync fence = fences[frameIndex];
+    if (fence == NULL)
+        return;
+
+    // Usually the GPU is long done with this frame, so check without blocking first
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+    if (result == GL_TIMEOUT_EXPIRED) {
+        uint64_t start = Clock::Now();
+
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        } while (result == GL_TIMEOUT_EXPIRED);
+
+        stats.lastWaitTime = Clock::Now() - start;
+        stats.totalWaitTime += stats.lastWaitTime;
+        ++stats.stalledFrames;
+
+        if (stats.lastWaitTime > STALL_REPORT_THRESHOLD) {
+            fprintf(stderr, "FrameSync: waited %.2fms for the GPU on frame %u\n",
+                Clock::ToMilliseconds(stats.lastWaitTime), stats.frames);
+        }
+    }
+
+    if (result == GL_WAIT_FAILED)
+        fprintf(stderr, "FrameSync: glClientWaitSync failed\n");
+
+    glDeleteSync(fence);
+    fences[frameIndex] = NULL;
+}
+
+void FrameSync::EndFrame() {
+    assert(fences[frameIndex] == NULL);
+    fences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void FrameSync::Shutdown() {
+    for (GLuint i=0; i<FRAMES_IN_FLIGHT; ++i) {
+        if (fences[i] != NULL) {
+            glDeleteSync(fences[i]);
+            fences[i] = NULL;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef FRAMESYNC_H
+#define FRAMESYNC_H
+
+#include <cstdint>
+
+#include "Rendering.h"
+
+// How many frames the CPU can get ahead of the GPU. Anything streamed to
+// the GPU keeps this many copies around, one per frame in flight.
+#define FRAMES_IN_FLIGHT 3
+
+/**
+ * FrameSyncStats_t - Time the CPU spent blocked on the GPU catching up
+ */
+typedef struct {
+    uint64_t lastWaitTime;  // ns, in the most recent BeginFrame
+    uint64_t totalWaitTime; // ns, over the whole run
+    uint32_t stalledFrames; // How many frames had to wait at all
+    uint32_t frames;
+} FrameSyncStats_t;
+
+/**
+ * FrameSync
+ * Fences off each frame's GPU work, so that data written for a frame can be overwritten
+ * FRAMES_IN_FLIGHT frames later without the driver having to check whether the GPU is
+ * done with it. Streaming buffers use GetFrameIndex to pick which of their copies is safe
+ * to write this frame.
+ *
+ * BeginFrame must be called before writing anything for a frame, and EndFrame after
+ * the last draw that reads it.
+ */
+class FrameSync {
+private:
+    static GLsync fences[FRAMES_IN_FLIGHT];
+    static GLuint frameIndex;
+
+    static FrameSyncStats_t stats;
+
+    FrameSync() {}
+
+public:
+    /**
+     * BeginFrame
+     * Moves on to the next frame index, waiting for the GPU to finish the frame that
+     * last used it if necessary
+     */
+    static void BeginFrame();
+
+    /**
+     * EndFrame
+     * Fences the commands issued for this frame
+     */
+    static void EndFrame();
+
+    /**
+     * Shutdown
+     * Deletes any outstanding fences
+     */
+    static void Shutdown();
+
+    static GLuint GetFrameIndex() { return frameIndex; }
+
+    static const FrameSyncStats_t& GetStats() { return stats; }
+};
+
+#endif
@@ -0,0 +1,740 @@
+#include "GLCapture.h"
+#include "GLTrace.h"
+#include "GLFunctions.h"
+#include "Clock.h"
+
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// Trace data is collected in memory and written out in chunks of about this size
+#define GLCAPTURE_WRITE_SIZE (1 << 20)
+
+typedef void (CODEGEN_FUNCPTR* GLProc)();
+
+// What the function pointers pointed at before we wrapped them
+static GLProc originals[GLFunction::Count];
+
+// Calls an original function pointer, without it being captured
+#define CALL_ORIGINAL(function) ((decltype(function))originals[GLFunction::function])
+
+typedef struct {
+    uint8_t* pointer;
+    GLsizeiptr length;
+    GLbitfield access;
+} MappedRange_t;
+
+static FILE* file = NULL;
+static std::vector<uint8_t> writeBuffer;
+static uint64_t startTime;
+static GLCaptureStats_t stats;
+
+// State that changes how much data a pointer points at
+static GLuint unpackBuffer = 0;
+static GLuint packBuffer = 0;
+static GLint unpackAlignment = 4;
+static GLint packAlignment = 4;
+static std::map<GLenum, MappedRange_t> mappings;
+
+// Joined up glShaderSource strings, so they can go out as a single payload
+static std::string shaderSource;
+
+// Returned by GetInputSize for pointers that are really buffer offsets, or that we can't size
+#define SIZE_OFFSET  -2
+#define SIZE_UNKNOWN -1
+
+static void Write(const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    writeBuffer.insert(writeBuffer.end(), bytes, bytes + size);
+}
+
+template <typename T>
+static void Write(T value) {
+    Write(&value, sizeof(T));
+}
+
+static void FlushWrites() {
+    if (!writeBuffer.empty())
+        fwrite(&writeBuffer[0], 1, writeBuffer.size(), file);
+
+    stats.bytesWritten += writeBuffer.size();
+    writeBuffer.clear();
+}
+
+static GLsizei GetPixelSize(GLenum format, GLenum type) {
+    // Packed types cover the whole pixel
+    switch (type) {
+        case GL_UNSIGNED_BYTE_3_3_2:
+        case GL_UNSIGNED_BYTE_2_3_3_REV:
+            return 1;
+
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_5_6_5_REV:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+        case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+            return 2;
+
+        case GL_UNSIGNED_INT_8_8_8_8:
+        case GL_UNSIGNED_INT_8_8_8_8_REV:
+        case GL_UNSIGNED_INT_10_10_10_2:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_24_8:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_5_9_9_9_REV:
+            return 4;
+
+        case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+            return 8;
+    }
+
+    GLsizei components;
+    switch (format) {
+        case GL_RG:
+        case GL_RG_INTEGER:
+            components = 2;
+            break;
+
+        case GL_RGB:
+        case GL_BGR:
+        case GL_RGB_INTEGER:
+        case GL_BGR_INTEGER:
+            components = 3;
+            break;
+
+        case GL_RGBA:
+        case GL_BGRA:
+        case GL_RGBA_INTEGER:
+        case GL_BGRA_INTEGER:
+            components = 4;
+            break;
+
+        default:
+            components = 1;
+    }
+
+    switch (type) {
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT:
+            return components * 2;
+
+        case GL_UNSIGNED_INT:
+        case GL_INT:
+        case GL_FLOAT:
+            return components * 4;
+
+        default:
+            return components;
+    }
+}
+
+static int64_t GetImageSize(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, GLint alignment) {
+    if (width <= 0 || height <= 0 || depth <= 0)
+        return 0;
+
+    // Every row is padded out to the alignment except the very last one
+    int64_t row = (int64_t)width * GetPixelSize(format, type);
+    int64_t stride = (row + alignment - 1) / alignment * alignment;
+
+    return stride * ((int64_t)height * depth - 1) + row;
+}
+
+// Sizes the data behind the array arguments of glUniform*v
+static int64_t GetUniformSize(const GLTraceCall_t& call, const char* suffix) {
+    GLsizei count = (GLsizei)call.args[1];
+
+    if (strncmp(suffix, "Matrix", 6) == 0) {
+        int rows = suffix[6] - '0';
+        int columns = suffix[7] == 'x' ? suffix[8] - '0' : rows;
+        return (int64_t)count * rows * columns * sizeof(GLfloat);
+    }
+
+    if (!isdigit(suffix[0]))
+        return SIZE_UNKNOWN;
+
+    // Floats, ints and uints are all 4 bytes
+    return (int64_t)count * (suffix[0] - '0') * 4;
+}
+
+// Sizes the data behind glVertexAttrib*v
+static int64_t GetVertexAttribSize(const char* suffix) {
+    if (*suffix == 'I')
+        ++suffix;
+
+    // Packed attributes are always a single GLuint
+    if (*suffix == 'P')
+        return sizeof(GLuint);
+
+    if (!isdigit(*suffix))
+        return SIZE_UNKNOWN;
+
+    int components = *suffix++ - '0';
+    if (*suffix == 'N')
+        ++suffix;
+
+    if (strcmp(suffix, "dv") == 0)                                return components * 8;
+    if (strcmp(suffix, "fv") == 0 || strcmp(suffix, "iv") == 0)   return components * 4;
+    if (strcmp(suffix, "uiv") == 0)                               return components * 4;
+    if (strcmp(suffix, "sv") == 0 || strcmp(suffix, "usv") == 0)  return components * 2;
+    if (strcmp(suffix, "bv") == 0 || strcmp(suffix, "ubv") == 0)  return components;
+
+    return SIZE_UNKNOWN;
+}
+
+static int64_t GetTextureParameterSize(GLenum pname) {
+    return pname == GL_TEXTURE_BORDER_COLOR || pname == GL_TEXTURE_SWIZZLE_RGBA ? 4 * 4 : 4;
+}
+
+/*
+ * How many bytes an input pointer argument points at, going by the call's other
+ * arguments. Strings and glShaderSource are dealt with before we get here.
+ */
+static int64_t GetInputSize(const GLTraceCall_t& call, int arg) {
+    const uint64_t* a = call.args;
+
+    switch (call.function) {
+        case GLFunction::glBufferData:    return (GLsizeiptr)a[1];
+        case GLFunction::glBufferSubData: return (GLsizeiptr)a[2];
+
+        // With a pixel unpack buffer bound, texture data is read from it instead
+        case GLFunction::glTexImage1D:
+            return unpackBuffer ? SIZE_OFFSET : GetImageSize((GLsizei)a[3], 1, 1, (GLenum)a[5], (GLenum)a[6], unpackAlignment);
+        case GLFunction::glTexImage2D:
+            return unpackBuffer ? SIZE_OFFSET : GetImageSize((GLsizei)a[3], (GLsizei)a[4], 1, (GLenum)a[6], (GLenum)a[7], unpackAlignment);
+        case GLFunction::glTexSubImage1D:
+            return unpackBuffer ? SIZE_OFFSET : GetImageSize((GLsizei)a[3], 1, 1, (GLenum)a[4], (GLenum)a[5], unpackAlignment);
+        case GLFunction::glTexSubImage2D:
+            return unpackBuffer ? SIZE_OFFSET : GetImageSize((GLsizei)a[4], (GLsizei)a[5], 1, (GLenum)a[6], (GLenum)a[7], unpackAlignment);
+        case GLFunction::glTexSubImage3D:
+            return unpackBuffer ? SIZE_OFFSET : GetImageSize((GLsizei)a[5], (GLsizei)a[6], (GLsizei)a[7], (GLenum)a[8], (GLenum)a[9], unpackAlignment);
+
+        case GLFunction::glCompressedTexImage1D:    return unpackBuffer ? SIZE_OFFSET : (GLsizei)a[5];
+        case GLFunction::glCompressedTexImage2D:    return unpackBuffer ? SIZE_OFFSET : (GLsizei)a[6];
+        case GLFunction::glCompressedTexImage3D:    return unpackBuffer ? SIZE_OFFSET : (GLsizei)a[7];
+        case GLFunction::glCompressedTexSubImage1D: return unpackBuffer ? SIZE_OFFSET : (GLsizei)a[5];
+        case GLFunction::glCompressedTexSubImage2D: return unpackBuffer ? SIZE_OFFSET : (GLsizei)a[7];
+        case GLFunction::glCompressedTexSubImage3D: return unpackBuffer ? SIZE_OFFSET : (GLsizei)a[9];
+
+        // Offsets into the bound element array or vertex buffer
+        case GLFunction::glDrawElements:
+        case GLFunction::glDrawElementsInstanced:
+        case GLFunction::glDrawElementsBaseVertex:
+        case GLFunction::glDrawElementsInstancedBaseVertex:
+        case GLFunction::glDrawRangeElements:
+        case GLFunction::glDrawRangeElementsBaseVertex:
+        case GLFunction::glVertexAttribPointer:
+        case GLFunction::glVertexAttribIPointer:
+            return SIZE_OFFSET;
+
+        case GLFunction::glMultiDrawArrays:
+            return (int64_t)(GLsizei)a[3] * sizeof(GLint);
+
+        // Both the counts and the index offsets, which are copied as they are
+        case GLFunction::glMultiDrawElements:
+        case GLFunction::glMultiDrawElementsBaseVertex:
+            return (int64_t)(GLsizei)a[4] * (arg == 3 ? sizeof(void*) : sizeof(GLint));
+
+        case GLFunction::glDeleteBuffers:
+        case GLFunction::glDeleteTextures:
+        case GLFunction::glDeleteVertexArrays:
+        case GLFunction::glDeleteQueries:
+        case GLFunction::glDeleteFramebuffers:
+        case GLFunction::glDeleteRenderbuffers:
+        case GLFunction::glDeleteSamplers:
+        case GLFunction::glDrawBuffers:
+            return (int64_t)(GLsizei)a[0] * sizeof(GLuint);
+
+        case GLFunction::glTexParameterfv:
+        case GLFunction::glTexParameteriv:
+        case GLFunction::glTexParameterIiv:
+        case GLFunction::glTexParameterIuiv:
+        case GLFunction::glSamplerParameterfv:
+        case GLFunction::glSamplerParameteriv:
+        case GLFunction::glSamplerParameterIiv:
+        case GLFunction::glSamplerParameterIuiv:
+            return GetTextureParameterSize((GLenum)a[1]);
+
+        case GLFunction::glClearBufferiv:
+        case GLFunction::glClearBufferuiv:
+        case GLFunction::glClearBufferfv:
+            return (GLenum)a[0] == GL_COLOR ? 4 * 4 : 4;
+
+        case GLFunction::glPointParameterfv:
+        case GLFunction::glPointParameteriv:
+            return 4;
+    }
+
+    const char* name = GLFunction::GetName((GLFunction::GLFunction)call.function);
+
+    if (strncmp(name, "glUniform", 9) == 0)
+        return GetUniformSize(call, name + 9);
+
+    if (strncmp(name, "glVertexAttrib", 14) == 0)
+        return GetVertexAttribSize(name + 14);
+
+    return SIZE_UNKNOWN;
+}
+
+static int64_t GetTextureImageSize(GLenum target, GLint level, GLenum format, GLenum type) {
+    GLint width = 0, height = 0, depth = 0;
+    CALL_ORIGINAL(glGetTexLevelParameteriv)(target, level, GL_TEXTURE_WIDTH, &width);
+    CALL_ORIGINAL(glGetTexLevelParameteriv)(target, level, GL_TEXTURE_HEIGHT, &height);
+    CALL_ORIGINAL(glGetTexLevelParameteriv)(target, level, GL_TEXTURE_DEPTH, &depth);
+
+    return GetImageSize(width, height, depth, format, type, packAlignment);
+}
+
+static void AddPayload(GLTraceCall_t& call, int arg, uint8_t flags, int64_t size, const void* data) {
+    GLTracePayload_t& payload = call.payloads[call.payloadCount++];
+    payload.arg = (uint8_t)arg | flags;
+    payload.size = (uint32_t)size;
+    payload.data = data;
+}
+
+static void AddInputPayload(GLTraceCall_t& call, int arg) {
+    const void* pointer = FromTraceValue<const void*>(call.args[arg]);
+
+    if (call.argString[arg]) {
+        AddPayload(call, arg, 0, strlen((const char*)pointer) + 1, pointer);
+        return;
+    }
+
+    if (call.function == GLFunction::glShaderSource) {
+        // Sent as a single string, and replayed without the lengths
+        if (arg != 2)
+            return;
+
+        const GLchar* const* strings = (const GLchar* const*)pointer;
+        const GLint* lengths = FromTraceValue<const GLint*>(call.args[3]);
+
+        shaderSource.clear();
+        for (GLsizei i=0; i<(GLsizei)call.args[1]; ++i) {
+            if (lengths && lengths[i] >= 0)
+                shaderSource.append(strings[i], lengths[i]);
+            else
+                shaderSource.append(strings[i]);
+        }
+
+        AddPayload(call, arg, 0, shaderSource.size() + 1, shaderSource.c_str());
+        return;
+    }
+
+    int64_t size = GetInputSize(call, arg);
+
+    if (size == SIZE_OFFSET) {
+        AddPayload(call, arg, GLTRACE_PAYLOAD_OFFSET, 0, NULL);
+    } else if (size == SIZE_UNKNOWN) {
+        AddPayload(call, arg, GLTRACE_PAYLOAD_UNCAPTURED, 0, NULL);
+    } else {
+        AddPayload(call, arg, 0, size, pointer);
+    }
+}
+
+static void AddOutputPayload(GLTraceCall_t& call, int arg) {
+    const uint64_t* a = call.args;
+    void* pointer = FromTraceValue<void*>(a[arg]);
+
+    switch (call.function) {
+        // Generated names, so replay can match them up with its own
+        case GLFunction::glGenBuffers:
+        case GLFunction::glGenTextures:
+        case GLFunction::glGenVertexArrays:
+        case GLFunction::glGenQueries:
+        case GLFunction::glGenFramebuffers:
+        case GLFunction::glGenRenderbuffers:
+        case GLFunction::glGenSamplers:
+            AddPayload(call, arg, GLTRACE_PAYLOAD_OUTPUT, (int64_t)(GLsizei)a[0] * sizeof(GLuint), pointer);
+            return;
+
+        // Anything that might write more than replay's default scratch space. Reads into
+        // a pixel pack buffer take an offset instead.
+        case GLFunction::glReadPixels:
+            if (packBuffer)
+                AddPayload(call, arg, GLTRACE_PAYLOAD_OFFSET, 0, NULL);
+            else
+                AddPayload(call, arg, GLTRACE_PAYLOAD_OUTPUT_SIZE,
+                    GetImageSize((GLsizei)a[2], (GLsizei)a[3], 1, (GLenum)a[4], (GLenum)a[5], packAlignment), NULL);
+            return;
+
+        case GLFunction::glGetTexImage:
+            if (packBuffer)
+                AddPayload(call, arg, GLTRACE_PAYLOAD_OFFSET, 0, NULL);
+            else
+                AddPayload(call, arg, GLTRACE_PAYLOAD_OUTPUT_SIZE,
+                    GetTextureImageSize((GLenum)a[0], (GLint)a[1], (GLenum)a[2], (GLenum)a[3]), NULL);
+            return;
+
+        case GLFunction::glGetCompressedTexImage:
+            if (packBuffer) {
+                AddPayload(call, arg, GLTRACE_PAYLOAD_OFFSET, 0, NULL);
+            } else {
+                GLint size = 0;
+                CALL_ORIGINAL(glGetTexLevelParameteriv)((GLenum)a[0], (GLint)a[1], GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+                AddPayload(call, arg, GLTRACE_PAYLOAD_OUTPUT_SIZE, size, NULL);
+            }
+            return;
+
+        case GLFunction::glGetBufferSubData:
+            AddPayload(call, arg, GLTRACE_PAYLOAD_OUTPUT_SIZE, (GLsizeiptr)a[2], NULL);
+            return;
+    }
+
+    // Small enough for the default
+    AddPayload(call, arg, GLTRACE_PAYLOAD_OUTPUT_SIZE, 0, NULL);
+}
+
+static void WriteBufferWrite(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    Write<uint16_t>(GLTRACE_BUFFER_WRITE);
+    Write<uint32_t>(target);
+    Write<uint64_t>(offset);
+    Write<uint32_t>((uint32_t)size);
+    Write(data, size);
+}
+
+static void BeforeCall(const GLTraceCall_t& call) {
+    // Anything written through a mapping has to go into the trace before the unmap or
+    // flush that makes it visible
+    switch (call.function) {
+        case GLFunction::glUnmapBuffer: {
+            auto it = mappings.find((GLenum)call.args[0]);
+            if (it == mappings.end())
+                break;
+
+            const MappedRange_t& range = it->second;
+            if ((range.access & GL_MAP_WRITE_BIT) && !(range.access & GL_MAP_FLUSH_EXPLICIT_BIT))
+                WriteBufferWrite(it->first, 0, range.length, range.pointer);
+
+            mappings.erase(it);
+            break;
+        }
+
+        case GLFunction::glFlushMappedBufferRange: {
+            auto it = mappings.find((GLenum)call.args[0]);
+            if (it != mappings.end())
+                WriteBufferWrite(it->first, (GLintptr)call.args[1], (GLsizeiptr)call.args[2], it->second.pointer + (GLintptr)call.args[1]);
+            break;
+        }
+    }
+}
+
+static void TrackState(const GLTraceCall_t& call) {
+    const uint64_t* a = call.args;
+
+    switch (call.function) {
+        case GLFunction::glBindBuffer:
+            if ((GLenum)a[0] == GL_PIXEL_UNPACK_BUFFER) unpackBuffer = (GLuint)a[1];
+            if ((GLenum)a[0] == GL_PIXEL_PACK_BUFFER)   packBuffer = (GLuint)a[1];
+            break;
+
+        case GLFunction::glDeleteBuffers: {
+            const GLuint* names = FromTraceValue<const GLuint*>(a[1]);
+            for (GLsizei i=0; i<(GLsizei)a[0]; ++i) {
+                if (names[i] == unpackBuffer) unpackBuffer = 0;
+                if (names[i] == packBuffer)   packBuffer = 0;
+            }
+            break;
+        }
+
+        case GLFunction::glPixelStorei:
+            if ((GLenum)a[0] == GL_UNPACK_ALIGNMENT) unpackAlignment = (GLint)a[1];
+            if ((GLenum)a[0] == GL_PACK_ALIGNMENT)   packAlignment = (GLint)a[1];
+            break;
+
+        case GLFunction::glMapBufferRange:
+            if (call.result) {
+                MappedRange_t range = {FromTraceValue<uint8_t*>(call.result), (GLsizeiptr)a[2], (GLbitfield)a[3]};
+                mappings[(GLenum)a[0]] = range;
+            }
+            break;
+
+        case GLFunction::glMapBuffer:
+            if (call.result) {
+                GLint size = 0;
+                CALL_ORIGINAL(glGetBufferParameteriv)((GLenum)a[0], GL_BUFFER_SIZE, &size);
+
+                GLbitfield access = 0;
+                if ((GLenum)a[1] != GL_WRITE_ONLY) access |= GL_MAP_READ_BIT;
+                if ((GLenum)a[1] != GL_READ_ONLY)  access |= GL_MAP_WRITE_BIT;
+
+                MappedRange_t range = {FromTraceValue<uint8_t*>(call.result), size, access};
+                mappings[(GLenum)a[0]] = range;
+            }
+            break;
+    }
+}
+
+static void AfterCall(GLTraceCall_t& call) {
+    for (int i=0; i<call.argCount; ++i) {
+        if (call.args[i] == 0)
+            continue;
+
+        if (call.argInput[i])
+            AddInputPayload(call, i);
+        else if (call.argOutput[i])
+            AddOutputPayload(call, i);
+    }
+
+    Write<uint16_t>(call.function);
+    for (int i=0; i<call.argCount; ++i)
+        Write(&call.args[i], call.argSizes[i]);
+
+    Write(&call.result, call.resultSize);
+
+    bool uncaptured = false;
+
+    Write<uint8_t>(call.payloadCount);
+    for (int i=0; i<call.payloadCount; ++i) {
+        const GLTracePayload_t& payload = call.payloads[i];
+        uncaptured |= (payload.arg & GLTRACE_PAYLOAD_UNCAPTURED) != 0;
+
+        Write<uint8_t>(payload.arg);
+        Write<uint32_t>(payload.size);
+        if (payload.data)
+            Write(payload.data, payload.size);
+    }
+
+    TrackState(call);
+
+    ++stats.calls;
+    if (uncaptured)
+        ++stats.uncapturedCalls;
+
+    if (writeBuffer.size() >= GLCAPTURE_WRITE_SIZE)
+        FlushWrites();
+}
+
+/*
+ * Runs a call between BeforeCall and AfterCall, with void calls having no result to keep
+ */
+template <typename R>
+struct CaptureInvoker {
+    template <typename Function>
+    static R Call(GLTraceCall_t& call, Function function) {
+        BeforeCall(call);
+        R result = function();
+        call.result = ToTraceValue(result);
+        AfterCall(call);
+        return result;
+    }
+};
+
+template <>
+struct CaptureInvoker<void> {
+    template <typename Function>
+    static void Call(GLTraceCall_t& call, Function function) {
+        BeforeCall(call);
+        function();
+        AfterCall(call);
+    }
+};
+
+/*
+ * Wrappers, one per arity, that capture the call around the original function. Like
+ * NullGL's stubs, they have to match each function pointer's type exactly.
+ */
+
+template <int F, typename R>
+R CODEGEN_FUNCPTR Capture0() {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)())originals[F])(); });
+}
+
+template <int F, typename R>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)()) { originals[F] = (GLProc)function; function = &Capture0<F, R>; }
+
+template <int F, typename R, typename A1>
+R CODEGEN_FUNCPTR Capture1(A1 a1) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1))originals[F])(a1); });
+}
+
+template <int F, typename R, typename A1>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1)) { originals[F] = (GLProc)function; function = &Capture1<F, R, A1>; }
+
+template <int F, typename R, typename A1, typename A2>
+R CODEGEN_FUNCPTR Capture2(A1 a1, A2 a2) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1); AddTraceArg(call, a2);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2))originals[F])(a1, a2); });
+}
+
+template <int F, typename R, typename A1, typename A2>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1, A2)) { originals[F] = (GLProc)function; function = &Capture2<F, R, A1, A2>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3>
+R CODEGEN_FUNCPTR Capture3(A1 a1, A2 a2, A3 a3) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1); AddTraceArg(call, a2); AddTraceArg(call, a3);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3))originals[F])(a1, a2, a3); });
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3)) { originals[F] = (GLProc)function; function = &Capture3<F, R, A1, A2, A3>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4>
+R CODEGEN_FUNCPTR Capture4(A1 a1, A2 a2, A3 a3, A4 a4) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1); AddTraceArg(call, a2); AddTraceArg(call, a3); AddTraceArg(call, a4);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4))originals[F])(a1, a2, a3, a4); });
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4)) { originals[F] = (GLProc)function; function = &Capture4<F, R, A1, A2, A3, A4>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5>
+R CODEGEN_FUNCPTR Capture5(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1); AddTraceArg(call, a2); AddTraceArg(call, a3); AddTraceArg(call, a4); AddTraceArg(call, a5);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5))originals[F])(a1, a2, a3, a4, a5); });
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5)) { originals[F] = (GLProc)function; function = &Capture5<F, R, A1, A2, A3, A4, A5>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+R CODEGEN_FUNCPTR Capture6(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1); AddTraceArg(call, a2); AddTraceArg(call, a3); AddTraceArg(call, a4); AddTraceArg(call, a5);
+    AddTraceArg(call, a6);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6))originals[F])(a1, a2, a3, a4, a5, a6); });
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6)) { originals[F] = (GLProc)function; function = &Capture6<F, R, A1, A2, A3, A4, A5, A6>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+R CODEGEN_FUNCPTR Capture7(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1); AddTraceArg(call, a2); AddTraceArg(call, a3); AddTraceArg(call, a4); AddTraceArg(call, a5);
+    AddTraceArg(call, a6); AddTraceArg(call, a7);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6, A7))originals[F])(a1, a2, a3, a4, a5, a6, a7); });
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7)) { originals[F] = (GLProc)function; function = &Capture7<F, R, A1, A2, A3, A4, A5, A6, A7>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+R CODEGEN_FUNCPTR Capture8(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1); AddTraceArg(call, a2); AddTraceArg(call, a3); AddTraceArg(call, a4); AddTraceArg(call, a5);
+    AddTraceArg(call, a6); AddTraceArg(call, a7); AddTraceArg(call, a8);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6, A7, A8))originals[F])(a1, a2, a3, a4, a5, a6, a7, a8); });
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8)) { originals[F] = (GLProc)function; function = &Capture8<F, R, A1, A2, A3, A4, A5, A6, A7, A8>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+R CODEGEN_FUNCPTR Capture9(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8, A9 a9) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1); AddTraceArg(call, a2); AddTraceArg(call, a3); AddTraceArg(call, a4); AddTraceArg(call, a5);
+    AddTraceArg(call, a6); AddTraceArg(call, a7); AddTraceArg(call, a8); AddTraceArg(call, a9);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6, A7, A8, A9))originals[F])(a1, a2, a3, a4, a5, a6, a7, a8, a9); });
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8, A9)) { originals[F] = (GLProc)function; function = &Capture9<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+R CODEGEN_FUNCPTR Capture10(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8, A9 a9, A10 a10) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1); AddTraceArg(call, a2); AddTraceArg(call, a3); AddTraceArg(call, a4); AddTraceArg(call, a5);
+    AddTraceArg(call, a6); AddTraceArg(call, a7); AddTraceArg(call, a8); AddTraceArg(call, a9); AddTraceArg(call, a10);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10))originals[F])(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); });
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10)) { originals[F] = (GLProc)function; function = &Capture10<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+R CODEGEN_FUNCPTR Capture11(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8, A9 a9, A10 a10, A11 a11) {
+    GLTraceCall_t call;
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArg(call, a1); AddTraceArg(call, a2); AddTraceArg(call, a3); AddTraceArg(call, a4); AddTraceArg(call, a5);
+    AddTraceArg(call, a6); AddTraceArg(call, a7); AddTraceArg(call, a8); AddTraceArg(call, a9); AddTraceArg(call, a10);
+    AddTraceArg(call, a11);
+    return CaptureInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11))originals[F])(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); });
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+void BindCapture(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11)) { originals[F] = (GLProc)function; function = &Capture11<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11>; }
+
+bool GLCapture::Begin(const char* filename) {
+    assert(!file);
+
+    file = fopen(filename, "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s for writing\n", filename);
+        return false;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    writeBuffer.reserve(2 * GLCAPTURE_WRITE_SIZE);
+
+    GLTraceHeader_t header = {GLTRACE_MAGIC, GLTRACE_VERSION, sizeof(void*), GLFunction::Count};
+    Write(header);
+
+    for (int i=0; i<GLFunction::Count; ++i) {
+        const char* name = GLFunction::GetName((GLFunction::GLFunction)i);
+        Write<uint8_t>((uint8_t)strlen(name));
+        Write(name, strlen(name));
+    }
+
+    #define GL_FUNCTION(name) BindCapture<GLFunction::name>(_ptrc_##name);
+    #include "GLFunctionList.h"
+    #undef GL_FUNCTION
+
+    startTime = Clock::Now();
+    return true;
+}
+
+void GLCapture::EndFrame() {
+    if (!file)
+        return;
+
+    Write<uint16_t>(GLTRACE_FRAME_MARKER);
+    Write<uint64_t>(Clock::Now() - startTime);
+
+    ++stats.frames;
+}
+
+void GLCapture::End() {
+    if (!file)
+        return;
+
+    #define GL_FUNCTION(name) _ptrc_##name = (decltype(_ptrc_##name))originals[GLFunction::name];
+    #include "GLFunctionList.h"
+    #undef GL_FUNCTION
+
+    FlushWrites();
+    fclose(file);
+    file = NULL;
+
+    mappings.clear();
+    unpackBuffer = packBuffer = 0;
+    unpackAlignment = packAlignment = 4;
+}
+
+bool GLCapture::IsCapturing() {
+    return file != NULL;
+}
+
+const GLCaptureStats_t& GLCapture::GetStats() {
+    return stats;
+}
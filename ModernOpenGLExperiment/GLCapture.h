@@ -0,0 +1,60 @@
+#ifndef GLCAPTURE_H
+#define GLCAPTURE_H
+
+#include <cstdint>
+
+#include "Rendering.h"
+
+/**
+ * GLCaptureStats_t - What a capture has written so far
+ */
+typedef struct {
+    uint64_t frames;
+    uint64_t calls;
+
+    // Calls with a pointer we couldn't size, which replay will have to skip
+    uint64_t uncapturedCalls;
+
+    uint64_t bytesWritten;
+} GLCaptureStats_t;
+
+/**
+ * GLCapture
+ * Records every call made through the gl_core_3_3 function pointers into a binary trace
+ * (see GLTrace.h), along with whatever data their pointers point at: buffer and texture
+ * uploads, shader sources, uniform values, and writes through mapped buffers. GLReplay
+ * plays the trace back.
+ *
+ * Begin wraps whichever functions are loaded at the time, so it works on top of a real
+ * driver or NullGL. Like a real context, only one thread may make calls at a time.
+ */
+class GLCapture {
+private:
+    GLCapture() {}
+
+public:
+    /**
+     * Begin
+     * Starts writing a trace to filename. Must be called after the function pointers are
+     * loaded, and before anything is created through them.
+     */
+    static bool Begin(const char* filename);
+
+    /**
+     * EndFrame
+     * Marks the end of a frame, call right before swapping buffers
+     */
+    static void EndFrame();
+
+    /**
+     * End
+     * Flushes and closes the trace, and puts the original function pointers back
+     */
+    static void End();
+
+    static bool IsCapturing();
+
+    static const GLCaptureStats_t& GetStats();
+};
+
+#endif
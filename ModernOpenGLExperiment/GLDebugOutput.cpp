@@ -0,0 +1,186 @@
+#include "GLDebugOutput.h"
+#include "GLFunctions.h"
+
+#include <algorithm>
+#include <cstring>
+
+// GL_ARB_debug_output, which gl_core_3_3 doesn't load
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB 0x8242
+
+#define GL_DEBUG_SOURCE_API_ARB             0x8246
+#define GL_DEBUG_SOURCE_WINDOW_SYSTEM_ARB   0x8247
+#define GL_DEBUG_SOURCE_SHADER_COMPILER_ARB 0x8248
+#define GL_DEBUG_SOURCE_THIRD_PARTY_ARB     0x8249
+#define GL_DEBUG_SOURCE_APPLICATION_ARB     0x824A
+
+#define GL_DEBUG_TYPE_ERROR_ARB               0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR_ARB 0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR_ARB  0x824E
+#define GL_DEBUG_TYPE_PORTABILITY_ARB         0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE_ARB         0x8250
+
+#define GL_DEBUG_SEVERITY_HIGH_ARB   0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM_ARB 0x9147
+#define GL_DEBUG_SEVERITY_LOW_ARB    0x9148
+
+typedef void (CODEGEN_FUNCPTR *PFNDEBUGMESSAGECALLBACKARB)(GLDEBUGPROCARB callback, const GLvoid* userParam);
+typedef void (CODEGEN_FUNCPTR *PFNDEBUGMESSAGECONTROLARB)(GLenum source, GLenum type, GLenum severity, GLsizei count,
+    const GLuint* ids, GLboolean enabled);
+
+bool GLDebugOutput::enabled = false;
+FILE* GLDebugOutput::log = NULL;
+
+uint32_t GLDebugOutput::frame = 0;
+uint32_t GLDebugOutput::frameWarnings = 0;
+uint64_t GLDebugOutput::otherMessages = 0;
+
+std::map<GLDebugOutput::MessageKey_t, GLPerfWarningStats_t> GLDebugOutput::perfWarnings;
+std::map<GLDebugOutput::MessageKey_t, uint32_t> GLDebugOutput::frameCounts;
+
+static PFNDEBUGMESSAGECALLBACKARB debugMessageCallback = NULL;
+static PFNDEBUGMESSAGECONTROLARB debugMessageControl = NULL;
+
+static const char* GetSourceName(GLenum source) {
+    switch (source) {
+        case GL_DEBUG_SOURCE_API_ARB:             return "API";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM_ARB:   return "Window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER_ARB: return "Shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY_ARB:     return "Third party";
+        case GL_DEBUG_SOURCE_APPLICATION_ARB:     return "Application";
+        default:                                  return "Other";
+    }
+}
+
+static const char* GetTypeName(GLenum type) {
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR_ARB:               return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR_ARB: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR_ARB:  return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY_ARB:         return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE_ARB:         return "performance";
+        default:                                    return "message";
+    }
+}
+
+static const char* GetSeverityName(GLenum severity) {
+    switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH_ARB:   return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM_ARB: return "medium";
+        default:                           return "low";
+    }
+}
+
+void APIENTRY GLDebugOutput::OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
+    GLsizei, const GLchar* message, GLvoid*) {
+
+    if (type != GL_DEBUG_TYPE_PERFORMANCE_ARB) {
+        fprintf(log, "GL %s %s (%s, %u): %s\n", GetSourceName(source), GetTypeName(type),
+            GetSeverityName(severity), id, message);
+
+        ++otherMessages;
+        return;
+    }
+
+    MessageKey_t key(source, id);
+    ++frameCounts[key];
+
+    if (perfWarnings.find(key) == perfWarnings.end()) {
+        GLPerfWarningStats_t& warning = perfWarnings[key];
+        warning.source = source;
+        warning.id = id;
+        warning.message = message;
+        warning.count = 0;
+        warning.frames = 0;
+        warning.maxPerFrame = 0;
+        warning.firstFrame = frame;
+        warning.lastFrame = frame;
+
+        fprintf(log, "GL %s performance (%s, %u) in frame %u: %s\n", GetSourceName(source),
+            GetSeverityName(severity), id, frame, message);
+    }
+}
+
+bool GLDebugOutput::Startup(const char* logFile) {
+    log = stderr;
+    if (logFile != NULL && (log = fopen(logFile, "w")) == NULL) {
+        fprintf(stderr, "Failed to open %s for writing\n", logFile);
+        log = stderr;
+    }
+
+    if (!GLFunction::HasExtension("GL_ARB_debug_output"))
+        return false;
+
+    debugMessageCallback = (PFNDEBUGMESSAGECALLBACKARB)glfwGetProcAddress("glDebugMessageCallbackARB");
+    debugMessageControl = (PFNDEBUGMESSAGECONTROLARB)glfwGetProcAddress("glDebugMessageControlARB");
+
+    if (debugMessageCallback == NULL || debugMessageControl == NULL)
+        return false;
+
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB);
+    debugMessageCallback(&OnMessage, NULL);
+
+    // Low severity messages are off by default, and that's where drivers put most of
+    // their performance warnings
+    debugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PERFORMANCE_ARB, GL_DONT_CARE, 0, NULL, GL_TRUE);
+
+    enabled = true;
+    return true;
+}
+
+void GLDebugOutput::EndFrame() {
+    frameWarnings = 0;
+
+    for (auto it=frameCounts.begin(); it!=frameCounts.end(); ++it) {
+        GLPerfWarningStats_t& warning = perfWarnings[it->first];
+        uint32_t count = it->second;
+
+        warning.count += count;
+        warning.lastFrame = frame;
+        ++warning.frames;
+
+        // The first frame it fired in was logged along with the message itself
+        if (count > warning.maxPerFrame && warning.maxPerFrame > 0) {
+            fprintf(log, "GL %s performance (%u) fired %u times in frame %u, up from at most %u: %s\n",
+                GetSourceName(warning.source), warning.id, count, frame, warning.maxPerFrame,
+                warning.message.c_str());
+        }
+
+        warning.maxPerFrame = std::max(warning.maxPerFrame, count);
+        frameWarnings += count;
+    }
+
+    frameCounts.clear();
+    ++frame;
+}
+
+void GLDebugOutput::Dump() {
+    if (perfWarnings.empty())
+        return;
+
+    fprintf(log, "GL performance warnings over %u frames:\n", frame);
+    fprintf(log, "  source                   id       total  frames  max/frame\n");
+
+    for (auto it=perfWarnings.begin(); it!=perfWarnings.end(); ++it) {
+        const GLPerfWarningStats_t& warning = it->second;
+
+        fprintf(log, "  %-16s %10u  %10llu  %6u  %9u  %s\n", GetSourceName(warning.source), warning.id,
+            (unsigned long long)warning.count, warning.frames, warning.maxPerFrame, warning.message.c_str());
+    }
+
+    if (otherMessages > 0)
+        fprintf(log, "  (and %llu other messages)\n", (unsigned long long)otherMessages);
+}
+
+void GLDebugOutput::Shutdown() {
+    if (enabled)
+        debugMessageCallback(NULL, NULL);
+
+    if (log != NULL && log != stderr)
+        fclose(log);
+
+    log = NULL;
+    enabled = false;
+
+    perfWarnings.clear();
+    frameCounts.clear();
+}
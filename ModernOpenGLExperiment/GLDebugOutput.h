@@ -0,0 +1,93 @@
+#ifndef GLDEBUGOUTPUT_H
+#define GLDEBUGOUTPUT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include "Rendering.h"
+
+/**
+ * GLPerfWarningStats_t - How often one performance warning has fired
+ */
+typedef struct {
+    GLenum source;
+    GLuint id;
+    std::string message; // From the first time it fired
+
+    uint64_t count;
+    uint32_t frames;       // Frames it fired in at least once
+    uint32_t maxPerFrame;
+    uint32_t firstFrame;
+    uint32_t lastFrame;
+} GLPerfWarningStats_t;
+
+/**
+ * GLDebugOutput
+ * Installs a GL_ARB_debug_output callback, if the driver has the extension (the generated
+ * loader doesn't know about it), and routes what the driver says to a log.
+ *
+ * Performance warnings (buffer stalls, shader recompiles, redundant state and so on) tend
+ * to fire over and over, so only the first of each ID is logged in full. After that they
+ * are counted per frame, and a line is logged whenever one fires more often in a frame
+ * than it ever has before, so a warning that starts firing more after a change stands out
+ * without drowning the log. Everything else is logged as it comes.
+ *
+ * Messages are made synchronous, so the callback always runs on the thread that made the
+ * offending call, which has to be the one calling EndFrame.
+ */
+class GLDebugOutput {
+private:
+    typedef std::pair<GLenum, GLuint> MessageKey_t;
+
+    static bool enabled;
+    static FILE* log;
+
+    static uint32_t frame;
+    static uint32_t frameWarnings;
+    static uint64_t otherMessages;
+
+    static std::map<MessageKey_t, GLPerfWarningStats_t> perfWarnings;
+
+    // Times each performance warning fired this frame
+    static std::map<MessageKey_t, uint32_t> frameCounts;
+
+    static void APIENTRY OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
+        GLsizei length, const GLchar* message, GLvoid* userParam);
+
+    GLDebugOutput() {}
+
+public:
+    /**
+     * Startup
+     * Installs the callback, logging to logFile or stderr if it's NULL. Returns false if
+     * the driver doesn't have GL_ARB_debug_output, in which case nothing gets logged.
+     * Needs the GL functions loaded.
+     */
+    static bool Startup(const char* logFile);
+
+    /**
+     * EndFrame
+     * Folds this frame's performance warnings into their totals
+     */
+    static void EndFrame();
+
+    static bool IsEnabled() { return enabled; }
+
+    /**
+     * GetFrameWarnings
+     * Returns how many performance warnings fired in the frame EndFrame last ended
+     */
+    static uint32_t GetFrameWarnings() { return frameWarnings; }
+
+    /**
+     * Dump
+     * Logs the totals for every performance warning seen so far
+     */
+    static void Dump();
+
+    static void Shutdown();
+};
+
+#endif
@@ -0,0 +1,343 @@
+// Every entry point that gl_core_3_3 loads, in the order gl_core_3_3.h declares them.
+// Define GL_FUNCTION(name) before including; regenerate whenever gl_core_3_3 is.
+
+GL_FUNCTION(glCullFace)
+GL_FUNCTION(glFrontFace)
+GL_FUNCTION(glHint)
+GL_FUNCTION(glLineWidth)
+GL_FUNCTION(glPointSize)
+GL_FUNCTION(glPolygonMode)
+GL_FUNCTION(glScissor)
+GL_FUNCTION(glTexParameterf)
+GL_FUNCTION(glTexParameterfv)
+GL_FUNCTION(glTexParameteri)
+GL_FUNCTION(glTexParameteriv)
+GL_FUNCTION(glTexImage1D)
+GL_FUNCTION(glTexImage2D)
+GL_FUNCTION(glDrawBuffer)
+GL_FUNCTION(glClear)
+GL_FUNCTION(glClearColor)
+GL_FUNCTION(glClearStencil)
+GL_FUNCTION(glClearDepth)
+GL_FUNCTION(glStencilMask)
+GL_FUNCTION(glColorMask)
+GL_FUNCTION(glDepthMask)
+GL_FUNCTION(glDisable)
+GL_FUNCTION(glEnable)
+GL_FUNCTION(glFinish)
+GL_FUNCTION(glFlush)
+GL_FUNCTION(glBlendFunc)
+GL_FUNCTION(glLogicOp)
+GL_FUNCTION(glStencilFunc)
+GL_FUNCTION(glStencilOp)
+GL_FUNCTION(glDepthFunc)
+GL_FUNCTION(glPixelStoref)
+GL_FUNCTION(glPixelStorei)
+GL_FUNCTION(glReadBuffer)
+GL_FUNCTION(glReadPixels)
+GL_FUNCTION(glGetBooleanv)
+GL_FUNCTION(glGetDoublev)
+GL_FUNCTION(glGetError)
+GL_FUNCTION(glGetFloatv)
+GL_FUNCTION(glGetIntegerv)
+GL_FUNCTION(glGetString)
+GL_FUNCTION(glGetTexImage)
+GL_FUNCTION(glGetTexParameterfv)
+GL_FUNCTION(glGetTexParameteriv)
+GL_FUNCTION(glGetTexLevelParameterfv)
+GL_FUNCTION(glGetTexLevelParameteriv)
+GL_FUNCTION(glIsEnabled)
+GL_FUNCTION(glDepthRange)
+GL_FUNCTION(glViewport)
+GL_FUNCTION(glDrawArrays)
+GL_FUNCTION(glDrawElements)
+GL_FUNCTION(glGetPointerv)
+GL_FUNCTION(glPolygonOffset)
+GL_FUNCTION(glCopyTexImage1D)
+GL_FUNCTION(glCopyTexImage2D)
+GL_FUNCTION(glCopyTexSubImage1D)
+GL_FUNCTION(glCopyTexSubImage2D)
+GL_FUNCTION(glTexSubImage1D)
+GL_FUNCTION(glTexSubImage2D)
+GL_FUNCTION(glBindTexture)
+GL_FUNCTION(glDeleteTextures)
+GL_FUNCTION(glGenTextures)
+GL_FUNCTION(glIsTexture)
+GL_FUNCTION(glIndexub)
+GL_FUNCTION(glIndexubv)
+GL_FUNCTION(glBlendColor)
+GL_FUNCTION(glBlendEquation)
+GL_FUNCTION(glDrawRangeElements)
+GL_FUNCTION(glTexSubImage3D)
+GL_FUNCTION(glCopyTexSubImage3D)
+GL_FUNCTION(glActiveTexture)
+GL_FUNCTION(glSampleCoverage)
+GL_FUNCTION(glCompressedTexImage3D)
+GL_FUNCTION(glCompressedTexImage2D)
+GL_FUNCTION(glCompressedTexImage1D)
+GL_FUNCTION(glCompressedTexSubImage3D)
+GL_FUNCTION(glCompressedTexSubImage2D)
+GL_FUNCTION(glCompressedTexSubImage1D)
+GL_FUNCTION(glGetCompressedTexImage)
+GL_FUNCTION(glBlendFuncSeparate)
+GL_FUNCTION(glMultiDrawArrays)
+GL_FUNCTION(glMultiDrawElements)
+GL_FUNCTION(glPointParameterf)
+GL_FUNCTION(glPointParameterfv)
+GL_FUNCTION(glPointParameteri)
+GL_FUNCTION(glPointParameteriv)
+GL_FUNCTION(glGenQueries)
+GL_FUNCTION(glDeleteQueries)
+GL_FUNCTION(glIsQuery)
+GL_FUNCTION(glBeginQuery)
+GL_FUNCTION(glEndQuery)
+GL_FUNCTION(glGetQueryiv)
+GL_FUNCTION(glGetQueryObjectiv)
+GL_FUNCTION(glGetQueryObjectuiv)
+GL_FUNCTION(glBindBuffer)
+GL_FUNCTION(glDeleteBuffers)
+GL_FUNCTION(glGenBuffers)
+GL_FUNCTION(glIsBuffer)
+GL_FUNCTION(glBufferData)
+GL_FUNCTION(glBufferSubData)
+GL_FUNCTION(glGetBufferSubData)
+GL_FUNCTION(glMapBuffer)
+GL_FUNCTION(glUnmapBuffer)
+GL_FUNCTION(glGetBufferParameteriv)
+GL_FUNCTION(glGetBufferPointerv)
+GL_FUNCTION(glBlendEquationSeparate)
+GL_FUNCTION(glDrawBuffers)
+GL_FUNCTION(glStencilOpSeparate)
+GL_FUNCTION(glStencilFuncSeparate)
+GL_FUNCTION(glStencilMaskSeparate)
+GL_FUNCTION(glAttachShader)
+GL_FUNCTION(glBindAttribLocation)
+GL_FUNCTION(glCompileShader)
+GL_FUNCTION(glCreateProgram)
+GL_FUNCTION(glCreateShader)
+GL_FUNCTION(glDeleteProgram)
+GL_FUNCTION(glDeleteShader)
+GL_FUNCTION(glDetachShader)
+GL_FUNCTION(glDisableVertexAttribArray)
+GL_FUNCTION(glEnableVertexAttribArray)
+GL_FUNCTION(glGetActiveAttrib)
+GL_FUNCTION(glGetActiveUniform)
+GL_FUNCTION(glGetAttachedShaders)
+GL_FUNCTION(glGetAttribLocation)
+GL_FUNCTION(glGetProgramiv)
+GL_FUNCTION(glGetProgramInfoLog)
+GL_FUNCTION(glGetShaderiv)
+GL_FUNCTION(glGetShaderInfoLog)
+GL_FUNCTION(glGetShaderSource)
+GL_FUNCTION(glGetUniformLocation)
+GL_FUNCTION(glGetUniformfv)
+GL_FUNCTION(glGetUniformiv)
+GL_FUNCTION(glGetVertexAttribdv)
+GL_FUNCTION(glGetVertexAttribfv)
+GL_FUNCTION(glGetVertexAttribiv)
+GL_FUNCTION(glGetVertexAttribPointerv)
+GL_FUNCTION(glIsProgram)
+GL_FUNCTION(glIsShader)
+GL_FUNCTION(glLinkProgram)
+GL_FUNCTION(glShaderSource)
+GL_FUNCTION(glUseProgram)
+GL_FUNCTION(glUniform1f)
+GL_FUNCTION(glUniform2f)
+GL_FUNCTION(glUniform3f)
+GL_FUNCTION(glUniform4f)
+GL_FUNCTION(glUniform1i)
+GL_FUNCTION(glUniform2i)
+GL_FUNCTION(glUniform3i)
+GL_FUNCTION(glUniform4i)
+GL_FUNCTION(glUniform1fv)
+GL_FUNCTION(glUniform2fv)
+GL_FUNCTION(glUniform3fv)
+GL_FUNCTION(glUniform4fv)
+GL_FUNCTION(glUniform1iv)
+GL_FUNCTION(glUniform2iv)
+GL_FUNCTION(glUniform3iv)
+GL_FUNCTION(glUniform4iv)
+GL_FUNCTION(glUniformMatrix2fv)
+GL_FUNCTION(glUniformMatrix3fv)
+GL_FUNCTION(glUniformMatrix4fv)
+GL_FUNCTION(glValidateProgram)
+GL_FUNCTION(glVertexAttribPointer)
+GL_FUNCTION(glUniformMatrix2x3fv)
+GL_FUNCTION(glUniformMatrix3x2fv)
+GL_FUNCTION(glUniformMatrix2x4fv)
+GL_FUNCTION(glUniformMatrix4x2fv)
+GL_FUNCTION(glUniformMatrix3x4fv)
+GL_FUNCTION(glUniformMatrix4x3fv)
+GL_FUNCTION(glBindVertexArray)
+GL_FUNCTION(glDeleteVertexArrays)
+GL_FUNCTION(glGenVertexArrays)
+GL_FUNCTION(glIsVertexArray)
+GL_FUNCTION(glMapBufferRange)
+GL_FUNCTION(glFlushMappedBufferRange)
+GL_FUNCTION(glIsRenderbuffer)
+GL_FUNCTION(glBindRenderbuffer)
+GL_FUNCTION(glDeleteRenderbuffers)
+GL_FUNCTION(glGenRenderbuffers)
+GL_FUNCTION(glRenderbufferStorage)
+GL_FUNCTION(glGetRenderbufferParameteriv)
+GL_FUNCTION(glIsFramebuffer)
+GL_FUNCTION(glBindFramebuffer)
+GL_FUNCTION(glDeleteFramebuffers)
+GL_FUNCTION(glGenFramebuffers)
+GL_FUNCTION(glCheckFramebufferStatus)
+GL_FUNCTION(glFramebufferTexture1D)
+GL_FUNCTION(glFramebufferTexture2D)
+GL_FUNCTION(glFramebufferTexture3D)
+GL_FUNCTION(glFramebufferRenderbuffer)
+GL_FUNCTION(glGetFramebufferAttachmentParameteriv)
+GL_FUNCTION(glGenerateMipmap)
+GL_FUNCTION(glBlitFramebuffer)
+GL_FUNCTION(glRenderbufferStorageMultisample)
+GL_FUNCTION(glFramebufferTextureLayer)
+GL_FUNCTION(glColorMaski)
+GL_FUNCTION(glGetBooleani_v)
+GL_FUNCTION(glGetIntegeri_v)
+GL_FUNCTION(glEnablei)
+GL_FUNCTION(glDisablei)
+GL_FUNCTION(glIsEnabledi)
+GL_FUNCTION(glBeginTransformFeedback)
+GL_FUNCTION(glEndTransformFeedback)
+GL_FUNCTION(glBindBufferRange)
+GL_FUNCTION(glBindBufferBase)
+GL_FUNCTION(glTransformFeedbackVaryings)
+GL_FUNCTION(glGetTransformFeedbackVarying)
+GL_FUNCTION(glClampColor)
+GL_FUNCTION(glBeginConditionalRender)
+GL_FUNCTION(glEndConditionalRender)
+GL_FUNCTION(glVertexAttribIPointer)
+GL_FUNCTION(glGetVertexAttribIiv)
+GL_FUNCTION(glGetVertexAttribIuiv)
+GL_FUNCTION(glVertexAttribI1i)
+GL_FUNCTION(glVertexAttribI2i)
+GL_FUNCTION(glVertexAttribI3i)
+GL_FUNCTION(glVertexAttribI4i)
+GL_FUNCTION(glVertexAttribI1ui)
+GL_FUNCTION(glVertexAttribI2ui)
+GL_FUNCTION(glVertexAttribI3ui)
+GL_FUNCTION(glVertexAttribI4ui)
+GL_FUNCTION(glVertexAttribI1iv)
+GL_FUNCTION(glVertexAttribI2iv)
+GL_FUNCTION(glVertexAttribI3iv)
+GL_FUNCTION(glVertexAttribI4iv)
+GL_FUNCTION(glVertexAttribI1uiv)
+GL_FUNCTION(glVertexAttribI2uiv)
+GL_FUNCTION(glVertexAttribI3uiv)
+GL_FUNCTION(glVertexAttribI4uiv)
+GL_FUNCTION(glVertexAttribI4bv)
+GL_FUNCTION(glVertexAttribI4sv)
+GL_FUNCTION(glVertexAttribI4ubv)
+GL_FUNCTION(glVertexAttribI4usv)
+GL_FUNCTION(glGetUniformuiv)
+GL_FUNCTION(glBindFragDataLocation)
+GL_FUNCTION(glGetFragDataLocation)
+GL_FUNCTION(glUniform1ui)
+GL_FUNCTION(glUniform2ui)
+GL_FUNCTION(glUniform3ui)
+GL_FUNCTION(glUniform4ui)
+GL_FUNCTION(glUniform1uiv)
+GL_FUNCTION(glUniform2uiv)
+GL_FUNCTION(glUniform3uiv)
+GL_FUNCTION(glUniform4uiv)
+GL_FUNCTION(glTexParameterIiv)
+GL_FUNCTION(glTexParameterIuiv)
+GL_FUNCTION(glGetTexParameterIiv)
+GL_FUNCTION(glGetTexParameterIuiv)
+GL_FUNCTION(glClearBufferiv)
+GL_FUNCTION(glClearBufferuiv)
+GL_FUNCTION(glClearBufferfv)
+GL_FUNCTION(glClearBufferfi)
+GL_FUNCTION(glGetStringi)
+GL_FUNCTION(glGetUniformIndices)
+GL_FUNCTION(glGetActiveUniformsiv)
+GL_FUNCTION(glGetActiveUniformName)
+GL_FUNCTION(glGetUniformBlockIndex)
+GL_FUNCTION(glGetActiveUniformBlockiv)
+GL_FUNCTION(glGetActiveUniformBlockName)
+GL_FUNCTION(glUniformBlockBinding)
+GL_FUNCTION(glCopyBufferSubData)
+GL_FUNCTION(glDrawArraysInstanced)
+GL_FUNCTION(glDrawElementsInstanced)
+GL_FUNCTION(glTexBuffer)
+GL_FUNCTION(glPrimitiveRestartIndex)
+GL_FUNCTION(glDrawElementsBaseVertex)
+GL_FUNCTION(glDrawRangeElementsBaseVertex)
+GL_FUNCTION(glDrawElementsInstancedBaseVertex)
+GL_FUNCTION(glMultiDrawElementsBaseVertex)
+GL_FUNCTION(glProvokingVertex)
+GL_FUNCTION(glFenceSync)
+GL_FUNCTION(glIsSync)
+GL_FUNCTION(glDeleteSync)
+GL_FUNCTION(glClientWaitSync)
+GL_FUNCTION(glWaitSync)
+GL_FUNCTION(glGetInteger64v)
+GL_FUNCTION(glGetSynciv)
+GL_FUNCTION(glTexImage2DMultisample)
+GL_FUNCTION(glTexImage3DMultisample)
+GL_FUNCTION(glGetMultisamplefv)
+GL_FUNCTION(glSampleMaski)
+GL_FUNCTION(glGetInteger64i_v)
+GL_FUNCTION(glGetBufferParameteri64v)
+GL_FUNCTION(glFramebufferTexture)
+GL_FUNCTION(glQueryCounter)
+GL_FUNCTION(glGetQueryObjecti64v)
+GL_FUNCTION(glGetQueryObjectui64v)
+GL_FUNCTION(glVertexP2ui)
+GL_FUNCTION(glVertexP2uiv)
+GL_FUNCTION(glVertexP3ui)
+GL_FUNCTION(glVertexP3uiv)
+GL_FUNCTION(glVertexP4ui)
+GL_FUNCTION(glVertexP4uiv)
+GL_FUNCTION(glTexCoordP1ui)
+GL_FUNCTION(glTexCoordP1uiv)
+GL_FUNCTION(glTexCoordP2ui)
+GL_FUNCTION(glTexCoordP2uiv)
+GL_FUNCTION(glTexCoordP3ui)
+GL_FUNCTION(glTexCoordP3uiv)
+GL_FUNCTION(glTexCoordP4ui)
+GL_FUNCTION(glTexCoordP4uiv)
+GL_FUNCTION(glMultiTexCoordP1ui)
+GL_FUNCTION(glMultiTexCoordP1uiv)
+GL_FUNCTION(glMultiTexCoordP2ui)
+GL_FUNCTION(glMultiTexCoordP2uiv)
+GL_FUNCTION(glMultiTexCoordP3ui)
+GL_FUNCTION(glMultiTexCoordP3uiv)
+GL_FUNCTION(glMultiTexCoordP4ui)
+GL_FUNCTION(glMultiTexCoordP4uiv)
+GL_FUNCTION(glNormalP3ui)
+GL_FUNCTION(glNormalP3uiv)
+GL_FUNCTION(glColorP3ui)
+GL_FUNCTION(glColorP3uiv)
+GL_FUNCTION(glColorP4ui)
+GL_FUNCTION(glColorP4uiv)
+GL_FUNCTION(glSecondaryColorP3ui)
+GL_FUNCTION(glSecondaryColorP3uiv)
+GL_FUNCTION(glVertexAttribP1ui)
+GL_FUNCTION(glVertexAttribP1uiv)
+GL_FUNCTION(glVertexAttribP2ui)
+GL_FUNCTION(glVertexAttribP2uiv)
+GL_FUNCTION(glVertexAttribP3ui)
+GL_FUNCTION(glVertexAttribP3uiv)
+GL_FUNCTION(glVertexAttribP4ui)
+GL_FUNCTION(glVertexAttribP4uiv)
+GL_FUNCTION(glBindFragDataLocationIndexed)
+GL_FUNCTION(glGetFragDataIndex)
+GL_FUNCTION(glGenSamplers)
+GL_FUNCTION(glDeleteSamplers)
+GL_FUNCTION(glIsSampler)
+GL_FUNCTION(glBindSampler)
+GL_FUNCTION(glSamplerParameteri)
+GL_FUNCTION(glSamplerParameteriv)
+GL_FUNCTION(glSamplerParameterf)
+GL_FUNCTION(glSamplerParameterfv)
+GL_FUNCTION(glSamplerParameterIiv)
+GL_FUNCTION(glSamplerParameterIuiv)
+GL_FUNCTION(glGetSamplerParameteriv)
+GL_FUNCTION(glGetSamplerParameterIiv)
+GL_FUNCTION(glGetSamplerParameterfv)
+GL_FUNCTION(glGetSamplerParameterIuiv)
+GL_FUNCTION(glVertexAttribDivisor)
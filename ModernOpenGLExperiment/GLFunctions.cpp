@@ -0,0 +1,35 @@
+#include "GLFunctions.h"
+
+#include <cstring>
+
+static const char* FUNCTION_NAMES[] = {
+    #define GL_FUNCTION(name) #name,
+    #include "GLFunctionList.h"
+    #undef GL_FUNCTION
+};
+
+const char* GLFunction::GetName(GLFunction function) {
+    return function < Count ? FUNCTION_NAMES[function] : "";
+}
+
+GLFunction::GLFunction GLFunction::Find(const char* name) {
+    for (int i=0; i<Count; ++i)
+        if (strcmp(FUNCTION_NAMES[i], name) == 0)
+            return (GLFunction)i;
+
+    return Count;
+}
+
+bool GLFunction::HasExtension(const char* name) {
+    // In here the enum's names hide the function pointers they're named after
+    GLint count = 0;
+    ::glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (GLint i=0; i<count; ++i) {
+        const char* extension = (const char*)::glGetStringi(GL_EXTENSIONS, i);
+        if (extension != NULL && strcmp(extension, name) == 0)
+            return true;
+    }
+
+    return false;
+}
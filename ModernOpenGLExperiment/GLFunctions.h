@@ -0,0 +1,46 @@
+#ifndef GLFUNCTIONS_H
+#define GLFUNCTIONS_H
+
+#include <cstdint>
+
+#include "Rendering.h"
+
+/**
+ * GLFunction - One value per entry point in gl_core_3_3, for tools that wrap or replace
+ * the function pointers (NullGL, GLCapture). Entry points keep their gl prefix, e.g.
+ * GLFunction::glDrawElements.
+ */
+namespace GLFunction {
+    enum GLFunction {
+        #define GL_FUNCTION(name) name,
+        #include "GLFunctionList.h"
+        #undef GL_FUNCTION
+
+        Count
+    };
+
+    const char* GetName(GLFunction function);
+
+    /**
+     * Find
+     * Looks an entry point up by name, returning Count if there is none
+     */
+    GLFunction Find(const char* name);
+
+    /**
+     * HasExtension
+     * Whether the current context lists the named extension, e.g. "GL_ARB_debug_output".
+     * gl_core_3_3 doesn't load any, so their entry points have to be looked up by hand.
+     */
+    bool HasExtension(const char* name);
+};
+
+/**
+ * GLCallCount_t - How many times one GL entry point was called
+ */
+typedef struct {
+    const char* name;
+    uint64_t calls;
+} GLCallCount_t;
+
+#endif
@@ -0,0 +1,745 @@
+#include "GLReplay.h"
+#include "GLTrace.h"
+#include "Clock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+
+// Smallest scratch space handed to calls that write through a pointer
+#define GLREPLAY_MIN_SCRATCH (64 * 1024)
+
+typedef void (CODEGEN_FUNCPTR* GLProc)();
+typedef void (*Replayer)(GLTraceCall_t& call);
+
+// The functions being replayed into, and how to replay each of them
+static GLProc originals[GLFunction::Count];
+static Replayer replayers[GLFunction::Count];
+
+namespace ObjectKind {
+    enum ObjectKind {
+        None,
+        Buffer,
+        Texture,
+        VertexArray,
+        Program,
+        Shader,
+        Query,
+        Framebuffer,
+        Renderbuffer,
+        Sampler,
+        Sync,
+        Count
+    };
+};
+
+typedef struct {
+    GLFunction::GLFunction function;
+    uint8_t arg;
+    ObjectKind::ObjectKind kind;
+} NameArg_t;
+
+// Arguments that name an object
+static const NameArg_t NAME_ARGS[] = {
+    {GLFunction::glBindBuffer,                   1, ObjectKind::Buffer},
+    {GLFunction::glBindBufferRange,              2, ObjectKind::Buffer},
+    {GLFunction::glBindBufferBase,               2, ObjectKind::Buffer},
+    {GLFunction::glIsBuffer,                     0, ObjectKind::Buffer},
+    {GLFunction::glTexBuffer,                    2, ObjectKind::Buffer},
+
+    {GLFunction::glBindTexture,                  1, ObjectKind::Texture},
+    {GLFunction::glIsTexture,                    0, ObjectKind::Texture},
+    {GLFunction::glFramebufferTexture,           2, ObjectKind::Texture},
+    {GLFunction::glFramebufferTexture1D,         3, ObjectKind::Texture},
+    {GLFunction::glFramebufferTexture2D,         3, ObjectKind::Texture},
+    {GLFunction::glFramebufferTexture3D,         3, ObjectKind::Texture},
+    {GLFunction::glFramebufferTextureLayer,      2, ObjectKind::Texture},
+
+    {GLFunction::glBindVertexArray,              0, ObjectKind::VertexArray},
+    {GLFunction::glIsVertexArray,                0, ObjectKind::VertexArray},
+
+    {GLFunction::glUseProgram,                   0, ObjectKind::Program},
+    {GLFunction::glAttachShader,                 0, ObjectKind::Program},
+    {GLFunction::glDetachShader,                 0, ObjectKind::Program},
+    {GLFunction::glLinkProgram,                  0, ObjectKind::Program},
+    {GLFunction::glValidateProgram,              0, ObjectKind::Program},
+    {GLFunction::glDeleteProgram,                0, ObjectKind::Program},
+    {GLFunction::glIsProgram,                    0, ObjectKind::Program},
+    {GLFunction::glGetProgramiv,                 0, ObjectKind::Program},
+    {GLFunction::glGetProgramInfoLog,            0, ObjectKind::Program},
+    {GLFunction::glGetAttachedShaders,           0, ObjectKind::Program},
+    {GLFunction::glGetUniformLocation,           0, ObjectKind::Program},
+    {GLFunction::glGetUniformIndices,            0, ObjectKind::Program},
+    {GLFunction::glGetUniformBlockIndex,         0, ObjectKind::Program},
+    {GLFunction::glGetUniformfv,                 0, ObjectKind::Program},
+    {GLFunction::glGetUniformiv,                 0, ObjectKind::Program},
+    {GLFunction::glGetUniformuiv,                0, ObjectKind::Program},
+    {GLFunction::glUniformBlockBinding,          0, ObjectKind::Program},
+    {GLFunction::glGetActiveUniform,             0, ObjectKind::Program},
+    {GLFunction::glGetActiveUniformsiv,          0, ObjectKind::Program},
+    {GLFunction::glGetActiveUniformName,         0, ObjectKind::Program},
+    {GLFunction::glGetActiveUniformBlockiv,      0, ObjectKind::Program},
+    {GLFunction::glGetActiveUniformBlockName,    0, ObjectKind::Program},
+    {GLFunction::glGetActiveAttrib,              0, ObjectKind::Program},
+    {GLFunction::glGetAttribLocation,            0, ObjectKind::Program},
+    {GLFunction::glBindAttribLocation,           0, ObjectKind::Program},
+    {GLFunction::glBindFragDataLocation,         0, ObjectKind::Program},
+    {GLFunction::glBindFragDataLocationIndexed,  0, ObjectKind::Program},
+    {GLFunction::glGetFragDataLocation,          0, ObjectKind::Program},
+    {GLFunction::glGetFragDataIndex,             0, ObjectKind::Program},
+    {GLFunction::glTransformFeedbackVaryings,    0, ObjectKind::Program},
+    {GLFunction::glGetTransformFeedbackVarying,  0, ObjectKind::Program},
+
+    {GLFunction::glAttachShader,                 1, ObjectKind::Shader},
+    {GLFunction::glDetachShader,                 1, ObjectKind::Shader},
+    {GLFunction::glShaderSource,                 0, ObjectKind::Shader},
+    {GLFunction::glCompileShader,                0, ObjectKind::Shader},
+    {GLFunction::glDeleteShader,                 0, ObjectKind::Shader},
+    {GLFunction::glIsShader,                     0, ObjectKind::Shader},
+    {GLFunction::glGetShaderiv,                  0, ObjectKind::Shader},
+    {GLFunction::glGetShaderInfoLog,             0, ObjectKind::Shader},
+    {GLFunction::glGetShaderSource,              0, ObjectKind::Shader},
+
+    {GLFunction::glBeginQuery,                   1, ObjectKind::Query},
+    {GLFunction::glQueryCounter,                 0, ObjectKind::Query},
+    {GLFunction::glIsQuery,                      0, ObjectKind::Query},
+    {GLFunction::glGetQueryObjectiv,             0, ObjectKind::Query},
+    {GLFunction::glGetQueryObjectuiv,            0, ObjectKind::Query},
+    {GLFunction::glGetQueryObjecti64v,           0, ObjectKind::Query},
+    {GLFunction::glGetQueryObjectui64v,          0, ObjectKind::Query},
+    {GLFunction::glBeginConditionalRender,       0, ObjectKind::Query},
+
+    {GLFunction::glBindFramebuffer,              1, ObjectKind::Framebuffer},
+    {GLFunction::glIsFramebuffer,                0, ObjectKind::Framebuffer},
+
+    {GLFunction::glBindRenderbuffer,             1, ObjectKind::Renderbuffer},
+    {GLFunction::glFramebufferRenderbuffer,      3, ObjectKind::Renderbuffer},
+    {GLFunction::glIsRenderbuffer,               0, ObjectKind::Renderbuffer},
+
+    {GLFunction::glBindSampler,                  1, ObjectKind::Sampler},
+    {GLFunction::glIsSampler,                    0, ObjectKind::Sampler},
+    {GLFunction::glSamplerParameteri,            0, ObjectKind::Sampler},
+    {GLFunction::glSamplerParameteriv,           0, ObjectKind::Sampler},
+    {GLFunction::glSamplerParameterf,            0, ObjectKind::Sampler},
+    {GLFunction::glSamplerParameterfv,           0, ObjectKind::Sampler},
+    {GLFunction::glSamplerParameterIiv,          0, ObjectKind::Sampler},
+    {GLFunction::glSamplerParameterIuiv,         0, ObjectKind::Sampler},
+    {GLFunction::glGetSamplerParameteriv,        0, ObjectKind::Sampler},
+    {GLFunction::glGetSamplerParameterIiv,       0, ObjectKind::Sampler},
+    {GLFunction::glGetSamplerParameterfv,        0, ObjectKind::Sampler},
+    {GLFunction::glGetSamplerParameterIuiv,      0, ObjectKind::Sampler},
+
+    {GLFunction::glClientWaitSync,               0, ObjectKind::Sync},
+    {GLFunction::glWaitSync,                     0, ObjectKind::Sync},
+    {GLFunction::glDeleteSync,                   0, ObjectKind::Sync},
+    {GLFunction::glIsSync,                       0, ObjectKind::Sync},
+    {GLFunction::glGetSynciv,                    0, ObjectKind::Sync},
+};
+
+typedef struct {
+    GLFunction::GLFunction function;
+    ObjectKind::ObjectKind kind;
+} NameArray_t;
+
+// Functions taking an array of names to generate or delete, always as the second argument
+static const NameArray_t NAME_ARRAYS[] = {
+    {GLFunction::glGenBuffers,            ObjectKind::Buffer},
+    {GLFunction::glDeleteBuffers,         ObjectKind::Buffer},
+    {GLFunction::glGenTextures,           ObjectKind::Texture},
+    {GLFunction::glDeleteTextures,        ObjectKind::Texture},
+    {GLFunction::glGenVertexArrays,       ObjectKind::VertexArray},
+    {GLFunction::glDeleteVertexArrays,    ObjectKind::VertexArray},
+    {GLFunction::glGenQueries,            ObjectKind::Query},
+    {GLFunction::glDeleteQueries,         ObjectKind::Query},
+    {GLFunction::glGenFramebuffers,       ObjectKind::Framebuffer},
+    {GLFunction::glDeleteFramebuffers,    ObjectKind::Framebuffer},
+    {GLFunction::glGenRenderbuffers,      ObjectKind::Renderbuffer},
+    {GLFunction::glDeleteRenderbuffers,   ObjectKind::Renderbuffer},
+    {GLFunction::glGenSamplers,           ObjectKind::Sampler},
+    {GLFunction::glDeleteSamplers,        ObjectKind::Sampler},
+};
+
+// Prefixes of functions that only set state, checked for repeats
+static const char* STATE_PREFIXES[] = {
+    "glBind", "glUseProgram", "glActiveTexture", "glEnable", "glDisable", "glBlend", "glDepth",
+    "glStencil", "glCullFace", "glFrontFace", "glPolygon", "glColorMask", "glViewport", "glScissor",
+    "glClearColor", "glClearDepth", "glClearStencil", "glPixelStore", "glLineWidth", "glPointSize",
+};
+
+// Lookups built from the tables above, indexed by function
+static std::vector<NameArg_t> nameArgs[GLFunction::Count];
+static ObjectKind::ObjectKind nameArrays[GLFunction::Count];
+static int uniformArgs[GLFunction::Count];
+static bool stateFunctions[GLFunction::Count];
+
+// Trace names to replay names, for each kind of object
+static std::map<uint64_t, uint64_t> names[ObjectKind::Count];
+
+// (trace program << 32 | trace location) to replay location
+static std::map<uint64_t, GLint> uniformLocations;
+static GLuint currentProgram;
+
+// Trace program named by the call being replayed, before translation
+static GLuint callProgram;
+
+// What the replay's own mappings point at, by target
+static std::map<GLenum, uint8_t*> mappings;
+
+// Where each argument of the call being replayed points
+static std::vector<uint8_t> scratch[GLTRACE_MAX_ARGS];
+static const GLchar* shaderSource;
+
+static const uint8_t* cursor;
+static const uint8_t* end;
+static bool truncated;
+
+// For finding repeated calls
+static uint64_t lastArgs[GLFunction::Count][GLTRACE_MAX_ARGS];
+static bool lastArgsValid[GLFunction::Count];
+static uint64_t repeatCounts[GLFunction::Count];
+
+static GLReplayStats_t* replayStats;
+
+static bool MoreCalls(const GLCallCount_t& a, const GLCallCount_t& b) {
+    return a.calls > b.calls;
+}
+
+static const uint8_t* Read(size_t size) {
+    if ((size_t)(end - cursor) < size) {
+        truncated = true;
+        cursor = end;
+        return NULL;
+    }
+
+    const uint8_t* data = cursor;
+    cursor += size;
+    return data;
+}
+
+template <typename T>
+static T Read() {
+    T value = T();
+    const uint8_t* data = Read(sizeof(T));
+    if (data)
+        memcpy(&value, data, sizeof(T));
+
+    return value;
+}
+
+static uint64_t TranslateName(ObjectKind::ObjectKind kind, uint64_t name) {
+    if (name == 0)
+        return 0;
+
+    auto it = names[kind].find(name);
+    return it != names[kind].end() ? it->second : name;
+}
+
+static GLint TranslateLocation(GLuint program, GLint location) {
+    if (location < 0)
+        return location;
+
+    auto it = uniformLocations.find((uint64_t)program << 32 | (uint32_t)location);
+    return it != uniformLocations.end() ? it->second : location;
+}
+
+static void CheckRepeat(const GLTraceCall_t& call) {
+    if (!stateFunctions[call.function] || call.payloadCount > 0)
+        return;
+
+    uint64_t* last = lastArgs[call.function];
+
+    if (lastArgsValid[call.function] && memcmp(last, call.args, call.argCount * sizeof(uint64_t)) == 0) {
+        ++repeatCounts[call.function];
+        ++replayStats->repeatedCalls;
+    }
+
+    memcpy(last, call.args, call.argCount * sizeof(uint64_t));
+    lastArgsValid[call.function] = true;
+}
+
+/*
+ * Reads the rest of a call whose argument types have been filled in, and points its
+ * arguments at what the replay should pass. Returns false if it can't be replayed.
+ */
+static bool ReadCall(GLTraceCall_t& call) {
+    for (int i=0; i<call.argCount; ++i) {
+        const uint8_t* data = Read(call.argSizes[i]);
+        if (data)
+            memcpy(&call.args[i], data, call.argSizes[i]);
+    }
+
+    const uint8_t* result = Read(call.resultSize);
+    if (result)
+        memcpy(&call.result, result, call.resultSize);
+
+    call.payloadCount = Read<uint8_t>();
+    for (int i=0; i<call.payloadCount; ++i) {
+        GLTracePayload_t& payload = call.payloads[i];
+        payload.arg  = Read<uint8_t>();
+        payload.size = Read<uint32_t>();
+
+        bool hasData = !(payload.arg & (GLTRACE_PAYLOAD_OUTPUT_SIZE | GLTRACE_PAYLOAD_OFFSET | GLTRACE_PAYLOAD_UNCAPTURED));
+        payload.data = hasData ? Read(payload.size) : NULL;
+    }
+
+    if (truncated)
+        return false;
+
+    CheckRepeat(call);
+
+    callProgram = (GLuint)call.args[0];
+    bool replayable = true;
+
+    for (int i=0; i<call.payloadCount; ++i) {
+        const GLTracePayload_t& payload = call.payloads[i];
+        int arg = payload.arg & GLTRACE_PAYLOAD_ARG_MASK;
+
+        if (payload.arg & GLTRACE_PAYLOAD_UNCAPTURED) {
+            replayable = false;
+        } else if (payload.arg & (GLTRACE_PAYLOAD_OUTPUT | GLTRACE_PAYLOAD_OUTPUT_SIZE)) {
+            scratch[arg].resize(std::max<size_t>(payload.size, GLREPLAY_MIN_SCRATCH));
+            call.args[arg] = ToTraceValue(&scratch[arg][0]);
+        } else if (!(payload.arg & GLTRACE_PAYLOAD_OFFSET)) {
+            call.args[arg] = ToTraceValue(payload.data);
+        }
+    }
+
+    if (!replayable)
+        return false;
+
+    if (call.function == GLFunction::glShaderSource) {
+        shaderSource = FromTraceValue<const GLchar*>(call.args[2]);
+        call.args[1] = 1;
+        call.args[2] = ToTraceValue(&shaderSource);
+        call.args[3] = 0;
+    }
+
+    // Names being deleted get translated in a copy of the array
+    ObjectKind::ObjectKind arrayKind = nameArrays[call.function];
+    if (arrayKind != ObjectKind::None && call.args[1] && call.payloadCount > 0 && !(call.payloads[0].arg & GLTRACE_PAYLOAD_OUTPUT)) {
+        GLsizei count = (GLsizei)call.args[0];
+        scratch[1].resize(count * sizeof(GLuint));
+
+        const GLuint* traceNames = (const GLuint*)call.payloads[0].data;
+        GLuint* replayNames = (GLuint*)&scratch[1][0];
+        for (GLsizei i=0; i<count; ++i)
+            replayNames[i] = (GLuint)TranslateName(arrayKind, traceNames[i]);
+
+        call.args[1] = ToTraceValue(replayNames);
+    }
+
+    const std::vector<NameArg_t>& args = nameArgs[call.function];
+    for (size_t i=0; i<args.size(); ++i)
+        call.args[args[i].arg] = TranslateName(args[i].kind, call.args[args[i].arg]);
+
+    // glUniform* take a location in the current program, glGetUniform* one in their own
+    int uniformArg = uniformArgs[call.function];
+    if (uniformArg == 0)
+        call.args[0] = (uint32_t)TranslateLocation(currentProgram, (GLint)call.args[0]);
+    else if (uniformArg == 1)
+        call.args[1] = (uint32_t)TranslateLocation(callProgram, (GLint)call.args[1]);
+
+    return true;
+}
+
+/*
+ * Matches up what the call created in the replay with what it created in the trace
+ */
+static void FinishCall(const GLTraceCall_t& call, uint64_t traceResult, uint64_t replayResult) {
+    ++replayStats->calls;
+
+    ObjectKind::ObjectKind arrayKind = nameArrays[call.function];
+    if (arrayKind != ObjectKind::None && call.payloadCount > 0 && (call.payloads[0].arg & GLTRACE_PAYLOAD_OUTPUT)) {
+        const GLuint* traceNames = (const GLuint*)call.payloads[0].data;
+        const GLuint* replayNames = FromTraceValue<const GLuint*>(call.args[1]);
+
+        for (GLsizei i=0; i<(GLsizei)call.args[0]; ++i)
+            names[arrayKind][traceNames[i]] = replayNames[i];
+    }
+
+    switch (call.function) {
+        case GLFunction::glCreateProgram: names[ObjectKind::Program][traceResult] = replayResult; break;
+        case GLFunction::glCreateShader:  names[ObjectKind::Shader][traceResult] = replayResult; break;
+        case GLFunction::glFenceSync:     names[ObjectKind::Sync][traceResult] = replayResult; break;
+
+        case GLFunction::glUseProgram:
+            currentProgram = callProgram;
+            break;
+
+        case GLFunction::glGetUniformLocation:
+            if ((GLint)traceResult >= 0) {
+                uint64_t key = (uint64_t)callProgram << 32 | (uint32_t)traceResult;
+                uniformLocations[key] = (GLint)replayResult;
+            }
+            break;
+
+        case GLFunction::glMapBufferRange:
+        case GLFunction::glMapBuffer:
+            mappings[(GLenum)call.args[0]] = FromTraceValue<uint8_t*>(replayResult);
+            break;
+
+        case GLFunction::glUnmapBuffer:
+            mappings.erase((GLenum)call.args[0]);
+            break;
+    }
+}
+
+template <typename R>
+struct ReplayInvoker {
+    template <typename Function>
+    static void Call(GLTraceCall_t& call, Function function) {
+        uint64_t traceResult = call.result;
+        R result = function();
+        FinishCall(call, traceResult, ToTraceValue(result));
+    }
+};
+
+template <>
+struct ReplayInvoker<void> {
+    template <typename Function>
+    static void Call(GLTraceCall_t& call, Function function) {
+        function();
+        FinishCall(call, 0, 0);
+    }
+};
+
+#define ARG(i, A) FromTraceValue<A>(call.args[i])
+
+/*
+ * Replayers, one per arity, that read a call of the function's type and make it
+ */
+
+template <int F, typename R>
+void Replay0(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)())originals[F])(); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R>
+void BindReplay(R (CODEGEN_FUNCPTR* function)()) { originals[F] = (GLProc)function; replayers[F] = &Replay0<F, R>; }
+
+template <int F, typename R, typename A1>
+void Replay1(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1))originals[F])(ARG(0, A1)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1)) { originals[F] = (GLProc)function; replayers[F] = &Replay1<F, R, A1>; }
+
+template <int F, typename R, typename A1, typename A2>
+void Replay2(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call); AddTraceArgType<A2>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2))originals[F])(ARG(0, A1), ARG(1, A2)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1, typename A2>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1, A2)) { originals[F] = (GLProc)function; replayers[F] = &Replay2<F, R, A1, A2>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3>
+void Replay3(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call); AddTraceArgType<A2>(call); AddTraceArgType<A3>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3))originals[F])(ARG(0, A1), ARG(1, A2), ARG(2, A3)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1, A2, A3)) { originals[F] = (GLProc)function; replayers[F] = &Replay3<F, R, A1, A2, A3>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4>
+void Replay4(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call); AddTraceArgType<A2>(call); AddTraceArgType<A3>(call); AddTraceArgType<A4>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4))originals[F])(ARG(0, A1), ARG(1, A2), ARG(2, A3), ARG(3, A4)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1, A2, A3, A4)) { originals[F] = (GLProc)function; replayers[F] = &Replay4<F, R, A1, A2, A3, A4>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5>
+void Replay5(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call); AddTraceArgType<A2>(call); AddTraceArgType<A3>(call); AddTraceArgType<A4>(call);
+    AddTraceArgType<A5>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5))originals[F])(ARG(0, A1), ARG(1, A2), ARG(2, A3), ARG(3, A4),
+            ARG(4, A5)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1, A2, A3, A4, A5)) { originals[F] = (GLProc)function; replayers[F] = &Replay5<F, R, A1, A2, A3, A4, A5>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+void Replay6(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call); AddTraceArgType<A2>(call); AddTraceArgType<A3>(call); AddTraceArgType<A4>(call);
+    AddTraceArgType<A5>(call); AddTraceArgType<A6>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6))originals[F])(ARG(0, A1), ARG(1, A2), ARG(2, A3), ARG(3, A4),
+            ARG(4, A5), ARG(5, A6)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1, A2, A3, A4, A5, A6)) { originals[F] = (GLProc)function; replayers[F] = &Replay6<F, R, A1, A2, A3, A4, A5, A6>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+void Replay7(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call); AddTraceArgType<A2>(call); AddTraceArgType<A3>(call); AddTraceArgType<A4>(call);
+    AddTraceArgType<A5>(call); AddTraceArgType<A6>(call); AddTraceArgType<A7>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6, A7))originals[F])(ARG(0, A1), ARG(1, A2), ARG(2, A3), ARG(3, A4),
+            ARG(4, A5), ARG(5, A6), ARG(6, A7)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1, A2, A3, A4, A5, A6, A7)) { originals[F] = (GLProc)function; replayers[F] = &Replay7<F, R, A1, A2, A3, A4, A5, A6, A7>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+void Replay8(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call); AddTraceArgType<A2>(call); AddTraceArgType<A3>(call); AddTraceArgType<A4>(call);
+    AddTraceArgType<A5>(call); AddTraceArgType<A6>(call); AddTraceArgType<A7>(call); AddTraceArgType<A8>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6, A7, A8))originals[F])(ARG(0, A1), ARG(1, A2), ARG(2, A3), ARG(3, A4),
+            ARG(4, A5), ARG(5, A6), ARG(6, A7), ARG(7, A8)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1, A2, A3, A4, A5, A6, A7, A8)) { originals[F] = (GLProc)function; replayers[F] = &Replay8<F, R, A1, A2, A3, A4, A5, A6, A7, A8>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+void Replay9(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call); AddTraceArgType<A2>(call); AddTraceArgType<A3>(call); AddTraceArgType<A4>(call);
+    AddTraceArgType<A5>(call); AddTraceArgType<A6>(call); AddTraceArgType<A7>(call); AddTraceArgType<A8>(call);
+    AddTraceArgType<A9>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6, A7, A8, A9))originals[F])(ARG(0, A1), ARG(1, A2), ARG(2, A3), ARG(3, A4),
+            ARG(4, A5), ARG(5, A6), ARG(6, A7), ARG(7, A8), ARG(8, A9)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1, A2, A3, A4, A5, A6, A7, A8, A9)) { originals[F] = (GLProc)function; replayers[F] = &Replay9<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+void Replay10(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call); AddTraceArgType<A2>(call); AddTraceArgType<A3>(call); AddTraceArgType<A4>(call);
+    AddTraceArgType<A5>(call); AddTraceArgType<A6>(call); AddTraceArgType<A7>(call); AddTraceArgType<A8>(call);
+    AddTraceArgType<A9>(call); AddTraceArgType<A10>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10))originals[F])(ARG(0, A1), ARG(1, A2), ARG(2, A3), ARG(3, A4),
+            ARG(4, A5), ARG(5, A6), ARG(6, A7), ARG(7, A8), ARG(8, A9), ARG(9, A10)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10)) { originals[F] = (GLProc)function; replayers[F] = &Replay10<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+void Replay11(GLTraceCall_t& call) {
+    StartTraceCall(call, F, GLTraceResult<R>::size);
+    AddTraceArgType<A1>(call); AddTraceArgType<A2>(call); AddTraceArgType<A3>(call); AddTraceArgType<A4>(call);
+    AddTraceArgType<A5>(call); AddTraceArgType<A6>(call); AddTraceArgType<A7>(call); AddTraceArgType<A8>(call);
+    AddTraceArgType<A9>(call); AddTraceArgType<A10>(call); AddTraceArgType<A11>(call);
+    if (ReadCall(call))
+        ReplayInvoker<R>::Call(call, [&]() -> R { return ((R (CODEGEN_FUNCPTR*)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11))originals[F])(ARG(0, A1), ARG(1, A2), ARG(2, A3), ARG(3, A4),
+            ARG(4, A5), ARG(5, A6), ARG(6, A7), ARG(7, A8), ARG(8, A9), ARG(9, A10), ARG(10, A11)); });
+    else
+        ++replayStats->skippedCalls;
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+void BindReplay(R (CODEGEN_FUNCPTR* function)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11)) { originals[F] = (GLProc)function; replayers[F] = &Replay11<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11>; }
+
+static void Reset() {
+    #define GL_FUNCTION(name) BindReplay<GLFunction::name>(_ptrc_##name);
+    #include "GLFunctionList.h"
+    #undef GL_FUNCTION
+
+    for (int i=0; i<GLFunction::Count; ++i) {
+        nameArgs[i].clear();
+        nameArrays[i] = ObjectKind::None;
+        uniformArgs[i] = -1;
+        stateFunctions[i] = false;
+
+        const char* name = GLFunction::GetName((GLFunction::GLFunction)i);
+
+        if (strncmp(name, "glUniform", 9) == 0 && i != GLFunction::glUniformBlockBinding)
+            uniformArgs[i] = 0;
+        else if (i == GLFunction::glGetUniformfv || i == GLFunction::glGetUniformiv || i == GLFunction::glGetUniformuiv)
+            uniformArgs[i] = 1;
+
+        for (size_t j=0; j<sizeof(STATE_PREFIXES)/sizeof(STATE_PREFIXES[0]); ++j)
+            if (strncmp(name, STATE_PREFIXES[j], strlen(STATE_PREFIXES[j])) == 0)
+                stateFunctions[i] = true;
+    }
+
+    for (size_t i=0; i<sizeof(NAME_ARGS)/sizeof(NAME_ARGS[0]); ++i)
+        nameArgs[NAME_ARGS[i].function].push_back(NAME_ARGS[i]);
+
+    for (size_t i=0; i<sizeof(NAME_ARRAYS)/sizeof(NAME_ARRAYS[0]); ++i)
+        nameArrays[NAME_ARRAYS[i].function] = NAME_ARRAYS[i].kind;
+
+    for (int i=0; i<ObjectKind::Count; ++i)
+        names[i].clear();
+
+    uniformLocations.clear();
+    currentProgram = 0;
+    mappings.clear();
+
+    memset(lastArgsValid, 0, sizeof(lastArgsValid));
+    memset(repeatCounts, 0, sizeof(repeatCounts));
+
+    truncated = false;
+}
+
+bool GLReplay::Run(const char* filename, bool paced, FrameCallback onFrame, GLReplayStats_t& stats) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s\n", filename);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    std::vector<uint8_t> trace(length > 0 ? length : 1);
+    size_t read = fread(&trace[0], 1, length, file);
+    fclose(file);
+
+    if (read != (size_t)length) {
+        fprintf(stderr, "Failed to read %s\n", filename);
+        return false;
+    }
+
+    Reset();
+
+    memset(&stats, 0, sizeof(stats));
+    replayStats = &stats;
+
+    cursor = &trace[0];
+    end = cursor + read;
+
+    GLTraceHeader_t header = Read<GLTraceHeader_t>();
+    if (truncated || header.magic != GLTRACE_MAGIC || header.version != GLTRACE_VERSION) {
+        fprintf(stderr, "%s isn't a GL trace\n", filename);
+        return false;
+    }
+
+    // Buffer offsets are stored as pointers
+    if (header.pointerSize != sizeof(void*)) {
+        fprintf(stderr, "%s was captured by a %u-bit build\n", filename, header.pointerSize * 8);
+        return false;
+    }
+
+    // The trace names its functions, in case they've moved around since
+    std::vector<GLFunction::GLFunction> functions(header.functionCount);
+    for (uint32_t i=0; i<header.functionCount; ++i) {
+        uint8_t nameLength = Read<uint8_t>();
+        const uint8_t* name = Read(nameLength);
+        if (!name)
+            break;
+
+        functions[i] = GLFunction::Find(std::string((const char*)name, nameLength).c_str());
+    }
+
+    uint64_t replayStart = Clock::Now();
+    uint64_t frameStart = replayStart;
+
+    while (cursor < end && !truncated) {
+        uint16_t index = Read<uint16_t>();
+
+        if (index == GLTRACE_FRAME_MARKER) {
+            uint64_t captureTime = Read<uint64_t>();
+
+            if (paced) {
+                uint64_t now = Clock::Now();
+                if (replayStart + captureTime > now)
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(replayStart + captureTime - now));
+            }
+
+            if (onFrame)
+                onFrame();
+
+            uint64_t frameEnd = Clock::Now();
+            uint64_t frameTime = frameEnd - frameStart;
+
+            stats.minFrameTime = stats.frames == 0 ? frameTime : std::min(stats.minFrameTime, frameTime);
+            stats.maxFrameTime = std::max(stats.maxFrameTime, frameTime);
+            ++stats.frames;
+
+            frameStart = frameEnd;
+        } else if (index == GLTRACE_BUFFER_WRITE) {
+            GLenum target   = Read<uint32_t>();
+            uint64_t offset = Read<uint64_t>();
+            uint32_t size   = Read<uint32_t>();
+            const uint8_t* data = Read(size);
+
+            auto it = mappings.find(target);
+            if (data && it != mappings.end() && it->second)
+                memcpy(it->second + offset, data, size);
+        } else {
+            if (index >= functions.size() || functions[index] == GLFunction::Count) {
+                fprintf(stderr, "%s calls a function we don't have\n", filename);
+                return false;
+            }
+
+            GLTraceCall_t call;
+            replayers[functions[index]](call);
+        }
+    }
+
+    stats.totalTime = Clock::Now() - replayStart;
+
+    if (truncated)
+        fprintf(stderr, "%s ends partway through a call\n", filename);
+
+    return true;
+}
+
+void GLReplay::GetRepeatedCalls(std::vector<GLCallCount_t>& counts) {
+    counts.clear();
+
+    for (int i=0; i<GLFunction::Count; ++i) {
+        if (repeatCounts[i] > 0) {
+            GLCallCount_t count = {GLFunction::GetName((GLFunction::GLFunction)i), repeatCounts[i]};
+            counts.push_back(count);
+        }
+    }
+
+    std::stable_sort(counts.begin(), counts.end(), MoreCalls);
+}
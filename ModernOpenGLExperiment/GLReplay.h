@@ -0,0 +1,61 @@
+#ifndef GLREPLAY_H
+#define GLREPLAY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Rendering.h"
+#include "GLFunctions.h"
+
+/**
+ * GLReplayStats_t - How a replay went. Times are in nanoseconds.
+ */
+typedef struct {
+    uint64_t frames;
+    uint64_t calls;
+
+    // Calls left out because the trace is missing data they need
+    uint64_t skippedCalls;
+
+    // State changes that repeat the previous call to the same function, see GetRepeatedCalls
+    uint64_t repeatedCalls;
+
+    uint64_t totalTime;
+    uint64_t minFrameTime;
+    uint64_t maxFrameTime;
+} GLReplayStats_t;
+
+/**
+ * GLReplay
+ * Plays back a trace written by GLCapture through whichever functions are loaded, so the
+ * same frames can be rerun against a driver (or NullGL) as many times as needed.
+ *
+ * Objects the trace creates get whatever names the replaying driver hands out, and the
+ * trace's names, uniform locations and sync objects are translated as calls come by.
+ */
+class GLReplay {
+private:
+    GLReplay() {}
+
+public:
+    typedef void (*FrameCallback)();
+
+    /**
+     * Run
+     * Replays the whole trace in filename, calling onFrame (e.g. to swap buffers) at the
+     * end of every captured frame. When paced, frames are held back to the timing they
+     * were captured with, otherwise they go as fast as they can.
+     */
+    static bool Run(const char* filename, bool paced, FrameCallback onFrame, GLReplayStats_t& stats);
+
+    /**
+     * GetRepeatedCalls
+     * Fills counts with how often each state setting function (binds, enables, blend and
+     * depth state...) was called with the same arguments as its previous call, most
+     * first. These are likely candidates for redundant calls, though not all of them are:
+     * e.g. binding the same element array buffer into two different vertex arrays.
+     */
+    static void GetRepeatedCalls(std::vector<GLCallCount_t>& counts);
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include "GLState.h"
+
+#include <cstdio>
+#include <cstring>
+
+// A fresh context starts out with everything bound to 0
+GLuint GLState::program = 0;
+GLuint GLState::activeTexture = 0;
+GLuint GLState::textures[GLSTATE_MAX_TEXTURE_UNITS] = {0};
+GLuint GLState::vertexArray = 0;
+GLuint GLState::arrayBuffer = 0;
+GLuint GLState::elementArrayBuffer = 0;
+UniformRange_t GLState::uniformBindings[GLSTATE_MAX_UNIFORM_BINDINGS] = {{0}};
+
+#ifdef _DEBUG
+bool GLState::validate = true;
+#else
+bool GLState::validate = false;
+#endif
+
+GLStateStats_t GLState::frameStats = {0};
+GLStateStats_t GLState::lastFrameStats = {0};
+
+void GLState::UseProgram(GLuint newProgram) {
+    if (program == newProgram) {
+        ++frameStats.programFiltered;
+    } else {
+        glUseProgram(newProgram);
+        program = newProgram;
+        ++frameStats.programChanges;
+    }
+
+    if (validate) Validate("UseProgram");
+}
+
+bool GLState::SetActiveTexture(GLuint unit) {
+    assert(unit < GLSTATE_MAX_TEXTURE_UNITS);
+
+    if (activeTexture == unit)
+        return false;
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    activeTexture = unit;
+    ++frameStats.activeTextureChanges;
+
+    return true;
+}
+
+void GLState::ActiveTexture(GLuint unit) {
+    if (!SetActiveTexture(unit))
+        ++frameStats.activeTextureFiltered;
+
+    if (validate) Validate("ActiveTexture");
+}
+
+void GLState::BindTexture(GLuint texture) {
+    // If we lost track of the active unit, assume the first
+    BindTexture(activeTexture == UNKNOWN ? 0 : activeTexture, texture);
+}
+
+void GLState::BindTexture(GLuint unit, GLuint texture) {
+    assert(unit < GLSTATE_MAX_TEXTURE_UNITS);
+
+    if (textures[unit] == texture) {
+        ++frameStats.textureFiltered;
+    } else {
+        SetActiveTexture(unit);
+
+        glBindTexture(GL_TEXTURE_2D, texture);
+        textures[unit] = texture;
+        ++frameStats.textureChanges;
+    }
+
+    if (validate) Validate("BindTexture");
+}
+
+void GLState::BindVertexArray(GLuint newVertexArray) {
+    if (vertexArray == newVertexArray) {
+        ++frameStats.vertexArrayFiltered;
+    } else {
+        glBindVertexArray(newVertexArray);
+        vertexArray = newVertexArray;
+        ++frameStats.vertexArrayChanges;
+
+        // Element array binding comes along with the vertex array
+        elementArrayBuffer = UNKNOWN;
+    }
+
+    if (validate) Validate("BindVertexArray");
+}
+
+GLuint* GLState::GetBufferBinding(GLenum target) {
+    switch (target) {
+        case GL_ARRAY_BUFFER:         return &arrayBuffer;
+        case GL_ELEMENT_ARRAY_BUFFER: return &elementArrayBuffer;
+        default:                      return NULL;
+    }
+}
+
+void GLState::BindBuffer(GLenum target, GLuint buffer) {
+    GLuint* binding = GetBufferBinding(target);
+
+    if (binding != NULL && *binding == buffer) {
+        ++frameStats.bufferFiltered;
+    } else {
+        glBindBuffer(target, buffer);
+        if (binding != NULL)
+            *binding = buffer;
+
+        ++frameStats.bufferChanges;
+    }
+
+    if (validate) Validate("BindBuffer");
+}
+
+void GLState::BindUniformRange(GLuint binding, const UniformRange_t& range) {
+    assert(binding < GLSTATE_MAX_UNIFORM_BINDINGS);
+
+    UniformRange_t& current = uniformBindings[binding];
+
+    if (current.buffer == range.buffer &&
+        current.offset == range.offset &&
+        current.size   == range.size) {
+
+        ++frameStats.bufferFiltered;
+    } else {
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, range.buffer, range.offset, range.size);
+        current = range;
+        ++frameStats.bufferChanges;
+    }
+
+    if (validate) Validate("BindUniformRange");
+}
+
+void GLState::ForgetProgram(GLuint deleted) {
+    if (program == deleted)
+        program = 0;
+}
+
+void GLState::ForgetTexture(GLuint deleted) {
+    for (GLuint i=0; i<GLSTATE_MAX_TEXTURE_UNITS; ++i)
+        if (textures[i] == deleted)
+            textures[i] = 0;
+}
+
+void GLState::ForgetVertexArray(GLuint deleted) {
+    if (vertexArray == deleted) {
+        vertexArray = 0;
+        elementArrayBuffer = UNKNOWN;
+    }
+}
+
+void GLState::ForgetBuffer(GLuint deleted) {
+    if (arrayBuffer == deleted)
+        arrayBuffer = 0;
+
+    // Only unbound from the current vertex array, but
+    // that's the only one we keep track of anyway
+    if (elementArrayBuffer == deleted)
+        elementArrayBuffer = 0;
+
+    for (GLuint i=0; i<GLSTATE_MAX_UNIFORM_BINDINGS; ++i)
+        if (uniformBindings[i].buffer == deleted)
+            uniformBindings[i].buffer = 0;
+}
+
+void GLState::Invalidate() {
+    program = UNKNOWN;
+    activeTexture = UNKNOWN;
+    for (GLuint i=0; i<GLSTATE_MAX_TEXTURE_UNITS; ++i)
+        textures[i] = UNKNOWN;
+
+    vertexArray = UNKNOWN;
+    arrayBuffer = UNKNOWN;
+    elementArrayBuffer = UNKNOWN;
+
+    for (GLuint i=0; i<GLSTATE_MAX_UNIFORM_BINDINGS; ++i)
+        uniformBindings[i].buffer = UNKNOWN;
+}
+
+void GLState::BeginFrame() {
+    lastFrameStats = frameStats;
+    memset(&frameStats, 0, sizeof(frameStats));
+}
+
+void GLState::CheckBinding(const char* call, const char* name, GLenum query, GLuint expected) {
+    if (expected == UNKNOWN)
+        return;
+
+    GLint actual;
+    glGetIntegerv(query, &actual);
+
+    if ((GLuint)actual != expected) {
+        fprintf(stderr, "GLState: after %s, %s is %d but the shadow state has %u\n",
+            call, name, actual, expected);
+    }
+}
+
+void GLState::Validate(const char* call) {
+    CheckBinding(call, "GL_CURRENT_PROGRAM",      GL_CURRENT_PROGRAM,      program);
+    CheckBinding(call, "GL_VERTEX_ARRAY_BINDING", GL_VERTEX_ARRAY_BINDING, vertexArray);
+    CheckBinding(call, "GL_ARRAY_BUFFER_BINDING", GL_ARRAY_BUFFER_BINDING, arrayBuffer);
+    CheckBinding(call, "GL_ELEMENT_ARRAY_BUFFER_BINDING", GL_ELEMENT_ARRAY_BUFFER_BINDING, elementArrayBuffer);
+
+    for (GLuint i=0; i<GLSTATE_MAX_UNIFORM_BINDINGS; ++i) {
+        const UniformRange_t& range = uniformBindings[i];
+        if (range.buffer == UNKNOWN || range.buffer == 0)
+            continue;
+
+        GLint buffer, offset;
+        glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, i, &buffer);
+        glGetIntegeri_v(GL_UNIFORM_BUFFER_START,   i, &offset);
+
+        if ((GLuint)buffer != range.buffer || offset != range.offset) {
+            fprintf(stderr, "GLState: after %s, uniform binding %u is buffer %d at %d but the shadow state has %u at %d\n",
+                call, i, buffer, offset, range.buffer, (int)range.offset);
+        }
+    }
+
+    if (activeTexture == UNKNOWN)
+        return;
+
+    CheckBinding(call, "GL_ACTIVE_TEXTURE", GL_ACTIVE_TEXTURE, GL_TEXTURE0 + activeTexture);
+    CheckBinding(call, "GL_TEXTURE_BINDING_2D", GL_TEXTURE_BINDING_2D, textures[activeTexture]);
+}
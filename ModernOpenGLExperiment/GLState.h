@@ -0,0 +1,145 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include <cstdint>
+
+#include "Rendering.h"
+
+#define GLSTATE_MAX_TEXTURE_UNITS 16
+#define GLSTATE_MAX_UNIFORM_BINDINGS 16
+
+/**
+ * GLStateStats_t - Per-frame counters of state calls that went through GLState.
+ * "Changes" made it to the driver, "filtered" were dropped because the shadow
+ * state showed they wouldn't have changed anything.
+ */
+typedef struct {
+    uint32_t programChanges;
+    uint32_t programFiltered;
+
+    uint32_t activeTextureChanges;
+    uint32_t activeTextureFiltered;
+
+    uint32_t textureChanges;
+    uint32_t textureFiltered;
+
+    uint32_t vertexArrayChanges;
+    uint32_t vertexArrayFiltered;
+
+    uint32_t bufferChanges;
+    uint32_t bufferFiltered;
+
+    uint32_t uniformChanges;
+    uint32_t uniformFiltered;
+} GLStateStats_t;
+
+/**
+ * GLState
+ * Shadow copy of the bits of OpenGL binding state that our wrappers touch. Program,
+ * Texture and Mesh route their binds through here, and anything that wouldn't change
+ * the current binding never reaches the driver.
+ *
+ * This only works as long as nobody calls the underlying gl functions directly - if
+ * something has to, call Invalidate() afterwards so that the next bind of each kind
+ * goes through unconditionally.
+ *
+ * The element array binding is part of the vertex array object, so it is forgotten
+ * whenever the bound vertex array changes.
+ *
+ * With validation turned on (the default in debug builds), each call checks the
+ * shadow state against glGet queries and reports any mismatch. This is slow, since
+ * every query stalls the pipeline.
+ */
+class GLState {
+private:
+    // Sentinel for bindings whose actual value we don't know
+    static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+    static GLuint program;
+    static GLuint activeTexture;
+    static GLuint textures[GLSTATE_MAX_TEXTURE_UNITS];
+    static GLuint vertexArray;
+    static GLuint arrayBuffer;
+    static GLuint elementArrayBuffer;
+    static UniformRange_t uniformBindings[GLSTATE_MAX_UNIFORM_BINDINGS];
+
+    static bool validate;
+
+    static GLStateStats_t frameStats;
+    static GLStateStats_t lastFrameStats;
+
+    static GLuint* GetBufferBinding(GLenum target);
+
+    // Changes the active texture unit if needed, returning whether it did
+    static bool SetActiveTexture(GLuint unit);
+
+    static void Validate(const char* call);
+    static void CheckBinding(const char* call, const char* name, GLenum query, GLuint expected);
+
+    GLState() {}
+
+public:
+    static void UseProgram(GLuint program);
+
+    static void ActiveTexture(GLuint unit);
+
+    /**
+     * BindTexture
+     * Binds a 2D texture to the given texture unit, changing the active unit only if
+     * the binding itself needs to change
+     */
+    static void BindTexture(GLuint unit, GLuint texture);
+
+    /**
+     * BindTexture
+     * Binds a 2D texture to the currently active texture unit
+     */
+    static void BindTexture(GLuint texture);
+
+    static void BindVertexArray(GLuint vertexArray);
+    static void BindBuffer(GLenum target, GLuint buffer);
+
+    /**
+     * BindUniformRange
+     * Binds a range of a uniform buffer to one of the indexed uniform block binding points
+     */
+    static void BindUniformRange(GLuint binding, const UniformRange_t& range);
+
+    /**
+     * CountUniform
+     * Uniform values are shadowed per program by Program::SetUniform, which
+     * reports here whether each call changed anything
+     */
+    static void CountUniform(bool changed) {
+        if (changed)
+            ++frameStats.uniformChanges;
+        else
+            ++frameStats.uniformFiltered;
+    }
+
+    // Deleting a bound object resets its binding to 0; call these
+    // right before deleting an object so the shadow state follows suit
+    static void ForgetProgram(GLuint program);
+    static void ForgetTexture(GLuint texture);
+    static void ForgetVertexArray(GLuint vertexArray);
+    static void ForgetBuffer(GLuint buffer);
+
+    /**
+     * Invalidate
+     * Forgets all shadowed state, e.g. after calling into GL behind our back
+     */
+    static void Invalidate();
+
+    /**
+     * BeginFrame
+     * Resets the per-frame counters, keeping the previous frame's around
+     */
+    static void BeginFrame();
+
+    static const GLStateStats_t& GetFrameStats() { return lastFrameStats; }
+
+    static void SetValidation(bool enabled) { validate = enabled; }
+    static bool IsValidating() { return validate; }
+};
+
+#endif
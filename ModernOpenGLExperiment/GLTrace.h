@@ -0,0 +1,138 @@
+#ifndef GLTRACE_H
+#define GLTRACE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Rendering.h"
+
+/*
+ * GL trace file format, written by GLCapture and read by GLReplay. Everything is
+ * little-endian and packed.
+ *
+ * Header:
+ *   uint32 magic, uint32 version, uint32 pointer size, uint32 function count
+ *   function count names, each a uint8 length followed by the characters
+ *
+ * Then records, each starting with a uint16 function index into the header's names:
+ *   each argument, taking up sizeof its type
+ *   the return value, if the function has one
+ *   uint8 payload count, then for each: uint8 argument | flags, uint32 size, size bytes
+ *
+ * Every non-null pointer argument has a payload, so replay knows what to pass for it.
+ *
+ * Two indices past any function are reserved for other kinds of record:
+ *   GLTRACE_FRAME_MARKER  uint64 nanoseconds since the capture started
+ *   GLTRACE_BUFFER_WRITE  uint32 target, uint64 offset into the mapping, uint32 size, size bytes
+ */
+
+#define GLTRACE_MAGIC   0x52544C47 // "GLTR"
+#define GLTRACE_VERSION 1
+
+#define GLTRACE_FRAME_MARKER 0xFFFF
+#define GLTRACE_BUFFER_WRITE 0xFFFE
+
+// Most arguments any entry point takes
+#define GLTRACE_MAX_ARGS 11
+
+// Payload flags, or'd into the argument index
+#define GLTRACE_PAYLOAD_ARG_MASK    0x0F
+#define GLTRACE_PAYLOAD_OUTPUT      0x80 // Data the call wrote out, e.g. generated names
+#define GLTRACE_PAYLOAD_OUTPUT_SIZE 0x40 // Only the size of what the call will write out
+#define GLTRACE_PAYLOAD_UNCAPTURED  0x20 // Input we couldn't size, so the call can't be replayed
+#define GLTRACE_PAYLOAD_OFFSET      0x10 // Not a pointer but an offset into a bound buffer
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t pointerSize;
+    uint32_t functionCount;
+} GLTraceHeader_t;
+
+/**
+ * GLTraceArg - What kind of argument a parameter type is. Const pointers are inputs,
+ * other pointers are outputs, except for sync objects, which are handles. Single
+ * strings are inputs we can always size ourselves.
+ */
+template <typename T> struct GLTraceArg               { enum { isInput = 0, isOutput = 0, isString = 0 }; };
+template <typename T> struct GLTraceArg<T*>           { enum { isInput = 0, isOutput = 1, isString = 0 }; };
+template <typename T> struct GLTraceArg<const T*>     { enum { isInput = 1, isOutput = 0, isString = 0 }; };
+template <>           struct GLTraceArg<GLsync>       { enum { isInput = 0, isOutput = 0, isString = 0 }; };
+template <>           struct GLTraceArg<const GLchar*> { enum { isInput = 1, isOutput = 0, isString = 1 }; };
+
+// Arguments and return values are kept as the raw bits of their value
+template <typename T>
+inline uint64_t ToTraceValue(T value) {
+    uint64_t raw = 0;
+    memcpy(&raw, &value, sizeof(T));
+    return raw;
+}
+
+template <typename T>
+inline T FromTraceValue(uint64_t raw) {
+    T value;
+    memcpy(&value, &raw, sizeof(T));
+    return value;
+}
+
+/**
+ * GLTracePayload_t - Data behind one pointer argument of a call
+ */
+typedef struct {
+    uint8_t arg; // Argument index and GLTRACE_PAYLOAD_ flags
+    uint32_t size;
+    const void* data; // NULL for output sizes and uncaptured input
+} GLTracePayload_t;
+
+/**
+ * GLTraceCall_t - One call on its way into or out of a trace
+ */
+typedef struct {
+    uint16_t function; // GLFunction::GLFunction
+
+    uint8_t argCount;
+    uint64_t args[GLTRACE_MAX_ARGS];
+    uint8_t argSizes[GLTRACE_MAX_ARGS];
+    uint8_t argInput[GLTRACE_MAX_ARGS];
+    uint8_t argOutput[GLTRACE_MAX_ARGS];
+    uint8_t argString[GLTRACE_MAX_ARGS];
+
+    uint64_t result;
+    uint8_t resultSize;
+
+    uint8_t payloadCount;
+    GLTracePayload_t payloads[GLTRACE_MAX_ARGS];
+} GLTraceCall_t;
+
+inline void StartTraceCall(GLTraceCall_t& call, int function, uint8_t resultSize) {
+    call.function = (uint16_t)function;
+    call.argCount = 0;
+    call.result = 0;
+    call.resultSize = resultSize;
+    call.payloadCount = 0;
+}
+
+template <typename T>
+inline void AddTraceArg(GLTraceCall_t& call, T value) {
+    uint8_t i = call.argCount++;
+    call.args[i]      = ToTraceValue(value);
+    call.argSizes[i]  = sizeof(T);
+    call.argInput[i]  = GLTraceArg<T>::isInput;
+    call.argOutput[i] = GLTraceArg<T>::isOutput;
+    call.argString[i] = GLTraceArg<T>::isString;
+}
+
+// Declares the argument types without values, for reading a call back in
+template <typename T>
+inline void AddTraceArgType(GLTraceCall_t& call) {
+    AddTraceArg(call, T());
+}
+
+/**
+ * GLTraceResult - Size a return type takes up in a record
+ */
+template <typename R> struct GLTraceResult { enum { size = sizeof(R) }; };
+template <>           struct GLTraceResult<void> { enum { size = 0 }; };
+
+#endif
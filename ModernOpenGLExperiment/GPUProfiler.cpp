@@ -0,0 +1,145 @@
+#include "GPUProfiler.h"
+#include "Clock.h"
+
+#include <cstdio>
+
+std::vector<GLuint> GPUProfiler::queryPool;
+std::vector<GPUProfiler::PendingScope_t> GPUProfiler::pending[FRAMES_IN_FLIGHT];
+std::vector<size_t> GPUProfiler::openScopes;
+
+std::map<const char*, GPUScopeStats_t, GPUProfiler::NameLess> GPUProfiler::stats;
+uint32_t GPUProfiler::droppedScopes = 0;
+
+uint64_t GPUProfiler::dumpInterval = 0;
+uint64_t GPUProfiler::lastDump = 0;
+
+GLuint GPUProfiler::AcquireQuery() {
+    GLuint query;
+
+    if (queryPool.empty()) {
+        glGenQueries(1, &query);
+    } else {
+        query = queryPool.back();
+        queryPool.pop_back();
+    }
+
+    return query;
+}
+
+void GPUProfiler::Collect(GLuint frameIndex) {
+    std::vector<PendingScope_t>& scopes = pending[frameIndex];
+
+    for (size_t i=0; i<scopes.size(); ++i) {
+        const PendingScope_t& scope = scopes[i];
+
+        // Only possible if the scope was never ended, or FrameSync wasn't waited on
+        GLint available = GL_FALSE;
+        if (scope.end != 0)
+            glGetQueryObjectiv(scope.end, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (available) {
+            GLuint64 begin, end;
+            glGetQueryObjectui64v(scope.begin, GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(scope.end,   GL_QUERY_RESULT, &end);
+
+            uint64_t elapsed = end - begin;
+
+            GPUScopeStats_t& scopeStats = stats[scope.name];
+            if (scopeStats.count == 0 || elapsed < scopeStats.minTime)
+                scopeStats.minTime = elapsed;
+            if (elapsed > scopeStats.maxTime)
+                scopeStats.maxTime = elapsed;
+
+            scopeStats.totalTime += elapsed;
+            ++scopeStats.count;
+        } else {
+            ++droppedScopes;
+        }
+
+        queryPool.push_back(scope.begin);
+        if (scope.end != 0)
+            queryPool.push_back(scope.end);
+    }
+
+    scopes.clear();
+}
+
+void GPUProfiler::BeginFrame() {
+    assert(openScopes.empty());
+
+    Collect(FrameSync::GetFrameIndex());
+
+    if (dumpInterval > 0 && Clock::Now() - lastDump >= dumpInterval)
+        Dump();
+}
+
+void GPUProfiler::BeginScope(const char* name) {
+    PendingScope_t scope = {name, AcquireQuery(), 0};
+    glQueryCounter(scope.begin, GL_TIMESTAMP);
+
+    std::vector<PendingScope_t>& scopes = pending[FrameSync::GetFrameIndex()];
+    openScopes.push_back(scopes.size());
+    scopes.push_back(scope);
+}
+
+void GPUProfiler::EndScope() {
+    assert(!openScopes.empty());
+
+    PendingScope_t& scope = pending[FrameSync::GetFrameIndex()][openScopes.back()];
+    openScopes.pop_back();
+
+    scope.end = AcquireQuery();
+    glQueryCounter(scope.end, GL_TIMESTAMP);
+}
+
+const GPUScopeStats_t* GPUProfiler::GetScopeStats(const char* name) {
+    std::map<const char*, GPUScopeStats_t, NameLess>::const_iterator it = stats.find(name);
+    return it != stats.end() ? &it->second : NULL;
+}
+
+void GPUProfiler::Dump() {
+    lastDump = Clock::Now();
+
+    if (stats.empty())
+        return;
+
+    printf("GPU time per scope:            count     min(ms)     avg(ms)     max(ms)\n");
+
+    for (auto it=stats.begin(); it!=stats.end(); ++it) {
+        const GPUScopeStats_t& scopeStats = it->second;
+
+        printf("  %-28s %6u  %10.3f  %10.3f  %10.3f\n", it->first, scopeStats.count,
+            Clock::ToMilliseconds(scopeStats.minTime),
+            Clock::ToMilliseconds(scopeStats.totalTime) / scopeStats.count,
+            Clock::ToMilliseconds(scopeStats.maxTime));
+    }
+
+    if (droppedScopes > 0)
+        printf("  (%u scopes had no results)\n", droppedScopes);
+
+    stats.clear();
+    droppedScopes = 0;
+}
+
+void GPUProfiler::SetDumpInterval(double seconds) {
+    dumpInterval = Clock::FromSeconds(seconds);
+    lastDump = Clock::Now();
+}
+
+void GPUProfiler::Shutdown() {
+    for (GLuint i=0; i<FRAMES_IN_FLIGHT; ++i) {
+        for (size_t j=0; j<pending[i].size(); ++j) {
+            queryPool.push_back(pending[i][j].begin);
+            if (pending[i][j].end != 0)
+                queryPool.push_back(pending[i][j].end);
+        }
+
+        pending[i].clear();
+    }
+
+    if (!queryPool.empty())
+        glDeleteQueries((GLsizei)queryPool.size(), &queryPool[0]);
+
+    queryPool.clear();
+    openScopes.clear();
+}
@@ -0,0 +1,108 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "Rendering.h"
+#include "FrameSync.h"
+
+/**
+ * GPUScopeStats_t - GPU time taken by every run of a named scope since the
+ * last reset, in ns
+ */
+typedef struct {
+    uint32_t count;
+    uint64_t minTime;
+    uint64_t maxTime;
+    uint64_t totalTime;
+} GPUScopeStats_t;
+
+/**
+ * GPUProfiler
+ * Measures how long named scopes of GL commands take on the GPU, by writing a
+ * GL_TIMESTAMP query at the start and end of each. Scopes can nest.
+ *
+ * Results aren't read until the scope's frame slot comes back around, FRAMES_IN_FLIGHT
+ * frames later. By then FrameSync has already waited for that frame to finish, so
+ * reading them never stalls. Query objects are recycled through a pool, so after the
+ * first few frames no new ones get created.
+ *
+ * Scope names are compared by content, but only the pointer is kept, so they have to
+ * outlive the profiler (string literals are ideal).
+ */
+class GPUProfiler {
+private:
+    typedef struct {
+        const char* name;
+        GLuint begin;
+        GLuint end;
+    } PendingScope_t;
+
+    struct NameLess {
+        bool operator()(const char* a, const char* b) const { return strcmp(a, b) < 0; }
+    };
+
+    static std::vector<GLuint> queryPool;
+
+    // Scopes issued in each frame slot, waiting on their results
+    static std::vector<PendingScope_t> pending[FRAMES_IN_FLIGHT];
+
+    // Indices into the current frame's pending scopes that haven't ended yet
+    static std::vector<size_t> openScopes;
+
+    static std::map<const char*, GPUScopeStats_t, NameLess> stats;
+    static uint32_t droppedScopes;
+
+    static uint64_t dumpInterval;
+    static uint64_t lastDump;
+
+    static GLuint AcquireQuery();
+    static void Collect(GLuint frameIndex);
+
+    GPUProfiler() {}
+
+public:
+    /**
+     * BeginFrame
+     * Collects the results of the scopes last issued in this frame slot. Must come
+     * after FrameSync::BeginFrame.
+     */
+    static void BeginFrame();
+
+    static void BeginScope(const char* name);
+    static void EndScope();
+
+    /**
+     * GetScopeStats
+     * Returns the stats for the named scope, or NULL if it hasn't been measured
+     */
+    static const GPUScopeStats_t* GetScopeStats(const char* name);
+
+    /**
+     * Dump
+     * Prints min/avg/max for every scope, then starts counting afresh
+     */
+    static void Dump();
+
+    /**
+     * SetDumpInterval
+     * Dumps every so many seconds from BeginFrame; 0 turns periodic dumps off
+     */
+    static void SetDumpInterval(double seconds);
+
+    static void Shutdown();
+};
+
+/**
+ * GPUScope - Profiles the GL commands issued during its lifetime
+ */
+class GPUScope {
+public:
+    GPUScope(const char* name) { GPUProfiler::BeginScope(name); }
+    ~GPUScope() { GPUProfiler::EndScope(); }
+};
+
+#endif
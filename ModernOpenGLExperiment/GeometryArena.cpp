@@ -0,0 +1,284 @@
+#include "GeometryArena.h"
+
+#include <algorithm>
+
+static GLsizei GetIndexTypeSize(IndexType::IndexType format) {
+    switch (format) {
+        case IndexType::UnsignedByteIndex:  return sizeof(GLubyte);
+        case IndexType::UnsignedShortIndex: return sizeof(GLushort);
+        default:                            return sizeof(GLuint);
+    }
+}
+
+void GeometryArena::FreeList::Reset(GLuint newCapacity, GLuint used) {
+    assert(used <= newCapacity);
+
+    capacity = newCapacity;
+    blocks.clear();
+
+    if (used < capacity) {
+        Block_t block = {used, capacity - used};
+        blocks.push_back(block);
+    }
+}
+
+GLuint GeometryArena::FreeList::Allocate(GLuint count) {
+    for (size_t i=0; i<blocks.size(); ++i) {
+        Block_t& block = blocks[i];
+        if (block.count < count)
+            continue;
+
+        GLuint offset = block.offset;
+        block.offset += count;
+        block.count  -= count;
+
+        if (block.count == 0)
+            blocks.erase(blocks.begin() + i);
+
+        return offset;
+    }
+
+    return NO_SPACE;
+}
+
+void GeometryArena::FreeList::Free(GLuint offset, GLuint count) {
+    if (count == 0)
+        return;
+
+    // Find the first block after the freed range
+    size_t i = 0;
+    while (i < blocks.size() && blocks[i].offset < offset)
+        ++i;
+
+    bool mergePrev = i > 0 && blocks[i-1].offset + blocks[i-1].count == offset;
+    bool mergeNext = i < blocks.size() && offset + count == blocks[i].offset;
+
+    if (mergePrev && mergeNext) {
+        blocks[i-1].count += count + blocks[i].count;
+        blocks.erase(blocks.begin() + i);
+    } else if (mergePrev) {
+        blocks[i-1].count += count;
+    } else if (mergeNext) {
+        blocks[i].offset = offset;
+        blocks[i].count += count;
+    } else {
+        Block_t block = {offset, count};
+        blocks.insert(blocks.begin() + i, block);
+    }
+}
+
+GLuint GeometryArena::FreeList::GetFreeCount() const {
+    GLuint total = 0;
+    for (size_t i=0; i<blocks.size(); ++i)
+        total += blocks[i].count;
+
+    return total;
+}
+
+GLuint GeometryArena::FreeList::GetLargestBlock() const {
+    GLuint largest = 0;
+    for (size_t i=0; i<blocks.size(); ++i)
+        largest = std::max(largest, blocks[i].count);
+
+    return largest;
+}
+
+GeometryArena::GeometryArena(VertexAttributeBinding_t* attribFormats, GLuint attribCount,
+    IndexType::IndexType indexFormat, GLuint vertexCapacity, GLuint indexCapacity) :
+    vaoHandle(0), vertexStride(0), indexFormat(indexFormat), indexSize(GetIndexTypeSize(indexFormat)),
+    generation(0), compactions(0) {
+
+    vboHandles[0] = vboHandles[1] = 0;
+
+    vertexFormat.assign(attribFormats, attribFormats + attribCount);
+    if (attribCount > 0)
+        vertexStride = attribFormats[0].stride;
+
+    CreateBuffers(vertexCapacity, indexCapacity);
+
+    vertexSpace.Reset(vertexCapacity, 0);
+    indexSpace.Reset(indexCapacity, 0);
+}
+
+GeometryArena::~GeometryArena() {
+    GLState::ForgetVertexArray(vaoHandle);
+    glDeleteVertexArrays(1, &vaoHandle);
+
+    GLState::ForgetBuffer(vboHandles[0]);
+    GLState::ForgetBuffer(vboHandles[1]);
+    glDeleteBuffers(2, vboHandles);
+}
+
+void GeometryArena::CreateBuffers(GLuint vertexCapacity, GLuint indexCapacity) {
+    glGenBuffers(2, vboHandles);
+    glGenVertexArrays(1, &vaoHandle);
+
+    GLState::BindVertexArray(vaoHandle);
+
+    GLState::BindBuffer(GL_ARRAY_BUFFER, vboHandles[0]);
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity * vertexStride, NULL, GL_STATIC_DRAW);
+
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, vboHandles[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * indexSize, NULL, GL_STATIC_DRAW);
+
+    for (size_t i=0; i<vertexFormat.size(); ++i) {
+        const VertexAttributeBinding_t& attr = vertexFormat[i];
+
+        glEnableVertexAttribArray(attr.attrib);
+        glVertexAttribPointer(attr.attrib, attr.size, attr.type, attr.normalized, attr.stride, attr.offset);
+    }
+}
+
+void GeometryArena::Repack(GLuint vertexCapacity, GLuint indexCapacity) {
+    GLuint oldVao = vaoHandle;
+    GLuint oldBuffers[2] = {vboHandles[0], vboHandles[1]};
+
+    CreateBuffers(vertexCapacity, indexCapacity);
+
+    // Copy every live allocation over, packed together in the order they were in
+    std::vector<GLuint> order;
+    for (GLuint i=0; i<allocations.size(); ++i)
+        if (allocations[i].live)
+            order.push_back(i);
+
+    struct ByVertexOffset {
+        const std::vector<ArenaAllocation_t>& allocations;
+        ByVertexOffset(const std::vector<ArenaAllocation_t>& allocations) : allocations(allocations) {}
+
+        bool operator()(GLuint a, GLuint b) const {
+            return allocations[a].vertexOffset < allocations[b].vertexOffset;
+        }
+    };
+    std::sort(order.begin(), order.end(), ByVertexOffset(allocations));
+
+    GLState::BindBuffer(GL_COPY_READ_BUFFER,  oldBuffers[0]);
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, vboHandles[0]);
+
+    GLuint vertexHead = 0;
+    for (size_t i=0; i<order.size(); ++i) {
+        ArenaAllocation_t& alloc = allocations[order[i]];
+
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+            alloc.vertexOffset * vertexStride, vertexHead * vertexStride, alloc.vertexCount * vertexStride);
+
+        alloc.vertexOffset = vertexHead;
+        vertexHead += alloc.vertexCount;
+    }
+
+    GLState::BindBuffer(GL_COPY_READ_BUFFER,  oldBuffers[1]);
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, vboHandles[1]);
+
+    GLuint indexHead = 0;
+    for (size_t i=0; i<order.size(); ++i) {
+        ArenaAllocation_t& alloc = allocations[order[i]];
+
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+            alloc.indexOffset * indexSize, indexHead * indexSize, alloc.indexCount * indexSize);
+
+        alloc.indexOffset = indexHead;
+        indexHead += alloc.indexCount;
+    }
+
+    vertexSpace.Reset(vertexCapacity, vertexHead);
+    indexSpace.Reset(indexCapacity, indexHead);
+
+    GLState::ForgetVertexArray(oldVao);
+    glDeleteVertexArrays(1, &oldVao);
+
+    GLState::ForgetBuffer(oldBuffers[0]);
+    GLState::ForgetBuffer(oldBuffers[1]);
+    glDeleteBuffers(2, oldBuffers);
+
+    ++generation;
+    ++compactions;
+}
+
+void GeometryArena::Compact() {
+    Repack(vertexSpace.GetCapacity(), indexSpace.GetCapacity());
+}
+
+GLuint GeometryArena::Allocate(GLuint vertexCount, const void* vertices, GLuint indexCount, const void* indices) {
+    GLuint vertexOffset = vertexSpace.Allocate(vertexCount);
+    GLuint indexOffset  = indexSpace.Allocate(indexCount);
+
+    if (vertexOffset == FreeList::NO_SPACE || indexOffset == FreeList::NO_SPACE) {
+        // Give back whichever half did fit, then make room by repacking
+        if (vertexOffset != FreeList::NO_SPACE) vertexSpace.Free(vertexOffset, vertexCount);
+        if (indexOffset  != FreeList::NO_SPACE) indexSpace.Free(indexOffset, indexCount);
+
+        GLuint vertexCapacity = vertexSpace.GetCapacity();
+        GLuint indexCapacity  = indexSpace.GetCapacity();
+
+        // Grow if packing alone wouldn't leave enough room
+        while (vertexCapacity - (vertexSpace.GetCapacity() - vertexSpace.GetFreeCount()) < vertexCount)
+            vertexCapacity = std::max(2*vertexCapacity, 1024u);
+
+        while (indexCapacity - (indexSpace.GetCapacity() - indexSpace.GetFreeCount()) < indexCount)
+            indexCapacity = std::max(2*indexCapacity, 1024u);
+
+        Repack(vertexCapacity, indexCapacity);
+
+        vertexOffset = vertexSpace.Allocate(vertexCount);
+        indexOffset  = indexSpace.Allocate(indexCount);
+
+        assert(vertexOffset != FreeList::NO_SPACE && indexOffset != FreeList::NO_SPACE);
+    }
+
+    // Upload. Binding the element array buffer here goes into our vertex array, which is fine.
+    GLState::BindVertexArray(vaoHandle);
+
+    GLState::BindBuffer(GL_ARRAY_BUFFER, vboHandles[0]);
+    glBufferSubData(GL_ARRAY_BUFFER, vertexOffset * vertexStride, vertexCount * vertexStride, vertices);
+
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, vboHandles[1]);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexOffset * indexSize, indexCount * indexSize, indices);
+
+    ArenaAllocation_t alloc = {vertexOffset, vertexCount, indexOffset, indexCount, true};
+
+    GLuint handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+        allocations[handle] = alloc;
+    } else {
+        handle = allocations.size();
+        allocations.push_back(alloc);
+    }
+
+    return handle;
+}
+
+void GeometryArena::Free(GLuint handle) {
+    assert(handle < allocations.size() && allocations[handle].live);
+
+    ArenaAllocation_t& alloc = allocations[handle];
+    vertexSpace.Free(alloc.vertexOffset, alloc.vertexCount);
+    indexSpace.Free(alloc.indexOffset, alloc.indexCount);
+
+    alloc.live = false;
+    freeHandles.push_back(handle);
+}
+
+ArenaStats_t GeometryArena::GetStats() const {
+    ArenaStats_t stats;
+
+    stats.allocations = allocations.size() - freeHandles.size();
+
+    GLuint vertexFree = vertexSpace.GetFreeCount();
+    stats.vertexCapacity      = vertexSpace.GetCapacity();
+    stats.verticesUsed        = stats.vertexCapacity - vertexFree;
+    stats.vertexFreeBlocks    = vertexSpace.GetBlockCount();
+    stats.largestVertexBlock  = vertexSpace.GetLargestBlock();
+    stats.vertexFragmentation = vertexFree > 0 ? 1.0f - (float)stats.largestVertexBlock / vertexFree : 0.0f;
+
+    GLuint indexFree = indexSpace.GetFreeCount();
+    stats.indexCapacity      = indexSpace.GetCapacity();
+    stats.indicesUsed        = stats.indexCapacity - indexFree;
+    stats.indexFreeBlocks    = indexSpace.GetBlockCount();
+    stats.largestIndexBlock  = indexSpace.GetLargestBlock();
+    stats.indexFragmentation = indexFree > 0 ? 1.0f - (float)stats.largestIndexBlock / indexFree : 0.0f;
+
+    stats.compactions = compactions;
+
+    return stats;
+}
@@ -0,0 +1,167 @@
+#ifndef GEOMETRYARENA_H
+#define GEOMETRYARENA_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Rendering.h"
+#include "GLState.h"
+
+/**
+ * ArenaAllocation_t - Where a mesh's vertices and indices live inside a GeometryArena.
+ * Offsets and counts are in vertices and indices rather than bytes.
+ */
+typedef struct {
+    GLuint vertexOffset;
+    GLuint vertexCount;
+    GLuint indexOffset;
+    GLuint indexCount;
+    bool live;
+} ArenaAllocation_t;
+
+/**
+ * ArenaStats_t - How full and how fragmented the arena's buffers are.
+ * Fragmentation is the fraction of free space that isn't part of the largest free block,
+ * i.e. 0 when all free space is in one piece.
+ */
+typedef struct {
+    GLuint allocations;
+
+    GLuint vertexCapacity;
+    GLuint verticesUsed;
+    GLuint vertexFreeBlocks;
+    GLuint largestVertexBlock;
+    float vertexFragmentation;
+
+    GLuint indexCapacity;
+    GLuint indicesUsed;
+    GLuint indexFreeBlocks;
+    GLuint largestIndexBlock;
+    float indexFragmentation;
+
+    GLuint compactions;
+} ArenaStats_t;
+
+/**
+ * GeometryArena
+ * One vertex buffer, one index buffer and one vertex array shared by every mesh with the
+ * same vertex format. Meshes get a range of each buffer, and draw with
+ * glDrawElementsBaseVertex so their indices can stay relative to their own first vertex.
+ * Drawing any number of meshes out of the same arena needs only one vertex array bind.
+ *
+ * Free space in each buffer is tracked with a free list. When an allocation doesn't fit,
+ * the arena compacts all live allocations into fresh buffers, growing them if there isn't
+ * enough free space in total. Allocations are referred to by handle, since compacting
+ * moves them around.
+ */
+class GeometryArena {
+public:
+    static const GLuint INVALID_HANDLE = 0xFFFFFFFF;
+
+private:
+    /**
+     * FreeList - First-fit allocator over a range of elements, with neighbouring free
+     * blocks merged back together as they're freed
+     */
+    class FreeList {
+    private:
+        typedef struct {
+            GLuint offset;
+            GLuint count;
+        } Block_t;
+
+        // Sorted by offset
+        std::vector<Block_t> blocks;
+        GLuint capacity;
+
+    public:
+        static const GLuint NO_SPACE = 0xFFFFFFFF;
+
+        FreeList() : capacity(0) {}
+
+        void Reset(GLuint capacity, GLuint used);
+
+        GLuint Allocate(GLuint count);
+        void Free(GLuint offset, GLuint count);
+
+        GLuint GetCapacity() const { return capacity; }
+        GLuint GetFreeCount() const;
+        GLuint GetBlockCount() const { return blocks.size(); }
+        GLuint GetLargestBlock() const;
+    };
+
+    GLuint vaoHandle;
+    GLuint vboHandles[2];
+
+    std::vector<VertexAttributeBinding_t> vertexFormat;
+    GLsizei vertexStride;
+
+    IndexType::IndexType indexFormat;
+    GLsizei indexSize;
+
+    FreeList vertexSpace;
+    FreeList indexSpace;
+
+    std::vector<ArenaAllocation_t> allocations;
+    std::vector<GLuint> freeHandles;
+
+    // Bumped whenever allocations move, so anything caching offsets knows to refresh
+    GLuint generation;
+    GLuint compactions;
+
+    void CreateBuffers(GLuint vertexCapacity, GLuint indexCapacity);
+
+    /**
+     * Repack
+     * Moves every live allocation into new buffers of the given capacities,
+     * packed together from the start with no gaps
+     */
+    void Repack(GLuint vertexCapacity, GLuint indexCapacity);
+
+public:
+    /**
+     * attribFormats  - Vertex format shared by every mesh in the arena. Offsets are
+     *                  relative to the start of a vertex.
+     * indexFormat    - Index type shared by every mesh in the arena
+     * vertexCapacity - Number of vertices to make room for up front
+     * indexCapacity  - Number of indices to make room for up front
+     */
+    GeometryArena(VertexAttributeBinding_t* attribFormats, GLuint attribCount,
+        IndexType::IndexType indexFormat, GLuint vertexCapacity, GLuint indexCapacity);
+
+    ~GeometryArena();
+
+    /**
+     * Allocate
+     * Finds room for and uploads a mesh's vertices and indices. Indices are relative to
+     * the mesh's first vertex. Returns a handle to the allocation.
+     */
+    GLuint Allocate(GLuint vertexCount, const void* vertices, GLuint indexCount, const void* indices);
+
+    void Free(GLuint handle);
+
+    /**
+     * Compact
+     * Packs all live allocations together at the start of the buffers, so that the
+     * free space is all in one piece
+     */
+    void Compact();
+
+    const ArenaAllocation_t& GetAllocation(GLuint handle) const {
+        assert(handle < allocations.size() && allocations[handle].live);
+        return allocations[handle];
+    }
+
+    void Bind() const { GLState::BindVertexArray(vaoHandle); }
+
+    GLuint GetHandle() const { return vaoHandle; }
+    GLuint GetGeneration() const { return generation; }
+
+    IndexType::IndexType GetIndexFormat() const { return indexFormat; }
+    GLsizei GetIndexSize() const { return indexSize; }
+    GLsizei GetVertexStride() const { return vertexStride; }
+
+    ArenaStats_t GetStats() const;
+};
+
+#endif
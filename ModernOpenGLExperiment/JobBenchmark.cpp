@@ -0,0 +1,142 @@
+#include "JobBenchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Clock.h"
+#include "JobSystem.h"
+#include "MD3Model.h"
+
+// Jobs per measurement of raw scheduling overhead
+#define OVERHEAD_JOBS 200000
+
+// Times each model frame gets decoded per measurement
+#define DECODE_REPEATS 2048
+
+// Busy tasks per measurement, per task length
+#define BUSY_TASKS 2000
+
+static void EmptyJob(void*, uint32_t, uint32_t) {
+}
+
+static void BusyJob(void* data, uint32_t, uint32_t) {
+    uint64_t duration = *(const uint64_t*)data;
+    uint64_t start = Clock::Now();
+
+    while (Clock::Now() - start < duration)
+        ;
+}
+
+// ns per job to queue and run jobs that do nothing, from a single thread
+static double MeasureOverhead() {
+    JobCounter counter;
+    uint64_t start = Clock::Now();
+
+    // Stay under the deque size so that nothing runs inline. The last batch rounds
+    // OVERHEAD_JOBS up, so count what was actually queued.
+    uint32_t queued = 0;
+    while (queued < OVERHEAD_JOBS) {
+        for (uint32_t i=0; i<JOB_DEQUE_SIZE/2; ++i)
+            JobSystem::Run(&EmptyJob, NULL, &counter);
+
+        queued += JOB_DEQUE_SIZE/2;
+        JobSystem::Wait(&counter);
+    }
+
+    return (double)(Clock::Now() - start) / queued;
+}
+
+static uint64_t MeasureDecode(const MD3Model* model) {
+    uint32_t surfaces = model->GetMeshCount();
+    uint32_t frames = model->GetFrameCount();
+    uint32_t count = surfaces * frames * DECODE_REPEATS;
+
+    uint64_t start = Clock::Now();
+
+    JobSystem::ParallelFor(count, 1, [=](uint32_t begin, uint32_t end) {
+        for (uint32_t i=begin; i<end; ++i) {
+            MeshVertex_t* vertexData;
+            uint32_t vertexCount;
+
+            model->GetVertices((i / frames) % surfaces, i % frames, vertexData, vertexCount);
+            delete[] vertexData;
+        }
+    });
+
+    return Clock::Now() - start;
+}
+
+static uint64_t MeasureBusy(uint64_t taskLength) {
+    JobCounter counter;
+    uint64_t start = Clock::Now();
+
+    for (uint32_t i=0; i<BUSY_TASKS; ++i)
+        JobSystem::Run(&BusyJob, &taskLength, &counter);
+
+    JobSystem::Wait(&counter);
+
+    return Clock::Now() - start;
+}
+
+int RunJobBenchmark(const char* modelFile) {
+    MD3Model* model = MD3Model::LoadFromFile(modelFile);
+    if (model == NULL || !model->IsValid()) {
+        fprintf(stderr, "Couldn't load %s\n", modelFile);
+        delete model;
+        return EXIT_FAILURE;
+    }
+
+    uint64_t taskLengths[] = {
+        Clock::FromSeconds(10e-6),
+        Clock::FromSeconds(50e-6),
+        Clock::FromSeconds(100e-6)
+    };
+
+    // Try every power of two up to the number of hardware threads, and that number itself
+    uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<uint32_t> workerCounts;
+    for (uint32_t n=1; n<hardwareThreads; n*=2)
+        workerCounts.push_back(n);
+    workerCounts.push_back(hardwareThreads);
+
+    printf("Job system benchmark, %u hardware threads\n", hardwareThreads);
+    printf("%s: %u surfaces x %u frames, decoded %u times\n\n",
+        modelFile, model->GetMeshCount(), model->GetFrameCount(), DECODE_REPEATS);
+
+    printf("workers  overhead(ns/job)  decode(ms)  busy10us(ms)  busy50us(ms)  busy100us(ms)  speedup\n");
+
+    double baseline = 0.0;
+
+    for (size_t w=0; w<workerCounts.size(); ++w) {
+        JobSystem::Startup(workerCounts[w]);
+
+        double overhead = MeasureOverhead();
+        uint64_t decode = MeasureDecode(model);
+
+        uint64_t busy[3];
+        for (int i=0; i<3; ++i)
+            busy[i] = MeasureBusy(taskLengths[i]);
+
+        JobSystem::Shutdown();
+
+        // Speedup over the whole mix, relative to a single worker
+        double total = Clock::ToMilliseconds(decode + busy[0] + busy[1] + busy[2]);
+        if (w == 0)
+            baseline = total;
+
+        printf("%7u  %16.1f  %10.2f  %12.2f  %12.2f  %13.2f  %6.2fx\n",
+            workerCounts[w], overhead,
+            Clock::ToMilliseconds(decode),
+            Clock::ToMilliseconds(busy[0]),
+            Clock::ToMilliseconds(busy[1]),
+            Clock::ToMilliseconds(busy[2]),
+            baseline / total);
+    }
+
+    delete model;
+
+    return EXIT_SUCCESS;
+}
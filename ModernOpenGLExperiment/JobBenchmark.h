@@ -0,0 +1,14 @@
+#ifndef JOBBENCHMARK_H
+#define JOBBENCHMARK_H
+
+/**
+ * RunJobBenchmark
+ * Measures the JobSystem's per-job overhead, and how a mix of workloads scales with the
+ * number of workers: decoding every frame of every surface of an MD3 model, and busy
+ * tasks of fixed length. Prints the results and returns an exit code.
+ *
+ * modelFile - MD3 model to decode
+ */
+int RunJobBenchmark(const char* modelFile);
+
+#endif
@@ -0,0 +1,268 @@
+#include "JobSystem.h"
+#include "CPUProfiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+
+// Failed attempts at finding work before an idle worker goes to sleep
+#define IDLE_SPINS 64
+
+// Sleeping workers get woken up when there's work, this is just a backstop
+#define SLEEP_TIMEOUT_MS 100
+
+std::vector<JobSystem::Worker_t*> JobSystem::workers;
+std::vector<std::thread> JobSystem::threads;
+
+std::atomic<bool> JobSystem::running(false);
+
+std::mutex JobSystem::sleepMutex;
+std::condition_variable JobSystem::wakeUp;
+std::atomic<int32_t> JobSystem::sleepers(0);
+
+JOB_THREAD_LOCAL JobSystem::Worker_t* JobSystem::currentWorker = NULL;
+
+bool JobSystem::JobDeque::Push(const Job_t& job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+
+    if (b - t >= JOB_DEQUE_SIZE)
+        return false;
+
+    slots[b & (JOB_DEQUE_SIZE-1)] = job;
+
+    // The job has to be visible before the new bottom is
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool JobSystem::JobDeque::Pop(Job_t& job) {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+
+    // Claim the bottom slot before looking at top, so that a thief can't take it too
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // Empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    job = slots[b & (JOB_DEQUE_SIZE-1)];
+
+    if (t == b) {
+        // Last job; race any thieves for it
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+
+        return won;
+    }
+
+    return true;
+}
+
+bool JobSystem::JobDeque::Steal(Job_t& job) {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+        return false;
+
+    job = slots[t & (JOB_DEQUE_SIZE-1)];
+
+    // Lost to the owner or another thief
+    return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+bool JobSystem::JobDeque::IsEmpty() const {
+    return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+}
+
+void JobSystem::Startup(uint32_t workerCount) {
+    assert(workers.empty());
+
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (uint32_t i=0; i<workerCount; ++i) {
+        Worker_t* worker = new Worker_t;
+        worker->random = 2654435761u * (i + 1);
+        worker->jobsRun = worker->jobsStolen = worker->jobsRunInline = 0;
+
+        workers.push_back(worker);
+    }
+
+    running.store(true);
+    currentWorker = workers[0];
+
+    for (uint32_t i=1; i<workerCount; ++i)
+        threads.push_back(std::thread(&JobSystem::WorkerMain, i));
+}
+
+void JobSystem::Shutdown() {
+    running.store(false);
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeUp.notify_all();
+    }
+
+    for (size_t i=0; i<threads.size(); ++i)
+        threads[i].join();
+
+    threads.clear();
+
+    for (size_t i=0; i<workers.size(); ++i) {
+        assert(workers[i]->deque.IsEmpty());
+        delete workers[i];
+    }
+
+    workers.clear();
+    currentWorker = NULL;
+}
+
+void JobSystem::WorkerMain(uint32_t index) {
+    Worker_t* worker = workers[index];
+    currentWorker = worker;
+
+    char name[PROFILER_THREAD_NAME_LENGTH];
+    sprintf(name, "Job worker %u", index);
+    CPUProfiler::SetThreadName(name);
+
+    uint32_t idle = 0;
+    while (running.load(std::memory_order_relaxed)) {
+        if (RunOne(worker)) {
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Nothing to do for a while, so sleep. Once we count as a sleeper, anyone
+        // queueing a job will wake us up, so check one last time after that.
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (running.load() && !HasWork())
+            wakeUp.wait_for(lock, std::chrono::milliseconds(SLEEP_TIMEOUT_MS));
+
+        sleepers.fetch_sub(1);
+
+        idle = 0;
+    }
+
+    currentWorker = NULL;
+}
+
+bool JobSystem::HasWork() {
+    for (size_t i=0; i<workers.size(); ++i)
+        if (!workers[i]->deque.IsEmpty())
+            return true;
+
+    return false;
+}
+
+void JobSystem::Execute(const Job_t& job) {
+    PROFILE_ZONE("Job");
+    job.function(job.data, job.begin, job.end);
+
+    if (job.counter != NULL)
+        job.counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+bool JobSystem::RunOne(Worker_t* worker) {
+    Job_t job;
+
+    if (!worker->deque.Pop(job)) {
+        // Pick a random victim to start from, so thieves spread out
+        worker->random = worker->random * 1664525u + 1013904223u;
+
+        size_t count = workers.size();
+        size_t start = (worker->random >> 16) % count;
+
+        bool stolen = false;
+        for (size_t i=0; i<count && !stolen; ++i) {
+            Worker_t* victim = workers[(start + i) % count];
+            if (victim != worker)
+                stolen = victim->deque.Steal(job);
+        }
+
+        if (!stolen)
+            return false;
+
+        ++worker->jobsStolen;
+    }
+
+    Execute(job);
+    ++worker->jobsRun;
+
+    return true;
+}
+
+void JobSystem::RunRange(JobFunction function, void* data, uint32_t begin, uint32_t end, JobCounter* counter) {
+    Worker_t* worker = currentWorker;
+    assert(worker != NULL && "Jobs can only be queued from worker threads");
+
+    Job_t job = {function, data, begin, end, counter};
+
+    if (counter != NULL)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (!worker->deque.Push(job)) {
+        Execute(job);
+        ++worker->jobsRunInline;
+        return;
+    }
+
+    // Pairs with the fence in WorkerMain: either the sleeper sees the job, or we see the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (sleepers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeUp.notify_one();
+    }
+}
+
+void JobSystem::Run(JobFunction function, void* data, JobCounter* counter) {
+    RunRange(function, data, 0, 0, counter);
+}
+
+void JobSystem::Wait(JobCounter* counter) {
+    Worker_t* worker = currentWorker;
+    assert(worker != NULL && "Only worker threads can wait on jobs");
+
+    while (counter->pending.load(std::memory_order_acquire) > 0) {
+        if (!RunOne(worker))
+            std::this_thread::yield();
+    }
+}
+
+int32_t JobSystem::GetWorkerIndex() {
+    for (size_t i=0; i<workers.size(); ++i)
+        if (workers[i] == currentWorker)
+            return (int32_t)i;
+
+    return -1;
+}
+
+JobSystemStats_t JobSystem::GetStats() {
+    JobSystemStats_t stats = {0};
+
+    for (size_t i=0; i<workers.size(); ++i) {
+        stats.jobsRun       += workers[i]->jobsRun;
+        stats.jobsStolen    += workers[i]->jobsStolen;
+        stats.jobsRunInline += workers[i]->jobsRunInline;
+    }
+
+    return stats;
+}
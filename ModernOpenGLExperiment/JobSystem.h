@@ -0,0 +1,211 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Jobs each worker can have queued at once; must be a power of two
+#define JOB_DEQUE_SIZE 4096
+
+#ifdef _MSC_VER
+#define JOB_THREAD_LOCAL __declspec(thread)
+#else
+#define JOB_THREAD_LOCAL __thread
+#endif
+
+/**
+ * JobFunction - Work to do for the range [begin, end). Jobs that aren't part of a
+ * ParallelFor get an empty range.
+ */
+typedef void (*JobFunction)(void* data, uint32_t begin, uint32_t end);
+
+/**
+ * JobCounter - How many jobs are still outstanding in a group. Every Run increments it,
+ * every finished job decrements it, and Wait returns once it gets to 0.
+ */
+typedef struct JobCounter {
+    std::atomic<int32_t> pending;
+
+    JobCounter() : pending(0) {}
+} JobCounter;
+
+/**
+ * JobSystemStats_t - Counters since Startup. Only exact while no jobs are running.
+ */
+typedef struct {
+    uint64_t jobsRun;
+    uint64_t jobsStolen;
+    uint64_t jobsRunInline; // Ran straight away because the worker's queue was full
+} JobSystemStats_t;
+
+/**
+ * JobSystem
+ * Work-stealing scheduler for short tasks, somewhere in the 10-100us range.
+ *
+ * Each worker thread has its own deque of jobs. Workers push and pop at the bottom of
+ * their own deque without any contention, and when they run dry they steal from the top
+ * of somebody else's. The deques are lock-free (Chase-Lev) and hold jobs by value, so
+ * running a job never takes a lock or allocates. A worker whose deque is full runs
+ * new jobs on the spot instead.
+ *
+ * The thread that calls Startup becomes worker 0, and only worker threads may run jobs
+ * or wait on them. Waiting doesn't block: the waiting thread keeps running jobs until
+ * its counter reaches 0, so nested fork/join doesn't deadlock.
+ *
+ * Workers with nothing to do spin briefly, then sleep until more work shows up.
+ */
+class JobSystem {
+private:
+    typedef struct {
+        JobFunction function;
+        void* data;
+        uint32_t begin;
+        uint32_t end;
+        JobCounter* counter;
+    } Job_t;
+
+    /**
+     * JobDeque - Chase-Lev work-stealing deque of a fixed size. Only the owning worker
+     * may Push and Pop, anyone may Steal.
+     *
+     * Jobs are copied in and out by value. A thief copies a job out before it tries to
+     * claim it, and the copy can be torn if the owner is reusing that slot at the same
+     * time - but the owner only reuses a slot once top has moved past it, so the claim
+     * fails and the torn copy gets thrown away.
+     */
+    class JobDeque {
+    private:
+        std::atomic<int64_t> top;
+        std::atomic<int64_t> bottom;
+        Job_t slots[JOB_DEQUE_SIZE];
+
+    public:
+        JobDeque() : top(0), bottom(0) {}
+
+        // Returns false if the deque is full
+        bool Push(const Job_t& job);
+        bool Pop(Job_t& job);
+        bool Steal(Job_t& job);
+
+        bool IsEmpty() const;
+    };
+
+    typedef struct Worker_t {
+        JobDeque deque;
+
+        // For picking steal victims
+        uint32_t random;
+
+        uint64_t jobsRun;
+        uint64_t jobsStolen;
+        uint64_t jobsRunInline;
+    } Worker_t;
+
+    static std::vector<Worker_t*> workers;
+    static std::vector<std::thread> threads;
+
+    static std::atomic<bool> running;
+
+    static std::mutex sleepMutex;
+    static std::condition_variable wakeUp;
+    static std::atomic<int32_t> sleepers;
+
+    static JOB_THREAD_LOCAL Worker_t* currentWorker;
+
+    static void WorkerMain(uint32_t index);
+
+    static bool HasWork();
+
+    // Runs a single job from our own deque or someone else's, if there are any
+    static bool RunOne(Worker_t* worker);
+    static void Execute(const Job_t& job);
+
+    template <typename F>
+    static void CallTrampoline(void* data, uint32_t, uint32_t) {
+        (*(const F*)data)();
+    }
+
+    template <typename F>
+    static void RangeTrampoline(void* data, uint32_t begin, uint32_t end) {
+        (*(const F*)data)(begin, end);
+    }
+
+    JobSystem() {}
+
+public:
+    /**
+     * Startup
+     * Starts workerCount-1 worker threads, with the calling thread making up the
+     * last. Zero means one worker per hardware thread.
+     */
+    static void Startup(uint32_t workerCount = 0);
+
+    /**
+     * Shutdown
+     * Stops the worker threads. No jobs may be outstanding.
+     */
+    static void Shutdown();
+
+    /**
+     * Run
+     * Queues a job to call function(data, 0, 0), counting it against counter
+     */
+    static void Run(JobFunction function, void* data, JobCounter* counter);
+
+    /**
+     * Run
+     * Queues a job to call function(). The function object is only referenced, not
+     * copied, so it has to outlive the job.
+     */
+    template <typename F>
+    static void Run(const F& function, JobCounter* counter) {
+        Run(&CallTrampoline<F>, (void*)&function, counter);
+    }
+
+    /**
+     * RunRange
+     * Queues a job to call function(data, begin, end)
+     */
+    static void RunRange(JobFunction function, void* data, uint32_t begin, uint32_t end, JobCounter* counter);
+
+    /**
+     * Wait
+     * Runs jobs until everything counted against counter has finished
+     */
+    static void Wait(JobCounter* counter);
+
+    /**
+     * ParallelFor
+     * Calls body(begin, end) over [0, count) split into chunks of at most grain
+     * elements, and waits for all of them. body must be callable from any worker.
+     */
+    template <typename F>
+    static void ParallelFor(uint32_t count, uint32_t grain, const F& body) {
+        if (grain == 0)
+            grain = 1;
+
+        JobCounter counter;
+        for (uint32_t begin=0; begin<count; begin+=grain) {
+            uint32_t end = count - begin > grain ? begin + grain : count;
+            RunRange(&RangeTrampoline<F>, (void*)&body, begin, end, &counter);
+        }
+
+        Wait(&counter);
+    }
+
+    static uint32_t GetWorkerCount() { return (uint32_t)workers.size(); }
+
+    /**
+     * GetWorkerIndex
+     * Index of the calling thread among the workers, or -1 if it isn't one
+     */
+    static int32_t GetWorkerIndex();
+
+    static JobSystemStats_t GetStats();
+};
+
+#endif
@@ -0,0 +1,220 @@
+#if defined(_WIN32)
+// Before gl_core_3_3.h, which leaves APIENTRY alone if it's already defined
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#include "LazyGL.h"
+#include "Clock.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+typedef void (CODEGEN_FUNCPTR* GLProc)();
+
+// The function pointer each entry point loads into
+static GLProc* slots[GLFunction::Count];
+
+// What each entry point resolved to, or NULL if it hasn't been called yet
+static GLProc resolved[GLFunction::Count];
+
+static std::vector<GLFunction::GLFunction> resolveOrder;
+static uint64_t resolveTime = 0;
+
+static GLProc LookUp(const char* name) {
+    GLProc proc = (GLProc)glfwGetProcAddress(name);
+
+#ifdef _WIN32
+    // wglGetProcAddress only knows about what came after GL 1.1
+    if (proc == NULL)
+        proc = (GLProc)::GetProcAddress(GetModuleHandleA("OpenGL32.dll"), name);
+#endif
+
+    return proc;
+}
+
+static GLProc Resolve(int function, GLProc trampoline) {
+    GLProc proc = resolved[function];
+
+    if (proc == NULL) {
+        uint64_t start = Clock::Now();
+
+        const char* name = GLFunction::GetName((GLFunction::GLFunction)function);
+        proc = LookUp(name);
+
+        resolveTime += Clock::Now() - start;
+
+        if (proc == NULL) {
+            fprintf(stderr, "Unable to load OpenGL function %s!\n", name);
+            exit(EXIT_FAILURE);
+        }
+
+        resolved[function] = proc;
+        resolveOrder.push_back((GLFunction::GLFunction)function);
+    }
+
+    if (*slots[function] == trampoline)
+        *slots[function] = proc;
+
+    return proc;
+}
+
+/*
+ * Trampolines, one per arity. Like NullGL's stubs, they have to match each function
+ * pointer's type exactly.
+ */
+
+template <int F, typename R>
+R CODEGEN_FUNCPTR Lazy0() {
+    typedef R (CODEGEN_FUNCPTR* Function)();
+    return ((Function)Resolve(F, (GLProc)&Lazy0<F, R>))();
+}
+
+template <int F, typename R>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)()) { slots[F] = (GLProc*)&function; function = &Lazy0<F, R>; }
+
+template <int F, typename R, typename A1>
+R CODEGEN_FUNCPTR Lazy1(A1 a1) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1);
+    return ((Function)Resolve(F, (GLProc)&Lazy1<F, R, A1>))(a1);
+}
+
+template <int F, typename R, typename A1>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1)) { slots[F] = (GLProc*)&function; function = &Lazy1<F, R, A1>; }
+
+template <int F, typename R, typename A1, typename A2>
+R CODEGEN_FUNCPTR Lazy2(A1 a1, A2 a2) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1, A2);
+    return ((Function)Resolve(F, (GLProc)&Lazy2<F, R, A1, A2>))(a1, a2);
+}
+
+template <int F, typename R, typename A1, typename A2>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1, A2)) { slots[F] = (GLProc*)&function; function = &Lazy2<F, R, A1, A2>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3>
+R CODEGEN_FUNCPTR Lazy3(A1 a1, A2 a2, A3 a3) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1, A2, A3);
+    return ((Function)Resolve(F, (GLProc)&Lazy3<F, R, A1, A2, A3>))(a1, a2, a3);
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3)) { slots[F] = (GLProc*)&function; function = &Lazy3<F, R, A1, A2, A3>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4>
+R CODEGEN_FUNCPTR Lazy4(A1 a1, A2 a2, A3 a3, A4 a4) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1, A2, A3, A4);
+    return ((Function)Resolve(F, (GLProc)&Lazy4<F, R, A1, A2, A3, A4>))(a1, a2, a3, a4);
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4)) { slots[F] = (GLProc*)&function; function = &Lazy4<F, R, A1, A2, A3, A4>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5>
+R CODEGEN_FUNCPTR Lazy5(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1, A2, A3, A4, A5);
+    return ((Function)Resolve(F, (GLProc)&Lazy5<F, R, A1, A2, A3, A4, A5>))(a1, a2, a3, a4, a5);
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5)) { slots[F] = (GLProc*)&function; function = &Lazy5<F, R, A1, A2, A3, A4, A5>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+R CODEGEN_FUNCPTR Lazy6(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1, A2, A3, A4, A5, A6);
+    return ((Function)Resolve(F, (GLProc)&Lazy6<F, R, A1, A2, A3, A4, A5, A6>))(a1, a2, a3, a4, a5, a6);
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6)) { slots[F] = (GLProc*)&function; function = &Lazy6<F, R, A1, A2, A3, A4, A5, A6>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+R CODEGEN_FUNCPTR Lazy7(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1, A2, A3, A4, A5, A6, A7);
+    return ((Function)Resolve(F, (GLProc)&Lazy7<F, R, A1, A2, A3, A4, A5, A6, A7>))(a1, a2, a3, a4, a5, a6, a7);
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7)) { slots[F] = (GLProc*)&function; function = &Lazy7<F, R, A1, A2, A3, A4, A5, A6, A7>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+R CODEGEN_FUNCPTR Lazy8(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1, A2, A3, A4, A5, A6, A7, A8);
+    return ((Function)Resolve(F, (GLProc)&Lazy8<F, R, A1, A2, A3, A4, A5, A6, A7, A8>))(a1, a2, a3, a4, a5, a6, a7, a8);
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8)) { slots[F] = (GLProc*)&function; function = &Lazy8<F, R, A1, A2, A3, A4, A5, A6, A7, A8>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+R CODEGEN_FUNCPTR Lazy9(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8, A9 a9) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1, A2, A3, A4, A5, A6, A7, A8, A9);
+    return ((Function)Resolve(F, (GLProc)&Lazy9<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9>))(a1, a2, a3, a4, a5, a6, a7, a8, a9);
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8, A9)) { slots[F] = (GLProc*)&function; function = &Lazy9<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+R CODEGEN_FUNCPTR Lazy10(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8, A9 a9, A10 a10) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10);
+    return ((Function)Resolve(F, (GLProc)&Lazy10<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10>))(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10);
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10)) { slots[F] = (GLProc*)&function; function = &Lazy10<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+R CODEGEN_FUNCPTR Lazy11(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8, A9 a9, A10 a10, A11 a11) {
+    typedef R (CODEGEN_FUNCPTR* Function)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11);
+    return ((Function)Resolve(F, (GLProc)&Lazy11<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11>))(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11);
+}
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+void BindLazy(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11)) { slots[F] = (GLProc*)&function; function = &Lazy11<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11>; }
+
+int LazyGL::LoadFunctions() {
+    for (int i=0; i<GLFunction::Count; ++i)
+        resolved[i] = NULL;
+
+    resolveOrder.clear();
+    resolveTime = 0;
+
+    #define GL_FUNCTION(name) BindLazy<GLFunction::name>(_ptrc_##name);
+    #include "GLFunctionList.h"
+    #undef GL_FUNCTION
+
+    return ogl_LOAD_SUCCEEDED;
+}
+
+uint32_t LazyGL::GetResolvedCount() {
+    return (uint32_t)resolveOrder.size();
+}
+
+void LazyGL::GetResolvedFunctions(std::vector<GLFunction::GLFunction>& functions) {
+    functions = resolveOrder;
+}
+
+uint64_t LazyGL::GetResolveTime() {
+    return resolveTime;
+}
+
+bool LazyGL::WriteFunctionList(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (file == NULL)
+        return false;
+
+    fprintf(file, "// Entry points resolved in one run, %u of %u\n", GetResolvedCount(), (uint32_t)GLFunction::Count);
+
+    for (int i=0; i<GLFunction::Count; ++i) {
+        if (resolved[i] != NULL)
+            fprintf(file, "GL_FUNCTION(%s)\n", GLFunction::GetName((GLFunction::GLFunction)i));
+    }
+
+    fclose(file);
+    return true;
+}
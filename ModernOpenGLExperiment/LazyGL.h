@@ -0,0 +1,62 @@
+#ifndef LAZYGL_H
+#define LAZYGL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Rendering.h"
+#include "GLFunctions.h"
+
+/**
+ * LazyGL
+ * A loader that looks GL entry points up as they're first called, rather than all of
+ * them up front like ogl_LoadFunctions does.
+ *
+ * LoadFunctions points every gl_core_3_3 entry point at a trampoline. The first call
+ * through one looks the real function up by name, patches the pointer so later calls go
+ * straight to the driver, and then makes the call. Pointers something else has wrapped
+ * in the meantime (GLCapture) are left alone; the wrapper keeps calling the trampoline,
+ * which only looks the function up once.
+ *
+ * What got resolved can be written out as a GL function list, to generate a loader
+ * with only the entry points the app actually uses.
+ *
+ * Resolving isn't thread safe, but neither is calling GL from more than one thread.
+ */
+class LazyGL {
+private:
+    LazyGL() {}
+
+public:
+    /**
+     * LoadFunctions
+     * Use instead of ogl_LoadFunctions, with the context current. Always returns
+     * ogl_LOAD_SUCCEEDED; a function the driver doesn't have is reported when it's
+     * first called.
+     */
+    static int LoadFunctions();
+
+    static uint32_t GetResolvedCount();
+
+    /**
+     * GetResolvedFunctions
+     * Fills functions with every entry point resolved so far, in the order they were
+     * first called
+     */
+    static void GetResolvedFunctions(std::vector<GLFunction::GLFunction>& functions);
+
+    /**
+     * GetResolveTime
+     * Time spent looking functions up, in ns
+     */
+    static uint64_t GetResolveTime();
+
+    /**
+     * WriteFunctionList
+     * Writes the resolved entry points in the GL_FUNCTION(name) form GLFunctionList.h
+     * uses, in the loader's order. Returns false if the file couldn't be written.
+     */
+    static bool WriteFunctionList(const char* filename);
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "MD3Model.h"
+#include "CPUProfiler.h"
 
 #define LATLONSCALE (3.141926f/128.0f)
 
@@ -53,6 +54,8 @@ MD3Model::~MD3Model() {
 };
 
 MD3Model* MD3Model::LoadFromFile(const char* filename) {
+    PROFILE_ZONE("MD3Model::LoadFromFile");
+
     std::ifstream infile(filename, std::ios::binary);
     if (!infile) throw errno;
 
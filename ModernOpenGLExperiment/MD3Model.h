@@ -116,6 +116,8 @@ public:
 
     uint32_t GetMeshCount() const { return header->numSurfaces; }
 
+    uint32_t GetFrameCount() const { return header->numFrames; }
+
     /**
      * Retrieves from the internal format a list of formatted vertices 
      * of the form MD3Model::Vertex_t.
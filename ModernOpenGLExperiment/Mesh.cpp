@@ -1,14 +1,18 @@
 #include "Mesh.h"
 
+#include <algorithm>
+#include <cstring>
+
 Mesh::Mesh(PrimitiveType::PrimitiveType primitiveType, VertexAttributeBinding_t* attribFormats, GLuint attribCount) : 
-    indexCount(0), vertexCount(0), vertexSize(0), indexFormat(IndexType::UnsignedShortIndex),
-    primitiveType(primitiveType), isDynamic(GL_STATIC_DRAW) {
+    indexCount(0), vertexCount(0), vertexSize(0), vertexStride(0), indexFormat(IndexType::UnsignedShortIndex),
+    primitiveType(primitiveType), isDynamic(GL_STATIC_DRAW), streamVertices(NULL),
+    arena(NULL), arenaHandle(GeometryArena::INVALID_HANDLE) {
 
     glGenBuffers(2, vboHandles);
-    glBindBuffer(GL_ARRAY_BUFFER, vboHandles[VBO_VERTICES]);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, vboHandles[VBO_VERTICES]);
 
     glGenVertexArrays(1, &vaoHandle);
-    glBindVertexArray(vaoHandle);
+    GLState::BindVertexArray(vaoHandle);
 
     vertexFormat.resize(attribCount);
     for (GLuint i=0; i<attribCount; ++i) {
@@ -23,29 +27,154 @@ Mesh::Mesh(PrimitiveType::PrimitiveType primitiveType, VertexAttributeBinding_t*
     }
 }
 
+Mesh::Mesh(PrimitiveType::PrimitiveType primitiveType, GeometryArena* arena, GLuint arenaHandle) :
+    vaoHandle(0), indexCount(0), vertexCount(0), vertexSize(0), vertexStride(arena->GetVertexStride()),
+    indexFormat(arena->GetIndexFormat()), primitiveType(primitiveType), isDynamic(GL_STATIC_DRAW),
+    streamVertices(NULL), arena(arena), arenaHandle(arenaHandle) {
+
+    vboHandles[VBO_VERTICES] = vboHandles[VBO_INDICES] = 0;
+
+    const ArenaAllocation_t& alloc = arena->GetAllocation(arenaHandle);
+    vertexCount = alloc.vertexCount;
+    indexCount  = alloc.indexCount;
+}
+
+Mesh* Mesh::CreateInArena(GeometryArena* arena, PrimitiveType::PrimitiveType primitiveType,
+    GLuint vertexCount, const void* vertices, GLuint indexCount, const void* indices) {
+
+    assert(arena != NULL);
+
+    GLuint handle = arena->Allocate(vertexCount, vertices, indexCount, indices);
+    return new Mesh(primitiveType, arena, handle);
+}
+
 Mesh::~Mesh() {
+    if (arena != NULL) {
+        arena->Free(arenaHandle);
+        return;
+    }
+
+    delete streamVertices;
+
+    GLState::ForgetVertexArray(vaoHandle);
     glDeleteVertexArrays(1, &vaoHandle);
+
+    GLState::ForgetBuffer(vboHandles[VBO_VERTICES]);
+    GLState::ForgetBuffer(vboHandles[VBO_INDICES]);
     glDeleteBuffers(2, vboHandles);
 }
 
 void Mesh::SetVertexData(GLuint count, GLuint size, void* data) {
+    assert(arena == NULL);
+
     vertexCount = count;
+    vertexStride = count > 0 ? size / count : 0;
 
-    glBindBuffer(GL_ARRAY_BUFFER, vboHandles[VBO_VERTICES]);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, vboHandles[VBO_VERTICES]);
     glBufferData(GL_ARRAY_BUFFER, size, data, isDynamic);
 }
 
 void Mesh::SetIndexData(IndexType::IndexType format, GLuint count, GLuint size, void* data) {
+    assert(arena == NULL);
+
     indexCount = count;
     indexFormat = format;
 
-    glBindBuffer(GL_ARRAY_BUFFER, vboHandles[VBO_INDICES]);
-    glBufferData(GL_ARRAY_BUFFER, size, data, isDynamic);
+    // The element array binding is stored in the vertex array object,
+    // so binding it here means Render only has to bind the vertex array
+    GLState::BindVertexArray(vaoHandle);
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, vboHandles[VBO_INDICES]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, isDynamic);
+}
+
+void Mesh::SetDynamicVertexData(GLuint count, GLuint size, void* data) {
+    assert(arena == NULL);
+
+    vertexCount = count;
+    vertexStride = count > 0 ? size / count : 0;
+    isDynamic = GL_STREAM_DRAW;
+
+    delete streamVertices;
+    streamVertices = new StreamBuffer(GL_ARRAY_BUFFER, size);
+
+    shadowVertices.assign((char*)data, (char*)data + size);
+
+    // Nothing has drawn from the new buffer yet, so every copy can be filled right away
+    for (GLuint i=0; i<FRAMES_IN_FLIGHT; ++i) {
+        void* dst = streamVertices->MapSegment(i, 0, size);
+        if (dst != NULL) {
+            memcpy(dst, data, size);
+            streamVertices->Unmap();
+        }
+
+        staleBegin[i] = staleEnd[i] = 0;
+    }
+
+    // Point the vertex array at the streaming buffer instead of our own
+    GLState::BindVertexArray(vaoHandle);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, streamVertices->GetHandle());
+
+    for (size_t i=0; i<vertexFormat.size(); ++i) {
+        const VertexAttributeBinding_t& attr = vertexFormat[i];
+        glVertexAttribPointer(attr.attrib, attr.size, attr.type, attr.normalized, attr.stride, attr.offset);
+    }
+}
+
+void Mesh::UpdateVertexData(GLuint first, GLuint count, const void* data) {
+    assert(streamVertices != NULL);
+    assert(first + count <= vertexCount);
+
+    GLuint begin = first * vertexStride;
+    GLuint end   = (first + count) * vertexStride;
+
+    memcpy(&shadowVertices[begin], data, end - begin);
+
+    // Every frame's copy is now missing these bytes
+    for (GLuint i=0; i<FRAMES_IN_FLIGHT; ++i) {
+        if (staleBegin[i] == staleEnd[i]) {
+            staleBegin[i] = begin;
+            staleEnd[i]   = end;
+        } else {
+            staleBegin[i] = std::min(staleBegin[i], begin);
+            staleEnd[i]   = std::max(staleEnd[i], end);
+        }
+    }
+}
+
+void Mesh::SyncStreamVertices() const {
+    GLuint frame = FrameSync::GetFrameIndex();
+
+    if (staleBegin[frame] == staleEnd[frame])
+        return;
+
+    streamVertices->Write(staleBegin[frame], staleEnd[frame] - staleBegin[frame], &shadowVertices[staleBegin[frame]]);
+    staleBegin[frame] = staleEnd[frame] = 0;
 }
 
 GLenum Mesh::Render() const {
-    glBindVertexArray(vaoHandle);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vboHandles[VBO_INDICES]);
+    if (arena != NULL) {
+        const ArenaAllocation_t& alloc = arena->GetAllocation(arenaHandle);
+
+        arena->Bind();
+        glDrawElementsBaseVertex(primitiveType, alloc.indexCount, indexFormat,
+            BUFFER_OFFSET(alloc.indexOffset * arena->GetIndexSize()), alloc.vertexOffset);
+
+        return 0;
+    }
+
+    GLState::BindVertexArray(vaoHandle);
+
+    if (streamVertices != NULL) {
+        SyncStreamVertices();
+
+        // Each frame's copy of the vertices follows the last, so
+        // offsetting the indices picks out this frame's
+        GLint baseVertex = FrameSync::GetFrameIndex() * vertexCount;
+        glDrawElementsBaseVertex(primitiveType, indexCount, indexFormat, 0, baseVertex);
+
+        return 0;
+    }
+
     glDrawElements(primitiveType, indexCount, indexFormat, 0);
 
     return 0;
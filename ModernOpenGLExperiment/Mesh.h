@@ -4,6 +4,9 @@
 #include <vector>
 
 #include "Rendering.h"
+#include "GLState.h"
+#include "StreamBuffer.h"
+#include "GeometryArena.h"
 
 // Mesh: Contains the actual vertex data for a model
 // also managed the lifetime of the attached vertex buffer object
@@ -19,6 +22,7 @@ private:
     GLuint indexCount;
     GLuint vertexCount;
     GLuint vertexSize;
+    GLuint vertexStride;
     
     IndexType::IndexType indexFormat;
     std::vector<VertexAttributeBinding_t> vertexFormat;
@@ -28,10 +32,36 @@ private:
     // OpenGL performance hint
     GLenum isDynamic;
 
+    // Dynamic meshes keep their vertices in a StreamBuffer rather than
+    // vboHandles[VBO_VERTICES], with a whole copy per frame in flight. Updates
+    // land in shadowVertices first, and each frame's copy catches up on the
+    // bytes it's missing the next time it gets drawn.
+    StreamBuffer* streamVertices;
+    std::vector<char> shadowVertices;
+    mutable GLuint staleBegin[FRAMES_IN_FLIGHT];
+    mutable GLuint staleEnd[FRAMES_IN_FLIGHT];
+
+    void SyncStreamVertices() const;
+
+    // Meshes living in a GeometryArena don't own any GL objects at all
+    GeometryArena* arena;
+    GLuint arenaHandle;
+
+    Mesh(PrimitiveType::PrimitiveType primitiveType, GeometryArena* arena, GLuint arenaHandle);
+
 public:
     Mesh(PrimitiveType::PrimitiveType primitiveType, VertexAttributeBinding_t* attribFormats, GLuint attribCount);
     ~Mesh();
 
+    /**
+     * CreateInArena
+     * Creates a mesh whose vertices and indices are suballocated from an arena shared with
+     * other meshes of the same vertex format, instead of having buffers of its own. Indices
+     * are relative to the mesh's first vertex, and must be of the arena's index type.
+     */
+    static Mesh* CreateInArena(GeometryArena* arena, PrimitiveType::PrimitiveType primitiveType,
+        GLuint vertexCount, const void* vertices, GLuint indexCount, const void* indices);
+
     /**
      * SetVertexData
      * Uploads the given vertex data to the vertex buffer associated with this mesh
@@ -52,7 +82,46 @@ public:
      */
     void SetIndexData(IndexType::IndexType indexFormat, GLuint count, GLuint size, void* data);
 
+    /**
+     * SetDynamicVertexData
+     * Like SetVertexData, but for vertices that will change over time. They're kept in a
+     * streaming buffer, so that changing them with UpdateVertexData never has to wait for
+     * the GPU to finish drawing with the old ones.
+     *
+     * count - The number of vertices
+     * size  - The actual size of the data to upload (in bytes)
+     * data  - Pointer to the data in memory
+     */
+    void SetDynamicVertexData(GLuint count, GLuint size, void* data);
+
+    /**
+     * UpdateVertexData
+     * Replaces a range of the vertices of a mesh set up with SetDynamicVertexData. Only
+     * the changed range gets uploaded. Updates have to come before the first time the
+     * mesh is rendered in a frame.
+     *
+     * first - Index of the first vertex to replace
+     * count - The number of vertices to replace
+     * data  - Pointer to the new vertices in memory
+     */
+    void UpdateVertexData(GLuint first, GLuint count, const void* data);
+
+    bool IsDynamic() const { return streamVertices != NULL; }
+
+    GeometryArena* GetArena() const { return arena; }
+    const ArenaAllocation_t& GetArenaAllocation() const { return arena->GetAllocation(arenaHandle); }
+
+    PrimitiveType::PrimitiveType GetPrimitiveType() const { return primitiveType; }
+
+    GLuint GetIndexCount() const { return indexCount; }
+
     GLenum Render() const;
+
+    /**
+     * GetHandle
+     * Returns the vertex array object that captures this mesh's vertex format
+     */
+    GLuint GetHandle() const { return arena != NULL ? arena->GetHandle() : vaoHandle; }
 };
 
 #endif
\ No newline at end of file
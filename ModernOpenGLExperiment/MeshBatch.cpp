@@ -0,0 +1,58 @@
+#include "MeshBatch.h"
+
+MeshBatch::MeshBatch(GeometryArena* arena, PrimitiveType::PrimitiveType primitiveType) :
+    arena(arena), primitiveType(primitiveType), generation(0), dirty(true) {
+
+    assert(arena != NULL);
+}
+
+void MeshBatch::Add(const Mesh* mesh) {
+    assert(mesh->GetArena() == arena);
+    assert(mesh->GetPrimitiveType() == primitiveType);
+
+    meshes.push_back(mesh);
+    dirty = true;
+}
+
+void MeshBatch::Rebuild() const {
+    size_t count = meshes.size();
+
+    counts.resize(count);
+    offsets.resize(count);
+    baseVertices.resize(count);
+
+    GLsizei indexSize = arena->GetIndexSize();
+
+    for (size_t i=0; i<count; ++i) {
+        const ArenaAllocation_t& alloc = meshes[i]->GetArenaAllocation();
+
+        counts[i]       = alloc.indexCount;
+        offsets[i]      = BUFFER_OFFSET(alloc.indexOffset * indexSize);
+        baseVertices[i] = alloc.vertexOffset;
+    }
+
+    generation = arena->GetGeneration();
+    dirty = false;
+}
+
+GLuint MeshBatch::GetIndexCount() const {
+    GLuint total = 0;
+    for (size_t i=0; i<meshes.size(); ++i)
+        total += meshes[i]->GetIndexCount();
+
+    return total;
+}
+
+GLenum MeshBatch::Render() const {
+    if (meshes.empty())
+        return 0;
+
+    if (dirty || generation != arena->GetGeneration())
+        Rebuild();
+
+    arena->Bind();
+    glMultiDrawElementsBaseVertex(primitiveType, &counts[0], arena->GetIndexFormat(),
+        &offsets[0], (GLsizei)meshes.size(), &baseVertices[0]);
+
+    return 0;
+}
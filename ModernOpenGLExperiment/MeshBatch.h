@@ -0,0 +1,66 @@
+#ifndef MESHBATCH_H
+#define MESHBATCH_H
+
+#include <vector>
+
+#include "Rendering.h"
+#include "GeometryArena.h"
+#include "Mesh.h"
+
+/**
+ * MeshBatch
+ * A set of meshes from the same GeometryArena, drawn together with a single
+ * glMultiDrawElementsBaseVertex call. The count, offset and base vertex arrays are
+ * built once up front, and only rebuilt if the arena moves its allocations around.
+ *
+ * Everything in the batch is drawn with the same program, textures and uniforms,
+ * so only meshes that would have been drawn with the same state belong together.
+ */
+class MeshBatch {
+private:
+    GeometryArena* arena;
+    PrimitiveType::PrimitiveType primitiveType;
+
+    std::vector<const Mesh*> meshes;
+
+    // Draw arguments, one entry per mesh
+    mutable std::vector<GLsizei> counts;
+    mutable std::vector<const GLvoid*> offsets;
+    mutable std::vector<GLint> baseVertices;
+
+    // Arena generation the draw arguments were built against
+    mutable GLuint generation;
+    mutable bool dirty;
+
+    void Rebuild() const;
+
+public:
+    MeshBatch(GeometryArena* arena, PrimitiveType::PrimitiveType primitiveType);
+
+    /**
+     * Add
+     * Adds a mesh to the batch. The mesh has to live in the batch's arena and
+     * have the same primitive type, and must outlive the batch.
+     */
+    void Add(const Mesh* mesh);
+
+    GLenum Render() const;
+
+    size_t GetSize() const { return meshes.size(); }
+
+    PrimitiveType::PrimitiveType GetPrimitiveType() const { return primitiveType; }
+
+    /**
+     * GetIndexCount
+     * Returns how many indices a Render draws, over every mesh in the batch
+     */
+    GLuint GetIndexCount() const;
+
+    /**
+     * GetHandle
+     * Returns the vertex array object shared by every mesh in the batch
+     */
+    GLuint GetHandle() const { return arena->GetHandle(); }
+};
+
+#endif
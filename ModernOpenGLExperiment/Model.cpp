@@ -1 +1,24 @@
 #include "Model.h"
+
+Model::Model(GeometryArena* arena) :
+    arena(arena), allSurfaces(arena, PrimitiveType::TrianglesPrimitive) {
+}
+
+Model::~Model() {
+    for (size_t i=0; i<textureBatches.size(); ++i)
+        delete textureBatches[i];
+}
+
+void Model::AddSurface(const Mesh* mesh, Texture* texture) {
+    size_t batch = 0;
+    while (batch < batchTextures.size() && batchTextures[batch] != texture)
+        ++batch;
+
+    if (batch == batchTextures.size()) {
+        textureBatches.push_back(new MeshBatch(arena, PrimitiveType::TrianglesPrimitive));
+        batchTextures.push_back(texture);
+    }
+
+    textureBatches[batch]->Add(mesh);
+    allSurfaces.Add(mesh);
+}
@@ -1,21 +1,37 @@
 #ifndef MODEL_H
 #define MODEL_H
 
+#include <vector>
+
 #include "Mesh.h"
-#include "Program.h"
+#include "MeshBatch.h"
+#include "Texture.h"
 #include "Rendering.h"
 
-// Model: Contains a mesh and a program
+// Model: The surfaces of a model, each a mesh in a shared GeometryArena with a texture.
+// Surfaces that share a texture are grouped into one MeshBatch so that they can be drawn
+// with a single call; a second batch holds every surface, for passes that don't texture.
+// Doesn't own the meshes or the textures.
 class Model {
 private:
-    Mesh* mesh;
-    Program* program;
+    GeometryArena* arena;
+
+    std::vector<MeshBatch*> textureBatches;
+    std::vector<Texture*> batchTextures;
 
-    Model() : mesh(NULL), program(NULL) {}
-    ~Model() {}
+    MeshBatch allSurfaces;
 
 public:
-    void Render() const;
+    Model(GeometryArena* arena);
+    ~Model();
+
+    void AddSurface(const Mesh* mesh, Texture* texture);
+
+    size_t GetTextureBatchCount() const { return textureBatches.size(); }
+    MeshBatch* GetTextureBatch(size_t i) const { return textureBatches[i]; }
+    Texture* GetBatchTexture(size_t i) const { return batchTextures[i]; }
+
+    MeshBatch* GetAllSurfaces() { return &allSurfaces; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -17,6 +17,8 @@ protected:
     ModelLoader() {}
 
 public:
+    virtual ~ModelLoader() {}
+
     /**
      * Whether or not the loaded file is valid or not
      * The outputs of the other functions are undefined if this is false
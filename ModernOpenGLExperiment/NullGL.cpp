@@ -0,0 +1,1208 @@
+#include "NullGL.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <string>
+
+// Limits reported to anyone who asks
+#define NULLGL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 256
+#define NULLGL_MAX_TEXTURE_UNITS               16
+#define NULLGL_MAX_UNIFORM_BUFFER_BINDINGS     36
+#define NULLGL_MAX_UNIFORM_BLOCK_SIZE          65536
+#define NULLGL_MAX_TEXTURE_SIZE                16384
+#define NULLGL_MAX_VERTEX_ATTRIBS              16
+
+static uint64_t callCounts[GLFunction::Count];
+
+#define COUNT_CALL(function) ++callCounts[GLFunction::function]
+
+/*
+ * Catch-all stubs, one per arity, that count the call and return 0. The function
+ * pointers have to be filled with functions of exactly the right type, since GL entry
+ * points are __stdcall on 32-bit Windows and the callee pops its own arguments.
+ */
+
+template <int F, typename R>
+R CODEGEN_FUNCPTR Stub0() { ++callCounts[F]; return R(); }
+
+template <int F, typename R>
+void Bind(R (CODEGEN_FUNCPTR*& function)()) { function = &Stub0<F, R>; }
+
+template <int F, typename R, typename A1>
+R CODEGEN_FUNCPTR Stub1(A1) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1)) { function = &Stub1<F, R, A1>; }
+
+template <int F, typename R, typename A1, typename A2>
+R CODEGEN_FUNCPTR Stub2(A1, A2) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1, typename A2>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1, A2)) { function = &Stub2<F, R, A1, A2>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3>
+R CODEGEN_FUNCPTR Stub3(A1, A2, A3) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1, typename A2, typename A3>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3)) { function = &Stub3<F, R, A1, A2, A3>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4>
+R CODEGEN_FUNCPTR Stub4(A1, A2, A3, A4) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4)) { function = &Stub4<F, R, A1, A2, A3, A4>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5>
+R CODEGEN_FUNCPTR Stub5(A1, A2, A3, A4, A5) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5)) { function = &Stub5<F, R, A1, A2, A3, A4, A5>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+R CODEGEN_FUNCPTR Stub6(A1, A2, A3, A4, A5, A6) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6)) { function = &Stub6<F, R, A1, A2, A3, A4, A5, A6>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+R CODEGEN_FUNCPTR Stub7(A1, A2, A3, A4, A5, A6, A7) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7)) { function = &Stub7<F, R, A1, A2, A3, A4, A5, A6, A7>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+R CODEGEN_FUNCPTR Stub8(A1, A2, A3, A4, A5, A6, A7, A8) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8)) { function = &Stub8<F, R, A1, A2, A3, A4, A5, A6, A7, A8>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+R CODEGEN_FUNCPTR Stub9(A1, A2, A3, A4, A5, A6, A7, A8, A9) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8, A9)) { function = &Stub9<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+R CODEGEN_FUNCPTR Stub10(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10)) { function = &Stub10<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10>; }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+R CODEGEN_FUNCPTR Stub11(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11) { ++callCounts[F]; return R(); }
+
+template <int F, typename R, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+void Bind(R (CODEGEN_FUNCPTR*& function)(A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11)) { function = &Stub11<F, R, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11>; }
+/*
+ * Emulated objects
+ */
+
+typedef struct {
+    GLenum type;
+    std::string source;
+} NullShader_t;
+
+typedef struct {
+    std::string name;
+    GLenum type;
+    GLint size;
+    GLint location; // -1 for uniform block members and unused attributes
+} NullVariable_t;
+
+typedef struct {
+    std::string name;
+    GLint dataSize;
+    GLuint binding;
+} NullUniformBlock_t;
+
+typedef struct {
+    std::vector<GLuint> shaders;
+
+    std::vector<NullVariable_t> uniforms;
+    std::vector<NullUniformBlock_t> uniformBlocks;
+    std::vector<NullVariable_t> attributes;
+} NullProgram_t;
+
+typedef struct {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+} NullBufferRange_t;
+
+// Names are handed out from one counter for every kind of object
+static GLuint nextName = 1;
+static uintptr_t nextSync = 1;
+
+static std::map<GLuint, NullShader_t> shaders;
+static std::map<GLuint, NullProgram_t> programs;
+static std::map<GLuint, std::vector<char> > buffers;
+
+// Element array binding of each vertex array, including the default one
+static std::map<GLuint, GLuint> elementArrayBindings;
+
+// All other buffer bindings, by target
+static std::map<GLenum, GLuint> bufferBindings;
+static NullBufferRange_t uniformBufferBindings[NULLGL_MAX_UNIFORM_BUFFER_BINDINGS];
+
+static GLuint currentProgram = 0;
+static GLuint currentVertexArray = 0;
+static GLuint activeTexture = 0;
+static GLuint textureBindings[NULLGL_MAX_TEXTURE_UNITS];
+
+static void GenNames(GLsizei n, GLuint* names) {
+    for (GLsizei i=0; i<n; ++i)
+        names[i] = nextName++;
+}
+
+static void CopyName(const std::string& name, GLsizei bufSize, GLsizei* length, GLchar* out) {
+    GLsizei copied = 0;
+
+    if (bufSize > 0) {
+        copied = std::min((GLsizei)name.size(), bufSize - 1);
+        memcpy(out, name.c_str(), copied);
+        out[copied] = '\0';
+    }
+
+    if (length != NULL)
+        *length = copied;
+}
+
+static GLint GetMaxNameLength(const std::vector<NullVariable_t>& variables) {
+    GLint length = 0;
+    for (size_t i=0; i<variables.size(); ++i)
+        length = std::max(length, (GLint)variables[i].name.size() + 1);
+
+    return length;
+}
+
+static GLuint* GetBufferBinding(GLenum target) {
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+        return &elementArrayBindings[currentVertexArray];
+
+    return &bufferBindings[target];
+}
+
+static std::vector<char>* GetBoundStorage(GLenum target) {
+    auto it = buffers.find(*GetBufferBinding(target));
+    return it != buffers.end() ? &it->second : NULL;
+}
+
+/*
+ * GLSL reflection
+ *
+ * Only declarations at global scope are looked at, and only as much as introspection
+ * needs: uniforms, uniform blocks with their std140 sizes, and vertex shader inputs.
+ */
+
+typedef struct {
+    const char* name;
+    GLenum type;
+    GLint size;      // std140 size and alignment; 0 for opaque types
+    GLint alignment;
+} GLSLType_t;
+
+static const GLSLType_t GLSL_TYPES[] = {
+    {"float",           GL_FLOAT,             4,  4},
+    {"vec2",            GL_FLOAT_VEC2,        8,  8},
+    {"vec3",            GL_FLOAT_VEC3,        12, 16},
+    {"vec4",            GL_FLOAT_VEC4,        16, 16},
+    {"int",             GL_INT,               4,  4},
+    {"ivec2",           GL_INT_VEC2,          8,  8},
+    {"ivec3",           GL_INT_VEC3,          12, 16},
+    {"ivec4",           GL_INT_VEC4,          16, 16},
+    {"uint",            GL_UNSIGNED_INT,      4,  4},
+    {"bool",            GL_BOOL,              4,  4},
+    {"mat2",            GL_FLOAT_MAT2,        32, 16},
+    {"mat3",            GL_FLOAT_MAT3,        48, 16},
+    {"mat4",            GL_FLOAT_MAT4,        64, 16},
+    {"sampler2D",       GL_SAMPLER_2D,        0,  0},
+    {"sampler3D",       GL_SAMPLER_3D,        0,  0},
+    {"samplerCube",     GL_SAMPLER_CUBE,      0,  0},
+    {"sampler2DShadow", GL_SAMPLER_2D_SHADOW, 0,  0},
+    {"sampler2DArray",  GL_SAMPLER_2D_ARRAY,  0,  0}
+};
+
+// Anything we don't know is treated as a vec4
+static const GLSLType_t& GetGLSLType(const std::string& name) {
+    size_t count = sizeof(GLSL_TYPES) / sizeof(GLSL_TYPES[0]);
+
+    for (size_t i=0; i<count; ++i)
+        if (name == GLSL_TYPES[i].name)
+            return GLSL_TYPES[i];
+
+    return GLSL_TYPES[3];
+}
+
+static bool IsQualifier(const std::string& token) {
+    static const char* QUALIFIERS[] = {
+        "const", "flat", "smooth", "noperspective", "centroid", "invariant",
+        "highp", "mediump", "lowp", "out", "attribute", "varying"
+    };
+
+    for (size_t i=0; i<sizeof(QUALIFIERS)/sizeof(QUALIFIERS[0]); ++i)
+        if (token == QUALIFIERS[i])
+            return true;
+
+    return false;
+}
+
+// Splits source into identifiers, numbers and single punctuation characters,
+// dropping comments and preprocessor lines
+static void Tokenize(const std::string& source, std::vector<std::string>& tokens) {
+    size_t i = 0, n = source.size();
+    bool lineStart = true;
+
+    while (i < n) {
+        char c = source[i];
+
+        if (c == '\n') {
+            lineStart = true;
+            ++i;
+        } else if (isspace((unsigned char)c)) {
+            ++i;
+        } else if (c == '#' && lineStart) {
+            while (i < n && source[i] != '\n')
+                ++i;
+        } else if (c == '/' && i+1 < n && source[i+1] == '/') {
+            while (i < n && source[i] != '\n')
+                ++i;
+        } else if (c == '/' && i+1 < n && source[i+1] == '*') {
+            size_t end = source.find("*/", i+2);
+            i = end == std::string::npos ? n : end + 2;
+        } else if (isalnum((unsigned char)c) || c == '_') {
+            size_t start = i;
+            while (i < n && (isalnum((unsigned char)source[i]) || source[i] == '_' || source[i] == '.'))
+                ++i;
+
+            tokens.push_back(source.substr(start, i - start));
+            lineStart = false;
+        } else {
+            tokens.push_back(std::string(1, c));
+            lineStart = false;
+            ++i;
+        }
+    }
+}
+
+typedef struct {
+    std::string type;
+    std::string name;
+    GLint arraySize; // 0 if not an array
+} GLSLDeclaration_t;
+
+// Reads "type name[N], name2;" starting at i, leaving i past the semicolon
+static void ReadDeclarators(const std::vector<std::string>& tokens, size_t& i, std::vector<GLSLDeclaration_t>& out) {
+    while (i < tokens.size() && (IsQualifier(tokens[i]) || tokens[i] == "layout")) {
+        if (tokens[i] == "layout") {
+            while (i < tokens.size() && tokens[i] != ")")
+                ++i;
+        }
+        ++i;
+    }
+
+    if (i >= tokens.size())
+        return;
+
+    std::string type = tokens[i++];
+
+    while (i < tokens.size() && tokens[i] != ";") {
+        if (tokens[i] == ",") {
+            ++i;
+            continue;
+        }
+
+        GLSLDeclaration_t declaration = {type, tokens[i++], 0};
+
+        if (i < tokens.size() && tokens[i] == "[") {
+            declaration.arraySize = 1;
+            if (i+1 < tokens.size() && isdigit((unsigned char)tokens[i+1][0]))
+                declaration.arraySize = atoi(tokens[i+1].c_str());
+
+            while (i < tokens.size() && tokens[i] != "]")
+                ++i;
+            ++i;
+        }
+
+        out.push_back(declaration);
+    }
+
+    ++i;
+}
+
+// Reads the members of a block whose opening brace is at i, leaving i past the closing brace
+static void ReadBlockMembers(const std::vector<std::string>& tokens, size_t& i, std::vector<GLSLDeclaration_t>& out) {
+    ++i;
+    while (i < tokens.size() && tokens[i] != "}")
+        ReadDeclarators(tokens, i, out);
+
+    ++i;
+}
+
+static GLint GetStd140Size(const std::vector<GLSLDeclaration_t>& members) {
+    GLint offset = 0;
+
+    for (size_t i=0; i<members.size(); ++i) {
+        const GLSLType_t& type = GetGLSLType(members[i].type);
+
+        GLint alignment = type.alignment;
+        GLint size = type.size;
+
+        // Array elements are padded out to a vec4 each
+        if (members[i].arraySize > 0) {
+            alignment = 16;
+            size = ((size + 15) & ~15) * members[i].arraySize;
+        }
+
+        offset = (offset + alignment - 1) / alignment * alignment + size;
+    }
+
+    return (offset + 15) & ~15;
+}
+
+static NullVariable_t* FindVariable(std::vector<NullVariable_t>& variables, const std::string& name) {
+    for (size_t i=0; i<variables.size(); ++i)
+        if (variables[i].name == name)
+            return &variables[i];
+
+    return NULL;
+}
+
+static void AddVariable(std::vector<NullVariable_t>& variables, const GLSLDeclaration_t& declaration,
+    const std::string& prefix, GLint location) {
+
+    NullVariable_t variable = {
+        prefix + declaration.name + (declaration.arraySize > 0 ? "[0]" : ""),
+        GetGLSLType(declaration.type).type,
+        std::max(declaration.arraySize, 1),
+        location
+    };
+
+    // The same uniform can be declared in several stages
+    if (FindVariable(variables, variable.name) == NULL)
+        variables.push_back(variable);
+}
+
+static void ReflectShader(NullProgram_t& program, const NullShader_t& shader, GLint& nextLocation) {
+    std::vector<std::string> tokens;
+    Tokenize(shader.source, tokens);
+
+    size_t i = 0;
+    while (i < tokens.size()) {
+        // Skip past layout qualifiers and work out what's being declared
+        bool isUniform = false, isInput = false;
+        size_t start = i;
+
+        while (i < tokens.size()) {
+            if (tokens[i] == "layout") {
+                while (i < tokens.size() && tokens[i] != ")")
+                    ++i;
+                ++i;
+            } else if (tokens[i] == "uniform") {
+                isUniform = true;
+                ++i;
+            } else if (tokens[i] == "in") {
+                isInput = true;
+                ++i;
+            } else if (IsQualifier(tokens[i])) {
+                ++i;
+            } else {
+                break;
+            }
+        }
+
+        bool isAttribute = isInput && shader.type == GL_VERTEX_SHADER;
+        bool isBlock = i+1 < tokens.size() && tokens[i+1] == "{";
+
+        if ((isUniform || isAttribute) && isBlock) {
+            std::string blockName = tokens[i];
+            i += 1;
+
+            std::vector<GLSLDeclaration_t> members;
+            ReadBlockMembers(tokens, i, members);
+
+            // Members of named instances are reflected as "Block.member"
+            std::string prefix;
+            if (i < tokens.size() && tokens[i] != ";")
+                prefix = blockName + ".";
+
+            while (i < tokens.size() && tokens[i] != ";")
+                ++i;
+            ++i;
+
+            if (isUniform) {
+                NullUniformBlock_t block = {blockName, GetStd140Size(members), 0};
+
+                bool known = false;
+                for (size_t j=0; j<program.uniformBlocks.size(); ++j)
+                    known |= program.uniformBlocks[j].name == blockName;
+
+                if (!known)
+                    program.uniformBlocks.push_back(block);
+
+                for (size_t j=0; j<members.size(); ++j)
+                    AddVariable(program.uniforms, members[j], prefix, -1);
+            } else {
+                for (size_t j=0; j<members.size(); ++j)
+                    AddVariable(program.attributes, members[j], "", (GLint)program.attributes.size());
+            }
+        } else if (isUniform || isAttribute) {
+            std::vector<GLSLDeclaration_t> declarations;
+            ReadDeclarators(tokens, i, declarations);
+
+            for (size_t j=0; j<declarations.size(); ++j) {
+                if (isUniform) {
+                    AddVariable(program.uniforms, declarations[j], "", nextLocation);
+                    nextLocation += std::max(declarations[j].arraySize, 1);
+                } else {
+                    AddVariable(program.attributes, declarations[j], "", (GLint)program.attributes.size());
+                }
+            }
+        } else {
+            // Anything else, skipping over function bodies and other blocks whole
+            while (i < tokens.size() && tokens[i] != ";" && tokens[i] != "{")
+                ++i;
+
+            if (i < tokens.size() && tokens[i] == "{") {
+                int depth = 0;
+                do {
+                    if (tokens[i] == "{") ++depth;
+                    if (tokens[i] == "}") --depth;
+                    ++i;
+                } while (i < tokens.size() && depth > 0);
+            } else {
+                ++i;
+            }
+        }
+
+        // Never get stuck on something we couldn't make sense of
+        if (i == start)
+            ++i;
+    }
+}
+
+/*
+ * Entry points that need to do more than count
+ */
+
+static void CODEGEN_FUNCPTR NullGenBuffers(GLsizei n, GLuint* names) {
+    COUNT_CALL(glGenBuffers);
+    GenNames(n, names);
+
+    for (GLsizei i=0; i<n; ++i)
+        buffers[names[i]];
+}
+
+static void CODEGEN_FUNCPTR NullDeleteBuffers(GLsizei n, const GLuint* names) {
+    COUNT_CALL(glDeleteBuffers);
+
+    for (GLsizei i=0; i<n; ++i) {
+        if (names[i] == 0)
+            continue;
+
+        buffers.erase(names[i]);
+
+        for (auto it=bufferBindings.begin(); it!=bufferBindings.end(); ++it)
+            if (it->second == names[i])
+                it->second = 0;
+
+        // Only unbound from the current vertex array
+        if (elementArrayBindings[currentVertexArray] == names[i])
+            elementArrayBindings[currentVertexArray] = 0;
+
+        for (GLuint j=0; j<NULLGL_MAX_UNIFORM_BUFFER_BINDINGS; ++j)
+            if (uniformBufferBindings[j].buffer == names[i])
+                uniformBufferBindings[j].buffer = 0;
+    }
+}
+
+static void CODEGEN_FUNCPTR NullBindBuffer(GLenum target, GLuint buffer) {
+    COUNT_CALL(glBindBuffer);
+    *GetBufferBinding(target) = buffer;
+}
+
+static void CODEGEN_FUNCPTR NullBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    COUNT_CALL(glBindBufferRange);
+
+    *GetBufferBinding(target) = buffer;
+
+    if (target == GL_UNIFORM_BUFFER && index < NULLGL_MAX_UNIFORM_BUFFER_BINDINGS) {
+        NullBufferRange_t range = {buffer, offset, size};
+        uniformBufferBindings[index] = range;
+    }
+}
+
+static void CODEGEN_FUNCPTR NullBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    COUNT_CALL(glBindBufferBase);
+
+    *GetBufferBinding(target) = buffer;
+
+    if (target == GL_UNIFORM_BUFFER && index < NULLGL_MAX_UNIFORM_BUFFER_BINDINGS) {
+        NullBufferRange_t range = {buffer, 0, 0};
+        uniformBufferBindings[index] = range;
+    }
+}
+
+static void CODEGEN_FUNCPTR NullBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum) {
+    COUNT_CALL(glBufferData);
+
+    std::vector<char>* storage = GetBoundStorage(target);
+    if (storage == NULL)
+        return;
+
+    storage->assign(size, 0);
+    if (data != NULL && size > 0)
+        memcpy(&(*storage)[0], data, size);
+}
+
+static void CODEGEN_FUNCPTR NullBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data) {
+    COUNT_CALL(glBufferSubData);
+
+    std::vector<char>* storage = GetBoundStorage(target);
+    if (storage != NULL && data != NULL && size > 0 && offset + size <= (GLintptr)storage->size())
+        memcpy(&(*storage)[offset], data, size);
+}
+
+static void CODEGEN_FUNCPTR NullCopyBufferSubData(GLenum readTarget, GLenum writeTarget,
+    GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) {
+
+    COUNT_CALL(glCopyBufferSubData);
+
+    std::vector<char>* source = GetBoundStorage(readTarget);
+    std::vector<char>* dest   = GetBoundStorage(writeTarget);
+
+    if (source != NULL && dest != NULL && size > 0 &&
+        readOffset  + size <= (GLintptr)source->size() &&
+        writeOffset + size <= (GLintptr)dest->size()) {
+
+        memmove(&(*dest)[writeOffset], &(*source)[readOffset], size);
+    }
+}
+
+static GLvoid* CODEGEN_FUNCPTR NullMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield) {
+    COUNT_CALL(glMapBufferRange);
+
+    std::vector<char>* storage = GetBoundStorage(target);
+    if (storage == NULL || storage->empty() || offset + length > (GLintptr)storage->size())
+        return NULL;
+
+    return &(*storage)[offset];
+}
+
+static GLvoid* CODEGEN_FUNCPTR NullMapBuffer(GLenum target, GLenum) {
+    COUNT_CALL(glMapBuffer);
+
+    std::vector<char>* storage = GetBoundStorage(target);
+    return storage != NULL && !storage->empty() ? &(*storage)[0] : NULL;
+}
+
+static GLboolean CODEGEN_FUNCPTR NullUnmapBuffer(GLenum) {
+    COUNT_CALL(glUnmapBuffer);
+    return GL_TRUE;
+}
+
+static void CODEGEN_FUNCPTR NullGetBufferParameteriv(GLenum target, GLenum pname, GLint* params) {
+    COUNT_CALL(glGetBufferParameteriv);
+
+    std::vector<char>* storage = GetBoundStorage(target);
+    *params = pname == GL_BUFFER_SIZE && storage != NULL ? (GLint)storage->size() : 0;
+}
+
+static void CODEGEN_FUNCPTR NullGenVertexArrays(GLsizei n, GLuint* names) {
+    COUNT_CALL(glGenVertexArrays);
+    GenNames(n, names);
+}
+
+static void CODEGEN_FUNCPTR NullDeleteVertexArrays(GLsizei n, const GLuint* names) {
+    COUNT_CALL(glDeleteVertexArrays);
+
+    for (GLsizei i=0; i<n; ++i) {
+        if (names[i] == 0)
+            continue;
+
+        elementArrayBindings.erase(names[i]);
+        if (currentVertexArray == names[i])
+            currentVertexArray = 0;
+    }
+}
+
+static void CODEGEN_FUNCPTR NullBindVertexArray(GLuint vertexArray) {
+    COUNT_CALL(glBindVertexArray);
+    currentVertexArray = vertexArray;
+}
+
+static void CODEGEN_FUNCPTR NullGenTextures(GLsizei n, GLuint* names) {
+    COUNT_CALL(glGenTextures);
+    GenNames(n, names);
+}
+
+static void CODEGEN_FUNCPTR NullDeleteTextures(GLsizei n, const GLuint* names) {
+    COUNT_CALL(glDeleteTextures);
+
+    for (GLsizei i=0; i<n; ++i)
+        for (GLuint j=0; j<NULLGL_MAX_TEXTURE_UNITS; ++j)
+            if (names[i] != 0 && textureBindings[j] == names[i])
+                textureBindings[j] = 0;
+}
+
+static void CODEGEN_FUNCPTR NullActiveTexture(GLenum texture) {
+    COUNT_CALL(glActiveTexture);
+
+    if (texture - GL_TEXTURE0 < NULLGL_MAX_TEXTURE_UNITS)
+        activeTexture = texture - GL_TEXTURE0;
+}
+
+static void CODEGEN_FUNCPTR NullBindTexture(GLenum target, GLuint texture) {
+    COUNT_CALL(glBindTexture);
+
+    if (target == GL_TEXTURE_2D)
+        textureBindings[activeTexture] = texture;
+}
+
+static void CODEGEN_FUNCPTR NullGenQueries(GLsizei n, GLuint* names) {
+    COUNT_CALL(glGenQueries);
+    GenNames(n, names);
+}
+
+static void CODEGEN_FUNCPTR NullGenFramebuffers(GLsizei n, GLuint* names) {
+    COUNT_CALL(glGenFramebuffers);
+    GenNames(n, names);
+}
+
+static void CODEGEN_FUNCPTR NullGenRenderbuffers(GLsizei n, GLuint* names) {
+    COUNT_CALL(glGenRenderbuffers);
+    GenNames(n, names);
+}
+
+static void CODEGEN_FUNCPTR NullGenSamplers(GLsizei n, GLuint* names) {
+    COUNT_CALL(glGenSamplers);
+    GenNames(n, names);
+}
+
+static GLenum CODEGEN_FUNCPTR NullCheckFramebufferStatus(GLenum) {
+    COUNT_CALL(glCheckFramebufferStatus);
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+static void CODEGEN_FUNCPTR NullGetQueryObjectiv(GLuint, GLenum pname, GLint* params) {
+    COUNT_CALL(glGetQueryObjectiv);
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+static void CODEGEN_FUNCPTR NullGetQueryObjectuiv(GLuint, GLenum pname, GLuint* params) {
+    COUNT_CALL(glGetQueryObjectuiv);
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+static void CODEGEN_FUNCPTR NullGetQueryObjecti64v(GLuint, GLenum pname, GLint64* params) {
+    COUNT_CALL(glGetQueryObjecti64v);
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+static void CODEGEN_FUNCPTR NullGetQueryObjectui64v(GLuint, GLenum pname, GLuint64* params) {
+    COUNT_CALL(glGetQueryObjectui64v);
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+static GLsync CODEGEN_FUNCPTR NullFenceSync(GLenum, GLbitfield) {
+    COUNT_CALL(glFenceSync);
+    return (GLsync)nextSync++;
+}
+
+static GLenum CODEGEN_FUNCPTR NullClientWaitSync(GLsync, GLbitfield, GLuint64) {
+    COUNT_CALL(glClientWaitSync);
+    return GL_ALREADY_SIGNALED;
+}
+
+static GLboolean CODEGEN_FUNCPTR NullIsSync(GLsync sync) {
+    COUNT_CALL(glIsSync);
+    return sync != 0 ? GL_TRUE : GL_FALSE;
+}
+
+static void CODEGEN_FUNCPTR NullGetSynciv(GLsync, GLenum pname, GLsizei bufSize, GLsizei* length, GLint* values) {
+    COUNT_CALL(glGetSynciv);
+
+    if (bufSize > 0)
+        values[0] = pname == GL_SYNC_STATUS ? GL_SIGNALED : 0;
+
+    if (length != NULL)
+        *length = bufSize > 0 ? 1 : 0;
+}
+
+static GLuint CODEGEN_FUNCPTR NullCreateShader(GLenum type) {
+    COUNT_CALL(glCreateShader);
+
+    GLuint name = nextName++;
+    shaders[name].type = type;
+
+    return name;
+}
+
+static void CODEGEN_FUNCPTR NullDeleteShader(GLuint shader) {
+    COUNT_CALL(glDeleteShader);
+    shaders.erase(shader);
+}
+
+static void CODEGEN_FUNCPTR NullShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths) {
+    COUNT_CALL(glShaderSource);
+
+    auto it = shaders.find(shader);
+    if (it == shaders.end())
+        return;
+
+    it->second.source.clear();
+    for (GLsizei i=0; i<count; ++i) {
+        if (lengths != NULL && lengths[i] >= 0)
+            it->second.source.append(strings[i], lengths[i]);
+        else
+            it->second.source.append(strings[i]);
+    }
+}
+
+static void CODEGEN_FUNCPTR NullGetShaderiv(GLuint shader, GLenum pname, GLint* params) {
+    COUNT_CALL(glGetShaderiv);
+
+    auto it = shaders.find(shader);
+
+    switch (pname) {
+        case GL_COMPILE_STATUS:       *params = GL_TRUE; break;
+        case GL_INFO_LOG_LENGTH:      *params = 1; break;
+        case GL_SHADER_TYPE:          *params = it != shaders.end() ? it->second.type : 0; break;
+        case GL_SHADER_SOURCE_LENGTH: *params = it != shaders.end() ? (GLint)it->second.source.size() + 1 : 0; break;
+        default:                      *params = 0;
+    }
+}
+
+static void CODEGEN_FUNCPTR NullGetShaderInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+    COUNT_CALL(glGetShaderInfoLog);
+    CopyName("", bufSize, length, infoLog);
+}
+
+static GLuint CODEGEN_FUNCPTR NullCreateProgram() {
+    COUNT_CALL(glCreateProgram);
+
+    GLuint name = nextName++;
+    programs[name];
+
+    return name;
+}
+
+static void CODEGEN_FUNCPTR NullDeleteProgram(GLuint program) {
+    COUNT_CALL(glDeleteProgram);
+
+    programs.erase(program);
+    if (currentProgram == program)
+        currentProgram = 0;
+}
+
+static void CODEGEN_FUNCPTR NullAttachShader(GLuint program, GLuint shader) {
+    COUNT_CALL(glAttachShader);
+
+    auto it = programs.find(program);
+    if (it != programs.end())
+        it->second.shaders.push_back(shader);
+}
+
+static void CODEGEN_FUNCPTR NullDetachShader(GLuint program, GLuint shader) {
+    COUNT_CALL(glDetachShader);
+
+    auto it = programs.find(program);
+    if (it == programs.end())
+        return;
+
+    std::vector<GLuint>& attached = it->second.shaders;
+    attached.erase(std::remove(attached.begin(), attached.end(), shader), attached.end());
+}
+
+static void CODEGEN_FUNCPTR NullLinkProgram(GLuint program) {
+    COUNT_CALL(glLinkProgram);
+
+    auto it = programs.find(program);
+    if (it == programs.end())
+        return;
+
+    NullProgram_t& linked = it->second;
+    linked.uniforms.clear();
+    linked.uniformBlocks.clear();
+    linked.attributes.clear();
+
+    GLint nextLocation = 0;
+    for (size_t i=0; i<linked.shaders.size(); ++i) {
+        auto shader = shaders.find(linked.shaders[i]);
+        if (shader != shaders.end())
+            ReflectShader(linked, shader->second, nextLocation);
+    }
+}
+
+static void CODEGEN_FUNCPTR NullUseProgram(GLuint program) {
+    COUNT_CALL(glUseProgram);
+    currentProgram = program;
+}
+
+static void CODEGEN_FUNCPTR NullGetProgramiv(GLuint program, GLenum pname, GLint* params) {
+    COUNT_CALL(glGetProgramiv);
+
+    auto it = programs.find(program);
+    if (it == programs.end()) {
+        *params = 0;
+        return;
+    }
+
+    const NullProgram_t& linked = it->second;
+
+    switch (pname) {
+        case GL_LINK_STATUS:
+        case GL_VALIDATE_STATUS:
+            *params = GL_TRUE;
+            break;
+
+        case GL_INFO_LOG_LENGTH:            *params = 1; break;
+        case GL_ATTACHED_SHADERS:           *params = (GLint)linked.shaders.size(); break;
+        case GL_ACTIVE_UNIFORMS:            *params = (GLint)linked.uniforms.size(); break;
+        case GL_ACTIVE_UNIFORM_MAX_LENGTH:  *params = GetMaxNameLength(linked.uniforms); break;
+        case GL_ACTIVE_ATTRIBUTES:          *params = (GLint)linked.attributes.size(); break;
+        case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH: *params = GetMaxNameLength(linked.attributes); break;
+        case GL_ACTIVE_UNIFORM_BLOCKS:      *params = (GLint)linked.uniformBlocks.size(); break;
+
+        case GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH: {
+            GLint length = 0;
+            for (size_t i=0; i<linked.uniformBlocks.size(); ++i)
+                length = std::max(length, (GLint)linked.uniformBlocks[i].name.size() + 1);
+
+            *params = length;
+            break;
+        }
+
+        default:
+            *params = 0;
+    }
+}
+
+static void CODEGEN_FUNCPTR NullGetProgramInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+    COUNT_CALL(glGetProgramInfoLog);
+    CopyName("", bufSize, length, infoLog);
+}
+
+static void CODEGEN_FUNCPTR NullGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize,
+    GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
+
+    COUNT_CALL(glGetActiveUniform);
+
+    auto it = programs.find(program);
+    if (it == programs.end() || index >= it->second.uniforms.size()) {
+        CopyName("", bufSize, length, name);
+        return;
+    }
+
+    const NullVariable_t& uniform = it->second.uniforms[index];
+    CopyName(uniform.name, bufSize, length, name);
+    *size = uniform.size;
+    *type = uniform.type;
+}
+
+static GLint CODEGEN_FUNCPTR NullGetUniformLocation(GLuint program, const GLchar* name) {
+    COUNT_CALL(glGetUniformLocation);
+
+    auto it = programs.find(program);
+    if (it == programs.end())
+        return -1;
+
+    // Arrays can be looked up with or without the [0]
+    NullVariable_t* uniform = FindVariable(it->second.uniforms, name);
+    if (uniform == NULL)
+        uniform = FindVariable(it->second.uniforms, std::string(name) + "[0]");
+
+    return uniform != NULL ? uniform->location : -1;
+}
+
+static GLuint CODEGEN_FUNCPTR NullGetUniformBlockIndex(GLuint program, const GLchar* name) {
+    COUNT_CALL(glGetUniformBlockIndex);
+
+    auto it = programs.find(program);
+    if (it == programs.end())
+        return GL_INVALID_INDEX;
+
+    for (size_t i=0; i<it->second.uniformBlocks.size(); ++i)
+        if (it->second.uniformBlocks[i].name == name)
+            return (GLuint)i;
+
+    return GL_INVALID_INDEX;
+}
+
+static void CODEGEN_FUNCPTR NullGetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize,
+    GLsizei* length, GLchar* name) {
+
+    COUNT_CALL(glGetActiveUniformBlockName);
+
+    auto it = programs.find(program);
+    if (it == programs.end() || index >= it->second.uniformBlocks.size()) {
+        CopyName("", bufSize, length, name);
+        return;
+    }
+
+    CopyName(it->second.uniformBlocks[index].name, bufSize, length, name);
+}
+
+static void CODEGEN_FUNCPTR NullGetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params) {
+    COUNT_CALL(glGetActiveUniformBlockiv);
+
+    auto it = programs.find(program);
+    if (it == programs.end() || index >= it->second.uniformBlocks.size()) {
+        *params = 0;
+        return;
+    }
+
+    const NullUniformBlock_t& block = it->second.uniformBlocks[index];
+
+    switch (pname) {
+        case GL_UNIFORM_BLOCK_DATA_SIZE:   *params = block.dataSize; break;
+        case GL_UNIFORM_BLOCK_BINDING:     *params = block.binding; break;
+        case GL_UNIFORM_BLOCK_NAME_LENGTH: *params = (GLint)block.name.size() + 1; break;
+        default:                           *params = 0;
+    }
+}
+
+static void CODEGEN_FUNCPTR NullUniformBlockBinding(GLuint program, GLuint index, GLuint binding) {
+    COUNT_CALL(glUniformBlockBinding);
+
+    auto it = programs.find(program);
+    if (it != programs.end() && index < it->second.uniformBlocks.size())
+        it->second.uniformBlocks[index].binding = binding;
+}
+
+static void CODEGEN_FUNCPTR NullGetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize,
+    GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
+
+    COUNT_CALL(glGetActiveAttrib);
+
+    auto it = programs.find(program);
+    if (it == programs.end() || index >= it->second.attributes.size()) {
+        CopyName("", bufSize, length, name);
+        return;
+    }
+
+    const NullVariable_t& attribute = it->second.attributes[index];
+    CopyName(attribute.name, bufSize, length, name);
+    *size = attribute.size;
+    *type = attribute.type;
+}
+
+static GLint CODEGEN_FUNCPTR NullGetAttribLocation(GLuint program, const GLchar* name) {
+    COUNT_CALL(glGetAttribLocation);
+
+    auto it = programs.find(program);
+    if (it == programs.end())
+        return -1;
+
+    NullVariable_t* attribute = FindVariable(it->second.attributes, name);
+    return attribute != NULL ? attribute->location : -1;
+}
+
+static GLint GetInteger(GLenum pname) {
+    switch (pname) {
+        case GL_MAJOR_VERSION: return 3;
+        case GL_MINOR_VERSION: return 3;
+
+        case GL_CURRENT_PROGRAM:                return currentProgram;
+        case GL_VERTEX_ARRAY_BINDING:           return currentVertexArray;
+        case GL_ARRAY_BUFFER_BINDING:           return *GetBufferBinding(GL_ARRAY_BUFFER);
+        case GL_ELEMENT_ARRAY_BUFFER_BINDING:   return *GetBufferBinding(GL_ELEMENT_ARRAY_BUFFER);
+        case GL_UNIFORM_BUFFER_BINDING:         return *GetBufferBinding(GL_UNIFORM_BUFFER);
+        case GL_COPY_READ_BUFFER:               return *GetBufferBinding(GL_COPY_READ_BUFFER);
+        case GL_COPY_WRITE_BUFFER:              return *GetBufferBinding(GL_COPY_WRITE_BUFFER);
+        case GL_ACTIVE_TEXTURE:                 return GL_TEXTURE0 + activeTexture;
+        case GL_TEXTURE_BINDING_2D:             return textureBindings[activeTexture];
+
+        case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: return NULLGL_UNIFORM_BUFFER_OFFSET_ALIGNMENT;
+        case GL_MAX_UNIFORM_BUFFER_BINDINGS:     return NULLGL_MAX_UNIFORM_BUFFER_BINDINGS;
+        case GL_MAX_UNIFORM_BLOCK_SIZE:          return NULLGL_MAX_UNIFORM_BLOCK_SIZE;
+        case GL_MAX_TEXTURE_IMAGE_UNITS:         return NULLGL_MAX_TEXTURE_UNITS;
+        case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS: return NULLGL_MAX_TEXTURE_UNITS;
+        case GL_MAX_TEXTURE_SIZE:                return NULLGL_MAX_TEXTURE_SIZE;
+        case GL_MAX_VERTEX_ATTRIBS:              return NULLGL_MAX_VERTEX_ATTRIBS;
+
+        default: return 0;
+    }
+}
+
+static void CODEGEN_FUNCPTR NullGetIntegerv(GLenum pname, GLint* params) {
+    COUNT_CALL(glGetIntegerv);
+    *params = GetInteger(pname);
+}
+
+static void CODEGEN_FUNCPTR NullGetInteger64v(GLenum pname, GLint64* params) {
+    COUNT_CALL(glGetInteger64v);
+    *params = GetInteger(pname);
+}
+
+static void CODEGEN_FUNCPTR NullGetBooleanv(GLenum pname, GLboolean* params) {
+    COUNT_CALL(glGetBooleanv);
+    *params = GetInteger(pname) != 0 ? GL_TRUE : GL_FALSE;
+}
+
+static void CODEGEN_FUNCPTR NullGetFloatv(GLenum pname, GLfloat* params) {
+    COUNT_CALL(glGetFloatv);
+    *params = (GLfloat)GetInteger(pname);
+}
+
+static void CODEGEN_FUNCPTR NullGetDoublev(GLenum pname, GLdouble* params) {
+    COUNT_CALL(glGetDoublev);
+    *params = (GLdouble)GetInteger(pname);
+}
+
+static void CODEGEN_FUNCPTR NullGetIntegeri_v(GLenum target, GLuint index, GLint* data) {
+    COUNT_CALL(glGetIntegeri_v);
+
+    if (index >= NULLGL_MAX_UNIFORM_BUFFER_BINDINGS) {
+        *data = 0;
+        return;
+    }
+
+    const NullBufferRange_t& range = uniformBufferBindings[index];
+
+    switch (target) {
+        case GL_UNIFORM_BUFFER_BINDING: *data = range.buffer; break;
+        case GL_UNIFORM_BUFFER_START:   *data = (GLint)range.offset; break;
+        case GL_UNIFORM_BUFFER_SIZE:    *data = (GLint)range.size; break;
+        default:                        *data = 0;
+    }
+}
+
+static const GLubyte* CODEGEN_FUNCPTR NullGetString(GLenum name) {
+    COUNT_CALL(glGetString);
+
+    switch (name) {
+        case GL_VENDOR:                   return (const GLubyte*)"None";
+        case GL_RENDERER:                 return (const GLubyte*)"Null driver";
+        case GL_VERSION:                  return (const GLubyte*)"3.3 (null driver)";
+        case GL_SHADING_LANGUAGE_VERSION: return (const GLubyte*)"3.30";
+        default:                          return (const GLubyte*)"";
+    }
+}
+
+static const GLubyte* CODEGEN_FUNCPTR NullGetStringi(GLenum, GLuint) {
+    COUNT_CALL(glGetStringi);
+    return (const GLubyte*)"";
+}
+
+int NullGL::LoadFunctions() {
+    // Everything counts and does nothing...
+    #define GL_FUNCTION(name) Bind<GLFunction::name>(_ptrc_##name);
+    #include "GLFunctionList.h"
+    #undef GL_FUNCTION
+
+    // ...except what has to be emulated
+    _ptrc_glGenBuffers                = &NullGenBuffers;
+    _ptrc_glDeleteBuffers             = &NullDeleteBuffers;
+    _ptrc_glBindBuffer                = &NullBindBuffer;
+    _ptrc_glBindBufferRange           = &NullBindBufferRange;
+    _ptrc_glBindBufferBase            = &NullBindBufferBase;
+    _ptrc_glBufferData                = &NullBufferData;
+    _ptrc_glBufferSubData             = &NullBufferSubData;
+    _ptrc_glCopyBufferSubData         = &NullCopyBufferSubData;
+    _ptrc_glMapBufferRange            = &NullMapBufferRange;
+    _ptrc_glMapBuffer                 = &NullMapBuffer;
+    _ptrc_glUnmapBuffer               = &NullUnmapBuffer;
+    _ptrc_glGetBufferParameteriv      = &NullGetBufferParameteriv;
+
+    _ptrc_glGenVertexArrays           = &NullGenVertexArrays;
+    _ptrc_glDeleteVertexArrays        = &NullDeleteVertexArrays;
+    _ptrc_glBindVertexArray           = &NullBindVertexArray;
+
+    _ptrc_glGenTextures               = &NullGenTextures;
+    _ptrc_glDeleteTextures            = &NullDeleteTextures;
+    _ptrc_glActiveTexture             = &NullActiveTexture;
+    _ptrc_glBindTexture               = &NullBindTexture;
+
+    _ptrc_glGenQueries                = &NullGenQueries;
+    _ptrc_glGenFramebuffers           = &NullGenFramebuffers;
+    _ptrc_glGenRenderbuffers          = &NullGenRenderbuffers;
+    _ptrc_glGenSamplers               = &NullGenSamplers;
+    _ptrc_glCheckFramebufferStatus    = &NullCheckFramebufferStatus;
+
+    _ptrc_glGetQueryObjectiv          = &NullGetQueryObjectiv;
+    _ptrc_glGetQueryObjectuiv         = &NullGetQueryObjectuiv;
+    _ptrc_glGetQueryObjecti64v        = &NullGetQueryObjecti64v;
+    _ptrc_glGetQueryObjectui64v       = &NullGetQueryObjectui64v;
+
+    _ptrc_glFenceSync                 = &NullFenceSync;
+    _ptrc_glClientWaitSync            = &NullClientWaitSync;
+    _ptrc_glIsSync                    = &NullIsSync;
+    _ptrc_glGetSynciv                 = &NullGetSynciv;
+
+    _ptrc_glCreateShader              = &NullCreateShader;
+    _ptrc_glDeleteShader              = &NullDeleteShader;
+    _ptrc_glShaderSource              = &NullShaderSource;
+    _ptrc_glGetShaderiv               = &NullGetShaderiv;
+    _ptrc_glGetShaderInfoLog          = &NullGetShaderInfoLog;
+
+    _ptrc_glCreateProgram             = &NullCreateProgram;
+    _ptrc_glDeleteProgram             = &NullDeleteProgram;
+    _ptrc_glAttachShader              = &NullAttachShader;
+    _ptrc_glDetachShader              = &NullDetachShader;
+    _ptrc_glLinkProgram               = &NullLinkProgram;
+    _ptrc_glUseProgram                = &NullUseProgram;
+    _ptrc_glGetProgramiv              = &NullGetProgramiv;
+    _ptrc_glGetProgramInfoLog         = &NullGetProgramInfoLog;
+    _ptrc_glGetActiveUniform          = &NullGetActiveUniform;
+    _ptrc_glGetUniformLocation        = &NullGetUniformLocation;
+    _ptrc_glGetUniformBlockIndex      = &NullGetUniformBlockIndex;
+    _ptrc_glGetActiveUniformBlockName = &NullGetActiveUniformBlockName;
+    _ptrc_glGetActiveUniformBlockiv   = &NullGetActiveUniformBlockiv;
+    _ptrc_glUniformBlockBinding       = &NullUniformBlockBinding;
+    _ptrc_glGetActiveAttrib           = &NullGetActiveAttrib;
+    _ptrc_glGetAttribLocation         = &NullGetAttribLocation;
+
+    _ptrc_glGetIntegerv               = &NullGetIntegerv;
+    _ptrc_glGetInteger64v             = &NullGetInteger64v;
+    _ptrc_glGetBooleanv               = &NullGetBooleanv;
+    _ptrc_glGetFloatv                 = &NullGetFloatv;
+    _ptrc_glGetDoublev                = &NullGetDoublev;
+    _ptrc_glGetIntegeri_v             = &NullGetIntegeri_v;
+    _ptrc_glGetString                 = &NullGetString;
+    _ptrc_glGetStringi                = &NullGetStringi;
+
+    return ogl_LOAD_SUCCEEDED;
+}
+
+void NullGL::Shutdown() {
+    shaders.clear();
+    programs.clear();
+    buffers.clear();
+    elementArrayBindings.clear();
+    bufferBindings.clear();
+}
+
+uint64_t NullGL::GetCallCount(GLFunction::GLFunction function) {
+    return callCounts[function];
+}
+
+uint64_t NullGL::GetTotalCalls() {
+    uint64_t total = 0;
+    for (int i=0; i<GLFunction::Count; ++i)
+        total += callCounts[i];
+
+    return total;
+}
+
+static bool MoreCalls(const GLCallCount_t& a, const GLCallCount_t& b) {
+    return a.calls > b.calls;
+}
+
+void NullGL::GetCallCounts(std::vector<GLCallCount_t>& counts) {
+    counts.clear();
+
+    for (int i=0; i<GLFunction::Count; ++i) {
+        if (callCounts[i] > 0) {
+            GLCallCount_t count = {GLFunction::GetName((GLFunction::GLFunction)i), callCounts[i]};
+            counts.push_back(count);
+        }
+    }
+
+    std::stable_sort(counts.begin(), counts.end(), MoreCalls);
+}
+
+void NullGL::ResetCallCounts() {
+    memset(callCounts, 0, sizeof(callCounts));
+}
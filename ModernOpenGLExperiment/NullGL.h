@@ -0,0 +1,56 @@
+#ifndef NULLGL_H
+#define NULLGL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Rendering.h"
+#include "GLFunctions.h"
+
+/**
+ * NullGL
+ * A do-nothing OpenGL driver, for measuring what our own code costs on the CPU without
+ * a GPU, a window or a driver in the way.
+ *
+ * LoadFunctions points every gl_core_3_3 entry point at a stub that only counts the call.
+ * Anything whose results our code depends on is emulated just well enough to keep it
+ * running:
+ *  - Objects get fake names, and the bindings GLState validates are tracked
+ *  - Buffers get real storage, so mapping them hands back usable memory
+ *  - Shaders always compile and programs always link. Linking scans the attached
+ *    sources for uniforms, uniform blocks and vertex inputs, so that introspection
+ *    finds roughly what a real driver would.
+ *  - Fences are always signalled, and queries are always available (and report 0)
+ *
+ * Only one thread may call into it at a time, like a real context.
+ */
+class NullGL {
+private:
+    NullGL() {}
+
+public:
+    /**
+     * LoadFunctions
+     * Use instead of ogl_LoadFunctions. Always returns ogl_LOAD_SUCCEEDED.
+     */
+    static int LoadFunctions();
+
+    /**
+     * Shutdown
+     * Frees all emulated objects, e.g. leftover buffer storage
+     */
+    static void Shutdown();
+
+    static uint64_t GetCallCount(GLFunction::GLFunction function);
+    static uint64_t GetTotalCalls();
+
+    /**
+     * GetCallCounts
+     * Fills counts with every entry point that has been called, most called first
+     */
+    static void GetCallCounts(std::vector<GLCallCount_t>& counts);
+
+    static void ResetCallCounts();
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "OBJModel.h"
+#include "CPUProfiler.h"
 
 glm::vec3 OBJModel::ReadVec3(std::istream& infile) const {
     float x,y,z;
@@ -94,6 +95,8 @@ OBJModel::OBJModel(std::istream& infile) {
 OBJModel::~OBJModel() {}
 
 OBJModel* OBJModel::LoadFromFile(const char* filename) {
+    PROFILE_ZONE("OBJModel::LoadFromFile");
+
     std::ifstream infile(filename);
     if (!infile) throw errno;
 
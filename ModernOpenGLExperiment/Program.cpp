@@ -1,16 +1,44 @@
 #include "Program.h"
+#include "CPUProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
 
 const Uniform_t Program::DEFAULT_UNIFORM = {"", -1, 0, 0};
 const VertexAttribute_t Program::DEFAULT_VERTEXATTRIBUTE = {"", -1, 0, 0};
 
+// Blocks with these names get the same binding point in every program
+static const struct {
+    const char* name;
+    GLuint binding;
+} KNOWN_UNIFORM_BLOCKS[] = {
+    {"Frame",     UniformBlockBinding::FrameBlock},
+    {"Transform", UniformBlockBinding::TransformBlock},
+    {"Light",     UniformBlockBinding::LightBlock}
+};
+
 Program::~Program() {
+    GLState::ForgetProgram(programHandle);
     glDeleteProgram(programHandle);
     programHandle = 0;
 }
 
-void Program::Link() {
+void Program::StartLink() {
     glLinkProgram(programHandle);
+}
+
+bool Program::FinishLink() {
+    PROFILE_ZONE("Program::FinishLink");
+
     glGetProgramiv(programHandle, GL_LINK_STATUS, &linkResult);
+
+    if (IsValid()) {
+        AcquireUniforms();
+        AcquireUniformBlocks();
+        AcquireAttributes();
+    }
+
+    return IsValid();
 }
 
 void Program::AcquireUniforms() {
@@ -30,34 +58,122 @@ void Program::AcquireUniforms() {
 
             // At some point, when I'm finally dealing with textures, I'll have to deal with samplers here
 
+            GLint location = glGetUniformLocation(programHandle, uniformName);
+
+            // Members of uniform blocks are fed through buffers, not glUniform*
+            if (location == -1)
+                continue;
+
             Uniform_t uniform = {
                 std::string(uniformName),
-                glGetUniformLocation(programHandle, uniformName),
+                location,
                 uniformType,
                 uniformSize
             };
+            uniform.hasLastValue = false;
 
-            // Add to uniform map
-            uniforms[uniformName] = uniform;
+            // Give it the next slot, and index the slot by the hash of its name
+            UniformSlot_t slot = {
+                UniformName(uniform.name).hash,
+                (uint32_t)uniforms.size()
+            };
+
+            uniforms.push_back(uniform);
+            uniformSlots.push_back(slot);
         }
 
         delete[] uniformName;
     }
+
+    std::sort(uniformSlots.begin(), uniformSlots.end(), CompareSlots);
+
+    for (size_t i=1; i<uniformSlots.size(); ++i) {
+        if (uniformSlots[i].hash == uniformSlots[i-1].hash) {
+            fprintf(stderr, "Uniforms %s and %s have the same name hash, only one can be looked up\n",
+                uniforms[uniformSlots[i-1].slot].name.c_str(),
+                uniforms[uniformSlots[i].slot].name.c_str());
+        }
+    }
 }
 
-const Uniform_t* Program::GetUniform(const std::string& uniformName) const {
-    std::map<std::string, Uniform_t>::const_iterator it = uniforms.find(uniformName);
-    
-    return it == uniforms.end()
-        ? &DEFAULT_UNIFORM
-        : &(it->second);
+const Uniform_t* Program::GetUniform(const UniformName& uniformName) const {
+    UniformSlot_t key = {uniformName.hash, 0};
+
+    auto it = std::lower_bound(uniformSlots.begin(), uniformSlots.end(), key, CompareSlots);
+    if (it == uniformSlots.end() || it->hash != uniformName.hash)
+        return &DEFAULT_UNIFORM;
+
+    // Guard against a name we don't have that happens to collide with one we do
+    const Uniform_t* uniform = &uniforms[it->slot];
+    return strcmp(uniform->name.c_str(), uniformName.name) == 0
+        ? uniform
+        : &DEFAULT_UNIFORM;
 }
 
-GLuint Program::GetUniformID(const std::string& name) const {
+GLuint Program::GetUniformID(const UniformName& name) const {
     const Uniform_t* uniform = GetUniform(name);
     return uniform->location;
 }
 
+void Program::AcquireUniformBlocks() {
+    GLint activeBlocks, maxNameLength;
+    glGetProgramiv(programHandle, GL_ACTIVE_UNIFORM_BLOCKS, &activeBlocks);
+    glGetProgramiv(programHandle, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxNameLength);
+
+    if (activeBlocks > 0 && maxNameLength > 0) {
+        GLchar* blockName = new GLchar[maxNameLength];
+        GLuint nextCustomBinding = UniformBlockBinding::CustomBlock;
+
+        for (int i=0; i<activeBlocks; ++i) {
+            glGetActiveUniformBlockName(programHandle, i, maxNameLength, NULL, blockName);
+
+            UniformBlock_t block = {
+                std::string(blockName),
+                (GLuint)i,
+                0,
+                nextCustomBinding
+            };
+
+            glGetActiveUniformBlockiv(programHandle, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+
+            bool known = false;
+            for (size_t j=0; j<sizeof(KNOWN_UNIFORM_BLOCKS)/sizeof(KNOWN_UNIFORM_BLOCKS[0]); ++j) {
+                if (block.name == KNOWN_UNIFORM_BLOCKS[j].name) {
+                    block.binding = KNOWN_UNIFORM_BLOCKS[j].binding;
+                    known = true;
+                    break;
+                }
+            }
+
+            if (!known)
+                ++nextCustomBinding;
+
+            glUniformBlockBinding(programHandle, block.index, block.binding);
+
+            uniformBlocks[blockName] = block;
+        }
+
+        delete[] blockName;
+    }
+}
+
+const UniformBlock_t* Program::GetUniformBlock(const std::string& name) const {
+    auto it = uniformBlocks.find(name);
+
+    return it == uniformBlocks.end()
+        ? NULL
+        : &(it->second);
+}
+
+void Program::SetUniformBlockBinding(const std::string& name, GLuint binding) {
+    auto it = uniformBlocks.find(name);
+    if (it == uniformBlocks.end())
+        return;
+
+    it->second.binding = binding;
+    glUniformBlockBinding(programHandle, it->second.index, binding);
+}
+
 void Program::AcquireAttributes() {
     GLint activeAttributes, maxNameLength;
     glGetProgramiv(programHandle, GL_ACTIVE_ATTRIBUTES, &activeAttributes);
@@ -103,37 +219,40 @@ GLuint Program::GetAttributeID(const std::string& attrName) const {
 }
 
 Program* Program::CreateFromShaders(VertexShader* vs,  FragmentShader* fs) {
+    Program* program = StartLinkFromShaders(vs, fs);
+    program->FinishLink();
+
+    return program;
+}
+
+Program* Program::CreateFromShaders(VertexShader* vs, GeometryShader* gs, FragmentShader* fs) {
+    Program* program = StartLinkFromShaders(vs, gs, fs);
+    program->FinishLink();
+
+    return program;
+}
+
+Program* Program::StartLinkFromShaders(VertexShader* vs,  FragmentShader* fs) {
     Program* program = new Program();
 
     program->Attach(vs);
     program->Attach(fs);
 
-    program->Link();
-
-    if (program->IsValid()) {
-        program->AcquireUniforms();
-        program->AcquireAttributes();
-    }
+    program->StartLink();
 
     return program;
 }
 
-Program* Program::CreateFromShaders(VertexShader* vs, GeometryShader* gs, FragmentShader* fs) {
+Program* Program::StartLinkFromShaders(VertexShader* vs, GeometryShader* gs, FragmentShader* fs) {
     Program* program = new Program();
 
     program->Attach(vs);
     program->Attach(gs);
     program->Attach(fs);
 
-    program->Link();
-
-    if (program->IsValid()) {
-        program->AcquireUniforms();
-        program->AcquireAttributes();
-    }
+    program->StartLink();
 
     return program;
-
 }
 
 std::string Program::GetLinkLog() const {
@@ -3,6 +3,10 @@
 
 #include "Rendering.h"
 #include "Shader.h"
+#include "GLState.h"
+
+#include <cstring>
+#include <vector>
 
 /**
  * Program - Contains linked shaders representing the programmable part of the pipeline.
@@ -14,16 +18,28 @@
  */
 class Program {
 private:
+    // Builds programs itself, to ask for retrievable binaries and load cached ones
+    friend class ShaderLibrary;
+
     GLuint programHandle;
     GLint  linkResult;
 
-    std::map<std::string, Uniform_t> uniforms;
+    typedef struct {
+        uint32_t hash;
+        uint32_t slot;
+    } UniformSlot_t;
+
+    // Active uniforms packed densely, plus their name hashes sorted for lookup
+    std::vector<Uniform_t> uniforms;
+    std::vector<UniformSlot_t> uniformSlots;
+    std::map<std::string, UniformBlock_t> uniformBlocks;
     std::map<std::string, VertexAttribute_t> attributes;
 
     Program() : programHandle(glCreateProgram()), linkResult(GL_FALSE) {}
 
-    void Link();
+    void StartLink();
     void AcquireUniforms();
+    void AcquireUniformBlocks();
     void AcquireAttributes();
 
     template <ShaderType::ShaderType T>
@@ -36,41 +52,112 @@ private:
     static const Uniform_t DEFAULT_UNIFORM;
     static const VertexAttribute_t DEFAULT_VERTEXATTRIBUTE;
 
+    static bool CompareSlots(const UniformSlot_t& a, const UniformSlot_t& b) { return a.hash < b.hash; }
+
+    /**
+     * UpdateShadow
+     * Returns false if the uniform already holds the given value (or doesn't exist),
+     * otherwise records it as the uniform's last value and returns true
+     */
+    static bool UpdateShadow(Uniform_t const * uniform, const void* value, size_t size) {
+        assert(size <= sizeof(uniform->lastValue));
+
+        if (uniform->location == (GLuint)-1)
+            return false;
+
+        if (uniform->hasLastValue && memcmp(uniform->lastValue, value, size) == 0) {
+            GLState::CountUniform(false);
+            return false;
+        }
+
+        memcpy(uniform->lastValue, value, size);
+        uniform->hasLastValue = true;
+
+        GLState::CountUniform(true);
+        return true;
+    }
+
 public:
     static Program* CreateFromShaders(VertexShader* vs, FragmentShader* fs);
     static Program* CreateFromShaders(VertexShader* vs, GeometryShader* gs, FragmentShader* fs);
 
+    /**
+     * StartLinkFromShaders
+     * Like CreateFromShaders, but doesn't wait for the link to finish. FinishLink has to
+     * be called before the program is used.
+     */
+    static Program* StartLinkFromShaders(VertexShader* vs, FragmentShader* fs);
+    static Program* StartLinkFromShaders(VertexShader* vs, GeometryShader* gs, FragmentShader* fs);
+
+    /**
+     * FinishLink
+     * Waits for the link to finish and, if it worked, finds the program's uniforms,
+     * uniform blocks and attributes. Returns IsValid.
+     */
+    bool FinishLink();
+
     ~Program();
 
     std::string GetLinkLog() const;
 
     bool IsValid() const { return programHandle != 0 && linkResult == GL_TRUE; }
-    void Bind() const { glUseProgram(programHandle); }
-
-    Uniform_t const * GetUniform(const std::string& name) const;
-    GLuint GetUniformID(const std::string& name) const;
+    void Bind() const { GLState::UseProgram(programHandle); }
+
+    GLuint GetHandle() const { return programHandle; }
+
+    /**
+     * GetUniform
+     * Looks up a uniform by the hash of its name. The returned pointer stays valid for
+     * the lifetime of the program, so it's worth holding on to for uniforms set often.
+     * Uniforms that don't exist come back with a location of -1, which SetUniform ignores.
+     */
+    Uniform_t const * GetUniform(const UniformName& name) const;
+    GLuint GetUniformID(const UniformName& name) const;
+
+    size_t GetUniformCount() const { return uniforms.size(); }
+
+    /**
+     * GetUniformBlock
+     * Returns the named uniform block, or NULL if the program doesn't use it
+     */
+    UniformBlock_t const * GetUniformBlock(const std::string& name) const;
+
+    /**
+     * SetUniformBlockBinding
+     * Points the named uniform block at a different binding point than the
+     * one it was given at link time
+     */
+    void SetUniformBlockBinding(const std::string& name, GLuint binding);
 
     VertexAttribute_t const * GetAttribute(const std::string& attrName) const;
     GLuint GetAttributeID(const std::string& attrName) const;
 
+    // Each of these expects the uniform's program to be bound, and skips
+    // the call entirely when the uniform already holds the value
+
     static void SetUniform(Uniform_t const * uniform, GLfloat value) {
-        glUniform1f(uniform->location, value);
+        if (UpdateShadow(uniform, &value, sizeof(value)))
+            glUniform1f(uniform->location, value);
     }
 
     static void SetUniform(Uniform_t const * uniform, GLint value) {
-        glUniform1i(uniform->location, value);
+        if (UpdateShadow(uniform, &value, sizeof(value)))
+            glUniform1i(uniform->location, value);
     }
 
     static void SetUniform(Uniform_t const * uniform, GLuint value) {
-        glUniform1ui(uniform->location, value);
+        if (UpdateShadow(uniform, &value, sizeof(value)))
+            glUniform1ui(uniform->location, value);
     }
 
     static void SetUniform(Uniform_t const * uniform, const glm::mat4& value) {
-        glUniformMatrix4fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
+        if (UpdateShadow(uniform, glm::value_ptr(value), 16*sizeof(GLfloat)))
+            glUniformMatrix4fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
     }
 
     static void SetUniform(Uniform_t const * uniform, const glm::mat3& value) {
-        glUniformMatrix3fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
+        if (UpdateShadow(uniform, glm::value_ptr(value), 9*sizeof(GLfloat)))
+            glUniformMatrix3fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
     }
 };
 
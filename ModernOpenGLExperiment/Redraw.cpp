@@ -0,0 +1,43 @@
+#include "Redraw.h"
+
+#include "Rendering.h"
+#include "Clock.h"
+
+std::atomic<uint32_t> Redraw::pending(0);
+std::atomic<int32_t> Redraw::backgroundWork(0);
+
+RedrawStats_t Redraw::stats = {0};
+
+uint32_t Redraw::Take() {
+    uint32_t reasons = pending.exchange(0);
+
+    if (reasons != 0) {
+        ++stats.frames;
+
+        for (uint32_t i=0; i<RedrawReason::ReasonCount; ++i)
+            if (reasons & (1 << i))
+                ++stats.framesByReason[i];
+    }
+
+    return reasons;
+}
+
+void Redraw::EndBackgroundWork() {
+    Request(RedrawReason::ResourceLoad);
+    backgroundWork.fetch_sub(1);
+}
+
+void Redraw::WaitForEvents(double pollInterval) {
+    uint64_t start = Clock::Now();
+
+    if (HasBackgroundWork()) {
+        // Can't be woken up from other threads, so check back regularly
+        glfwSleep(pollInterval);
+        glfwPollEvents();
+    } else {
+        glfwWaitEvents();
+    }
+
+    ++stats.idleWaits;
+    stats.idleTime += Clock::Now() - start;
+}
@@ -0,0 +1,85 @@
+#ifndef REDRAW_H
+#define REDRAW_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace RedrawReason {
+    enum RedrawReason {
+        Input        = 1 << 0,
+        Animation    = 1 << 1,
+        ResourceLoad = 1 << 2,
+        Expose       = 1 << 3, // The window system lost what we last drew
+
+        ReasonCount  = 4
+    };
+};
+
+/**
+ * RedrawStats_t - Why frames were drawn, and how long the loop sat idle in between
+ */
+typedef struct {
+    uint32_t frames;
+    uint32_t framesByReason[RedrawReason::ReasonCount];
+
+    uint32_t idleWaits;
+    uint64_t idleTime; // ns
+} RedrawStats_t;
+
+/**
+ * Redraw
+ * Tracks whether the next frame needs drawing at all, for the on-demand render mode.
+ * Anything that changes what's on screen - input, animation that hasn't settled yet, a
+ * resource finishing loading - calls Request, and the main loop only draws a frame once
+ * something has. Otherwise it sleeps in glfwWaitEvents until the next window event.
+ *
+ * GLFW 2 has no way to wake up glfwWaitEvents from another thread, so work running in
+ * the background that will want a redraw when it's done brackets itself with
+ * BeginBackgroundWork and EndBackgroundWork. While any is outstanding, the loop polls
+ * at the frame rate instead of waiting.
+ *
+ * Everything here is safe to call from any thread.
+ */
+class Redraw {
+private:
+    static std::atomic<uint32_t> pending;
+    static std::atomic<int32_t> backgroundWork;
+
+    static RedrawStats_t stats;
+
+    Redraw() {}
+
+public:
+    static void Request(RedrawReason::RedrawReason reason) {
+        pending.fetch_or(reason);
+    }
+
+    static bool IsPending() { return pending.load() != 0; }
+
+    /**
+     * Take
+     * Returns the reasons for redrawing requested since the last call, and clears them.
+     * Only the main loop should call this.
+     */
+    static uint32_t Take();
+
+    static void BeginBackgroundWork() { backgroundWork.fetch_add(1); }
+
+    /**
+     * EndBackgroundWork
+     * Finishes a piece of background work, requesting a redraw for its results
+     */
+    static void EndBackgroundWork();
+
+    static bool HasBackgroundWork() { return backgroundWork.load() > 0; }
+
+    /**
+     * WaitForEvents
+     * Blocks until there's a chance that something needs redrawing
+     */
+    static void WaitForEvents(double pollInterval);
+
+    static const RedrawStats_t& GetStats() { return stats; }
+};
+
+#endif
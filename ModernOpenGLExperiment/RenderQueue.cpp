@@ -0,0 +1,146 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+
+uint64_t RenderQueue::MakeKey(const DrawPacket_t& packet) {
+    uint64_t pass    = packet.pass & 0xF;
+    uint64_t program = packet.program != NULL ? packet.program->GetHandle() & 0xFFF  : 0;
+    uint64_t texture = packet.texture != NULL ? packet.texture->GetID()     & 0xFFFF : 0;
+    uint64_t mesh    = packet.mesh    != NULL ? packet.mesh->GetHandle()    & 0xFFFF :
+                                                packet.batch->GetHandle()   & 0xFFFF;
+
+    float depth = glm::clamp(packet.depth, 0.0f, 1.0f);
+    uint64_t depthBits = (uint64_t)(depth * 0xFFFF);
+
+    return
+        (pass    << 60) |
+        (program << 48) |
+        (texture << 32) |
+        (mesh    << 16) |
+        depthBits;
+}
+
+void RenderQueue::Push(const DrawPacket_t& packet) {
+    assert(packet.program != NULL);
+    assert((packet.mesh != NULL) != (packet.batch != NULL));
+
+    SortItem_t item = {MakeKey(packet), (uint32_t)packets.size()};
+
+    packets.push_back(packet);
+    items.push_back(item);
+}
+
+void RenderQueue::Sort() {
+    size_t count = items.size();
+    if (count < 2)
+        return;
+
+    scratch.resize(count);
+
+    SortItem_t* src = &items[0];
+    SortItem_t* dst = &scratch[0];
+
+    uint32_t histogram[RADIX_SIZE];
+
+    for (uint32_t pass=0; pass<RADIX_PASSES; ++pass) {
+        uint32_t shift = pass * RADIX_BITS;
+
+        memset(histogram, 0, sizeof(histogram));
+        for (size_t i=0; i<count; ++i)
+            ++histogram[(src[i].key >> shift) & (RADIX_SIZE-1)];
+
+        // Most of the key is usually constant across a frame (e.g. the depth
+        // field when nothing is depth sorted), so skip digits that don't
+        // discriminate between any of the items
+        if (histogram[(src[0].key >> shift) & (RADIX_SIZE-1)] == count)
+            continue;
+
+        // Convert counts into starting offsets
+        uint32_t offset = 0;
+        for (uint32_t i=0; i<RADIX_SIZE; ++i) {
+            uint32_t bucketSize = histogram[i];
+            histogram[i] = offset;
+            offset += bucketSize;
+        }
+
+        for (size_t i=0; i<count; ++i)
+            dst[histogram[(src[i].key >> shift) & (RADIX_SIZE-1)]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    // Make sure the result ends up in items
+    if (src != &items[0])
+        items.swap(scratch);
+}
+
+void RenderQueue::Record(CommandList& commands) {
+    Sort();
+
+    memset(&stats, 0, sizeof(stats));
+    stats.packets = (uint32_t)items.size();
+
+    Program* currentProgram = NULL;
+    Texture* currentTexture = NULL;
+    uint32_t texturedPackets = 0;
+
+    for (size_t i=0; i<items.size(); ++i) {
+        const DrawPacket_t& packet = packets[items[i].index];
+
+        if (packet.program != currentProgram) {
+            commands.SetProgram(packet.program);
+            currentProgram = packet.program;
+            ++stats.programBinds;
+        }
+
+        if (packet.texture != NULL) {
+            ++texturedPackets;
+
+            if (packet.texture != currentTexture) {
+                commands.SetTexture(0, packet.texture);
+                currentTexture = packet.texture;
+                ++stats.textureBinds;
+            }
+        }
+
+        if (packet.transform.size > 0)
+            commands.SetUniformRange(UniformBlockBinding::TransformBlock, packet.transform);
+
+        if (packet.mesh != NULL) {
+            commands.DrawMesh(packet.mesh);
+            ++stats.meshesDrawn;
+
+            if (packet.mesh->GetPrimitiveType() == PrimitiveType::TrianglesPrimitive)
+                stats.trianglesDrawn += packet.mesh->GetIndexCount() / 3;
+        } else {
+            commands.DrawBatch(packet.batch);
+            stats.meshesDrawn += (uint32_t)packet.batch->GetSize();
+
+            if (packet.batch->GetPrimitiveType() == PrimitiveType::TrianglesPrimitive)
+                stats.trianglesDrawn += packet.batch->GetIndexCount() / 3;
+        }
+
+        ++stats.drawCalls;
+    }
+
+    stats.programBindsAvoided = stats.packets - stats.programBinds;
+    stats.textureBindsAvoided = texturedPackets - stats.textureBinds;
+
+    Clear();
+}
+
+void RenderQueue::Submit() {
+    Record(submitCommands);
+
+    submitCommands.Execute();
+    submitCommands.Clear();
+}
+
+void RenderQueue::Clear() {
+    packets.clear();
+    items.clear();
+}
@@ -0,0 +1,143 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Rendering.h"
+#include "Program.h"
+#include "Mesh.h"
+#include "MeshBatch.h"
+#include "Texture.h"
+#include "UniformRing.h"
+#include "CommandList.h"
+
+/**
+ * DrawPacket_t - Everything needed to issue a single draw: the state it needs bound
+ * and the mesh to draw with it. Packets are collected into a RenderQueue and sorted
+ * by their state key before being submitted.
+ */
+typedef struct {
+    Program* program;
+    Texture* texture; // May be NULL if the program doesn't sample anything
+
+    // Exactly one of these is set
+    Mesh* mesh;
+    MeshBatch* batch;
+
+    // Per-draw "Transform" block data, if the program wants any. An empty
+    // range leaves whatever is bound at the time alone.
+    UniformRange_t transform;
+
+    // Normalized view depth in [0,1], used to order draws within the same state
+    float depth;
+
+    // Passes are always submitted in ascending order
+    uint8_t pass;
+} DrawPacket_t;
+
+/**
+ * RenderQueueStats_t - Counters from the last call to RenderQueue::Submit
+ */
+typedef struct {
+    uint32_t packets;
+
+    // Draw calls issued, and how many meshes they covered between them
+    uint32_t drawCalls;
+    uint32_t meshesDrawn;
+
+    // Counted from the index counts of triangle meshes only
+    uint32_t trianglesDrawn;
+
+    uint32_t programBinds;
+    uint32_t textureBinds;
+
+    // State changes that a naive submission (one bind per packet) would have made
+    uint32_t programBindsAvoided;
+    uint32_t textureBindsAvoided;
+} RenderQueueStats_t;
+
+/**
+ * RenderQueue
+ * Collects draw packets over a frame, then sorts them so that draws sharing a program,
+ * then a texture, then a vertex array end up next to each other.
+ *
+ * Each packet is reduced to a 64-bit key, laid out from most to least significant:
+ *   [63..60] pass
+ *   [59..48] program handle
+ *   [47..32] texture handle
+ *   [31..16] vertex array handle
+ *   [15..0]  quantized depth (front to back)
+ *
+ * Handles are truncated to fit their field, which is fine as long as we don't have
+ * more than a few thousand live objects of each kind. Should two objects ever alias,
+ * the only cost is an extra bind, since Submit compares the real pointers.
+ */
+class RenderQueue {
+private:
+    typedef struct {
+        uint64_t key;
+        uint32_t index;
+    } SortItem_t;
+
+    std::vector<DrawPacket_t> packets;
+
+    std::vector<SortItem_t> items;
+    std::vector<SortItem_t> scratch;
+
+    RenderQueueStats_t stats;
+
+    // Scratch list for Submit
+    CommandList submitCommands;
+
+    static uint64_t MakeKey(const DrawPacket_t& packet);
+
+    // LSD radix sort of items on their key, 8 bits per pass
+    void Sort();
+
+public:
+    RenderQueue() {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    /**
+     * Push
+     * Adds a packet to be drawn at the next Submit
+     */
+    void Push(const DrawPacket_t& packet);
+
+    void Push(uint8_t pass, Program* program, Texture* texture, Mesh* mesh, const UniformRange_t& transform, float depth = 0.0f) {
+        DrawPacket_t packet = {program, texture, mesh, NULL, transform, depth, pass};
+        Push(packet);
+    }
+
+    void Push(uint8_t pass, Program* program, Texture* texture, MeshBatch* batch, const UniformRange_t& transform, float depth = 0.0f) {
+        DrawPacket_t packet = {program, texture, NULL, batch, transform, depth, pass};
+        Push(packet);
+    }
+
+    /**
+     * Record
+     * Sorts all pushed packets and records them into a command list, only binding
+     * programs and textures when they change from the previous packet. The queue is
+     * emptied afterwards. Doesn't touch GL, so it can run on any thread.
+     */
+    void Record(CommandList& commands);
+
+    /**
+     * Submit
+     * Records and immediately executes all pushed packets.
+     *
+     * Any uniform ranges referenced by the packets must have been flushed.
+     */
+    void Submit();
+
+    void Clear();
+
+    size_t GetSize() const { return packets.size(); }
+
+    const RenderQueueStats_t& GetStats() const { return stats; }
+};
+
+#endif
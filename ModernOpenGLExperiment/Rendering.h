@@ -12,7 +12,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/quaternion.hpp>
 
+#include <cstdint>
 #include <map>
 #include <string>
 
@@ -63,6 +65,20 @@ namespace PrimitiveType {
     };
 }
 
+/**
+ * UniformBlockBinding - Binding points for the uniform blocks shared between programs.
+ * Any program declaring a block with one of these names gets it bound to the same
+ * point, so one buffer range bound there feeds every program at once.
+ */
+namespace UniformBlockBinding {
+    enum UniformBlockBinding {
+        FrameBlock = 0,     // "Frame" - Per-frame camera data
+        TransformBlock = 1, // "Transform" - Per-draw object transforms
+        LightBlock = 2,     // "Light"
+        CustomBlock = 3     // Blocks we don't know about get numbered from here
+    };
+}
+
 namespace TextureType {
     enum TextureType {
         Texture2D = GL_TEXTURE_2D
@@ -77,8 +93,65 @@ typedef struct {
     GLuint location;
     GLenum type;
     GLint size;
+
+    // Shadow copy of the last value set through Program::SetUniform, so that setting
+    // the same value again can skip the driver. These don't change what the uniform
+    // is, hence mutable.
+    mutable GLfloat lastValue[16];
+    mutable bool hasLastValue;
 } Uniform_t;
 
+/**
+ * UniformName - The name of a uniform along with a hash of it, so that looking a
+ * uniform up doesn't have to build a std::string or compare strings in a map.
+ *
+ * Naming a uniform with a string literal hashes it right at the call site - the
+ * length is known at compile time, so the optimizer folds the whole loop away.
+ * (Our toolset doesn't do constexpr, otherwise that's what this would be.) A name in
+ * a char array that's bigger than it only counts up to its terminator, so it hashes
+ * the same as the literal would.
+ */
+struct UniformName {
+    uint32_t hash;
+    const char* name;
+
+    template <size_t N>
+    UniformName(const char (&name)[N]) : hash(Hash(name, N-1, true)), name(name) {}
+
+    explicit UniformName(const std::string& name) : hash(Hash(name.c_str(), name.size())), name(name.c_str()) {}
+
+    // 32-bit FNV-1a of at most length chars, stopping early at a terminator if asked to
+    static uint32_t Hash(const char* str, size_t length, bool terminated = false) {
+        uint32_t hash = 2166136261u;
+        for (size_t i=0; i<length && !(terminated && str[i] == '\0'); ++i) {
+            hash ^= (uint8_t)str[i];
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+};
+
+/**
+ * UniformBlock_t - Information about a uniform block in a Program, and which binding
+ * point it reads its buffer from.
+ */
+typedef struct {
+    std::string name;
+    GLuint index;
+    GLint dataSize;
+    GLuint binding;
+} UniformBlock_t;
+
+/**
+ * UniformRange_t - A range of a uniform buffer, as handed to glBindBufferRange
+ */
+typedef struct {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+} UniformRange_t;
+
 /**
  * VertexAttribute_t - Simple data structure that records how to reference an attribute
  * in a Shader/Program, what kind of data it expects, etc.
@@ -0,0 +1,429 @@
+#include "SceneBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Rendering.h"
+#include "Clock.h"
+#include "CommandList.h"
+#include "FrameSync.h"
+#include "GLDebugOutput.h"
+#include "GLState.h"
+#include "MD3Model.h"
+#include "Mesh.h"
+#include "Model.h"
+#include "NullGL.h"
+#include "OBJModel.h"
+#include "Program.h"
+#include "ShaderPreprocessor.h"
+#include "RenderQueue.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "UniformBlocks.h"
+#include "UniformRing.h"
+
+#define SCENE_MODEL_FILE "models/rocketam.md3"
+
+// Room for every instance's transform and then some
+#define SCENE_UNIFORM_RING_SIZE (4*1024*1024)
+
+#define SCENE_ARENA_VERTEX_CAPACITY (64*1024)
+#define SCENE_ARENA_INDEX_CAPACITY  (192*1024)
+
+#define SCENE_FIELD_OF_VIEW 70.0f
+#define SCENE_NEAR_PLANE    1.0f
+
+#define SCENE_PI 3.14159f
+
+static const char* SCENE_TEXTURE_FILES[] = {
+    "textures/rockammo.tga",
+    "textures/rockammo2.tga"
+};
+
+typedef struct {
+    Model* model;
+    glm::vec3 position;
+    TransformBlock_t transform;
+} SceneInstance_t;
+
+// The demo's textured surface shader, without the normals
+static Program* MakeSceneProgram() {
+    std::vector<const char*> defines(1, "TEXTURED");
+    std::string vss, fss, error;
+
+    if (!ShaderPreprocessor::Process("glsl", "default.vert", defines, vss, error) ||
+        !ShaderPreprocessor::Process("glsl", "surface.frag", defines, fss, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return NULL;
+    }
+
+    VertexShader* vs = VertexShader::CompileFromSource(vss);
+    FragmentShader* fs = FragmentShader::CompileFromSource(fss);
+
+    Program* program = NULL;
+    if (vs->IsValid() && fs->IsValid())
+        program = Program::CreateFromShaders(vs, fs);
+
+    delete vs;
+    delete fs;
+
+    if (program != NULL && !program->IsValid()) {
+        fprintf(stderr, "Link Error:\n%s\n", program->GetLinkLog().c_str());
+
+        delete program;
+        program = NULL;
+    }
+
+    return program;
+}
+
+// The loaders throw errno when a file can't be opened
+static ModelLoader* OpenModel(const std::string& filename, bool md3) {
+    try {
+        return md3 ? (ModelLoader*)MD3Model::LoadFromFile(filename.c_str())
+                   : (ModelLoader*)OBJModel::LoadFromFile(filename.c_str());
+    } catch (int) {
+        return NULL;
+    }
+}
+
+// Loads every surface of a model into the arena and groups them into a Model
+static Model* LoadSceneModel(GeometryArena* arena, const ModelLoader* loader,
+    const std::vector<Texture*>& textures, std::vector<Mesh*>& meshes) {
+
+    Model* model = new Model(arena);
+
+    for (uint32_t i=0; i<loader->GetMeshCount(); ++i) {
+        MeshVertex_t* vertexData = NULL;
+        GLushort* indexData = NULL;
+        uint32_t vertexCount, triangleCount;
+
+        loader->GetVertices(i, vertexData, vertexCount);
+        loader->GetIndices(i,  indexData,  triangleCount);
+
+        Mesh* mesh = Mesh::CreateInArena(arena, PrimitiveType::TrianglesPrimitive,
+            vertexCount, vertexData, triangleCount * 3, indexData);
+
+        delete[] vertexData;
+        delete[] indexData;
+
+        meshes.push_back(mesh);
+        model->AddSurface(mesh, textures[std::min<size_t>(i, textures.size() - 1)]);
+    }
+
+    return model;
+}
+
+// Camera position along the path at t in [0, 1): once around the grid, swooping in
+// and out and rising and falling twice on the way
+static glm::vec3 GetCameraPosition(float t, float radius) {
+    float angle = 2.0f * SCENE_PI * t;
+    float distance = radius * (0.75f + 0.25f * cosf(2.0f * angle));
+    float height = radius * (0.3f + 0.15f * sinf(2.0f * angle));
+
+    return glm::vec3(distance * cosf(angle), height, distance * sinf(angle));
+}
+
+// Nearest-rank percentile of sorted values
+static double GetPercentile(const std::vector<uint64_t>& sorted, double percentile) {
+    size_t rank = (size_t)ceil(percentile / 100.0 * sorted.size());
+    return Clock::ToMilliseconds(sorted[std::max<size_t>(rank, 1) - 1]);
+}
+
+static void WriteJSONString(FILE* out, const char* s) {
+    fputc('"', out);
+
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            fprintf(out, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            fprintf(out, "\\u%04x", *s);
+        else
+            fputc(*s, out);
+    }
+
+    fputc('"', out);
+}
+
+// Flies the camera around a grid of the models, drawing offscreen, and writes out the
+// results
+static int DrawScene(const SceneBenchmarkConfig_t& config, Program* program,
+    const std::vector<Model*>& models, const std::vector<std::string>& modelFiles) {
+
+    // Lay the instances out on a grid centred on the origin, each turned a little
+    // further than the last so they don't all face the same way
+    std::vector<SceneInstance_t> instances(config.gridSize * config.gridSize);
+    float extent = config.gridSize * config.spacing;
+
+    for (uint32_t i=0; i<instances.size(); ++i) {
+        SceneInstance_t& instance = instances[i];
+
+        instance.model = models[i % models.size()];
+        instance.position = glm::vec3(
+            ((i % config.gridSize) + 0.5f) * config.spacing - extent / 2.0f,
+            0.0f,
+            ((i / config.gridSize) + 0.5f) * config.spacing - extent / 2.0f);
+
+        glm::mat4 rotation = glm::rotate(glm::mat4(), 37.0f * i, glm::vec3(0.0f, 1.0f, 0.0f));
+        instance.transform.modelTransform = glm::translate(glm::mat4(), instance.position) * rotation;
+        PackMat3(instance.transform.normalTransform, glm::mat3(rotation));
+    }
+
+    // Everything is drawn offscreen at a fixed size, so neither the window nor
+    // vsync has any say in the results
+    GLuint framebuffer, renderbuffers[2];
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(2, renderbuffers);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, config.width, config.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, config.width, config.height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,  GL_RENDERBUFFER, renderbuffers[1]);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "Offscreen framebuffer is incomplete\n");
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(2, renderbuffers);
+        return EXIT_FAILURE;
+    }
+
+    glViewport(0, 0, config.width, config.height);
+
+    float radius = extent * 0.75f + 64.0f;
+    float farPlane = 2.0f * radius + extent;
+    glm::mat4 project = glm::perspectiveFov(SCENE_FIELD_OF_VIEW, (float)config.width, (float)config.height,
+        SCENE_NEAR_PLANE, farPlane);
+
+    LightBlock_t lightBlock;
+    lightBlock.position  = glm::vec4(radius, radius, 0.0f, 1.0f);
+    lightBlock.intensity = glm::vec4(1.0f);
+
+    UniformRing* uniformRing = new UniformRing(SCENE_UNIFORM_RING_SIZE);
+    RenderQueue queue;
+    CommandList commands;
+    CommandList* commandLists[] = {&commands};
+
+    std::vector<uint64_t> frameTimes;
+    frameTimes.reserve(config.frames);
+
+    uint64_t drawCalls = 0, triangles = 0, uploadBytes = 0, programBinds = 0, textureBinds = 0, glCalls = 0;
+    uint64_t perfWarnings = 0;
+
+    uint32_t totalFrames = config.warmupFrames + config.frames;
+    uint64_t frameStart = Clock::Now();
+
+    for (uint32_t frame=0; frame<totalFrames; ++frame) {
+        bool measured = frame >= config.warmupFrames;
+
+        if (config.nullGL && frame == config.warmupFrames)
+            NullGL::ResetCallCounts();
+
+        FrameSync::BeginFrame();
+        GLState::BeginFrame();
+        uniformRing->BeginFrame();
+
+        // Warmup frames all look at the start of the path
+        float t = measured ? (float)(frame - config.warmupFrames) / config.frames : 0.0f;
+        glm::vec3 eye = GetCameraPosition(t, radius);
+        glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        FrameBlock_t frameBlock;
+        frameBlock.viewTransform = project * view;
+        PackMat3(frameBlock.viewNormalTransform, glm::mat3(view));
+
+        UniformRing::Bind(UniformBlockBinding::FrameBlock, uniformRing->Push(frameBlock));
+        UniformRing::Bind(UniformBlockBinding::LightBlock, uniformRing->Push(lightBlock));
+
+        for (size_t i=0; i<instances.size(); ++i) {
+            const SceneInstance_t& instance = instances[i];
+
+            UniformRange_t transform = uniformRing->Push(instance.transform);
+            float depth = glm::clamp(glm::length(instance.position - eye) / farPlane, 0.0f, 1.0f);
+
+            for (size_t j=0; j<instance.model->GetTextureBatchCount(); ++j) {
+                queue.Push(0, program, instance.model->GetBatchTexture(j),
+                    instance.model->GetTextureBatch(j), transform, depth);
+            }
+        }
+
+        queue.Record(commands);
+
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        CommandList::Submit(commandLists, 1, *uniformRing);
+        commands.Clear();
+
+        FrameSync::EndFrame();
+        GLDebugOutput::EndFrame();
+
+        // Nothing gets swapped, so make sure the frame actually goes out
+        glFlush();
+        glfwPollEvents();
+
+        uint64_t frameEnd = Clock::Now();
+
+        if (measured) {
+            const RenderQueueStats_t& stats = queue.GetStats();
+
+            frameTimes.push_back(frameEnd - frameStart);
+            drawCalls    += stats.drawCalls;
+            triangles    += stats.trianglesDrawn;
+            programBinds += stats.programBinds;
+            textureBinds += stats.textureBinds;
+            uploadBytes  += uniformRing->GetFrameBytes();
+            perfWarnings += GLDebugOutput::GetFrameWarnings();
+        }
+
+        frameStart = frameEnd;
+    }
+
+    if (config.nullGL)
+        glCalls = NullGL::GetTotalCalls();
+
+    // Report
+    FILE* out = config.outputFile != NULL ? fopen(config.outputFile, "w") : stdout;
+    if (out == NULL) {
+        fprintf(stderr, "Failed to open %s for writing\n", config.outputFile);
+        out = stdout;
+    }
+
+    std::vector<uint64_t> sorted(frameTimes);
+    std::sort(sorted.begin(), sorted.end());
+
+    uint64_t totalTime = 0;
+    for (size_t i=0; i<frameTimes.size(); ++i)
+        totalTime += frameTimes[i];
+
+    double frames = (double)std::max<size_t>(frameTimes.size(), 1);
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"renderer\": ");
+    WriteJSONString(out, (const char*)glGetString(GL_RENDERER));
+    fprintf(out, ",\n  \"version\": ");
+    WriteJSONString(out, (const char*)glGetString(GL_VERSION));
+    fprintf(out, ",\n  \"resolution\": [%d, %d],\n", config.width, config.height);
+
+    fprintf(out, "  \"models\": [");
+    for (size_t i=0; i<modelFiles.size(); ++i) {
+        fprintf(out, i > 0 ? ", " : "");
+        WriteJSONString(out, modelFiles[i].c_str());
+    }
+    fprintf(out, "],\n");
+
+    fprintf(out, "  \"gridSize\": %u,\n", config.gridSize);
+    fprintf(out, "  \"instances\": %u,\n", (uint32_t)instances.size());
+    fprintf(out, "  \"warmupFrames\": %u,\n", config.warmupFrames);
+    fprintf(out, "  \"frames\": %u,\n", (uint32_t)frameTimes.size());
+
+    if (!sorted.empty()) {
+        fprintf(out, "  \"frameTimeMs\": {\"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+            Clock::ToMilliseconds(totalTime) / frames,
+            Clock::ToMilliseconds(sorted.front()),
+            GetPercentile(sorted, 50.0), GetPercentile(sorted, 95.0), GetPercentile(sorted, 99.0),
+            Clock::ToMilliseconds(sorted.back()));
+    }
+
+    fprintf(out, "  \"perFrame\": {\"drawCalls\": %.1f, \"triangles\": %.1f, \"uploadBytes\": %.1f, \"programBinds\": %.1f, \"textureBinds\": %.1f",
+        drawCalls / frames, triangles / frames, uploadBytes / frames, programBinds / frames, textureBinds / frames);
+
+    if (GLDebugOutput::IsEnabled())
+        fprintf(out, ", \"perfWarnings\": %.2f", perfWarnings / frames);
+
+    if (config.nullGL)
+        fprintf(out, ", \"glCalls\": %.1f", glCalls / frames);
+
+    fprintf(out, "}\n}\n");
+
+    if (out != stdout)
+        fclose(out);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(2, renderbuffers);
+
+    delete uniformRing;
+
+    return EXIT_SUCCESS;
+}
+
+int RunSceneBenchmark(const SceneBenchmarkConfig_t& config) {
+    Program* program = MakeSceneProgram();
+    if (program == NULL) {
+        fprintf(stderr, "Unable to build the scene program\n");
+        return EXIT_FAILURE;
+    }
+
+    program->Bind();
+    Program::SetUniform(program->GetUniform("diffuseSampler"), (GLint)0);
+
+    // Models, all sharing one arena and the rocket's textures
+    GLsizei stride = 8*sizeof(GLfloat);
+    VertexAttributeBinding_t vertFmt[] = {
+        {0, 3, GL_FLOAT, GL_FALSE, stride, BUFFER_OFFSET(0)},
+        {1, 3, GL_FLOAT, GL_FALSE, stride, BUFFER_OFFSET(3*sizeof(GLfloat))},
+        {2, 2, GL_FLOAT, GL_FALSE, stride, BUFFER_OFFSET(6*sizeof(GLfloat))}
+    };
+
+    GeometryArena* arena = new GeometryArena(vertFmt, 3, IndexType::UnsignedShortIndex,
+        SCENE_ARENA_VERTEX_CAPACITY, SCENE_ARENA_INDEX_CAPACITY);
+
+    std::vector<Texture*> textures;
+    for (size_t i=0; i<sizeof(SCENE_TEXTURE_FILES)/sizeof(SCENE_TEXTURE_FILES[0]); ++i)
+        textures.push_back(Texture::LoadFromFile(SCENE_TEXTURE_FILES[i]));
+
+    std::vector<Mesh*> meshes;
+    std::vector<Model*> models;
+    std::vector<std::string> modelFiles;
+
+    ModelLoader* loader = OpenModel(SCENE_MODEL_FILE, true);
+    if (loader != NULL && loader->IsValid()) {
+        models.push_back(LoadSceneModel(arena, loader, textures, meshes));
+        modelFiles.push_back(SCENE_MODEL_FILE);
+    }
+    delete loader;
+
+    for (size_t i=0; i<config.objFiles.size(); ++i) {
+        loader = OpenModel(config.objFiles[i], false);
+        if (loader == NULL || !loader->IsValid()) {
+            fprintf(stderr, "Skipping %s, which didn't load\n", config.objFiles[i].c_str());
+            delete loader;
+            continue;
+        }
+
+        // OBJ models get the first texture on everything
+        models.push_back(LoadSceneModel(arena, loader, std::vector<Texture*>(1, textures[0]), meshes));
+        modelFiles.push_back(config.objFiles[i]);
+        delete loader;
+    }
+
+    int result = EXIT_FAILURE;
+
+    if (models.empty())
+        fprintf(stderr, "No models to draw\n");
+    else
+        result = DrawScene(config, program, models, modelFiles);
+
+    // Cleanup
+    for (size_t i=0; i<models.size(); ++i)
+        delete models[i];
+
+    for (size_t i=0; i<meshes.size(); ++i)
+        delete meshes[i];
+
+    delete arena;
+
+    for (size_t i=0; i<textures.size(); ++i)
+        delete textures[i];
+
+    delete program;
+    FrameSync::Shutdown();
+
+    return result;
+}
@@ -0,0 +1,43 @@
+#ifndef SCENEBENCHMARK_H
+#define SCENEBENCHMARK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * SceneBenchmarkConfig_t - What RunSceneBenchmark draws, and for how long
+ */
+typedef struct {
+    // Instances along each side of a square grid. The rocket and any OBJ models take
+    // turns filling the cells.
+    uint32_t gridSize;
+    float spacing;
+    std::vector<std::string> objFiles;
+
+    // Frames measured, after warmupFrames that aren't
+    uint32_t frames;
+    uint32_t warmupFrames;
+
+    // Size of the offscreen framebuffer everything is drawn into
+    int width;
+    int height;
+
+    // Where the JSON report goes, or NULL for stdout
+    const char* outputFile;
+
+    // Whether the null driver is loaded, which also reports GL calls per frame
+    bool nullGL;
+} SceneBenchmarkConfig_t;
+
+/**
+ * RunSceneBenchmark
+ * Draws a grid of model instances into an offscreen framebuffer, with the camera flying
+ * a fixed path around it, and reports frame time percentiles along with draw calls,
+ * triangles and bytes uploaded per frame as JSON. Every run draws exactly the same
+ * frames, so results can be compared between machines and drivers, e.g. a software
+ * rasterizer or NullGL. Needs the GL functions loaded; returns an exit code.
+ */
+int RunSceneBenchmark(const SceneBenchmarkConfig_t& config);
+
+#endif
@@ -14,9 +14,12 @@ template <ShaderType::ShaderType type>
 class Shader {
 private:
     GLuint shaderHandle;
-    GLint  compileResult;
 
-    Shader() : shaderHandle(glCreateShader(type)), compileResult(GL_FALSE) { }
+    // Only asked for when first needed, since asking waits for the compile to finish
+    mutable GLint compileResult;
+    mutable bool  compileChecked;
+
+    Shader() : shaderHandle(glCreateShader(type)), compileResult(GL_FALSE), compileChecked(false) { }
 
     void SetSource(const char* source) {
         glShaderSource(shaderHandle, 1, &source, NULL);
@@ -24,13 +27,24 @@ private:
 
     void Compile() {
         glCompileShader(shaderHandle);
-        glGetShaderiv(shaderHandle, GL_COMPILE_STATUS, &compileResult);
     }
 
 public:
     ~Shader() {  glDeleteShader(shaderHandle); }
 
     static Shader* CompileFromSource(const std::string& source) {
+        Shader* shader = StartCompileFromSource(source);
+        shader->IsValid();
+
+        return shader;
+    }
+
+    /**
+     * StartCompileFromSource
+     * Like CompileFromSource, but doesn't wait for the result. The driver is free to
+     * compile in the background until something asks whether it worked.
+     */
+    static Shader* StartCompileFromSource(const std::string& source) {
         Shader* shader = new Shader();
         shader->SetSource(source.c_str());
         shader->Compile();
@@ -39,6 +53,11 @@ public:
     }
 
     bool IsValid() const {
+        if (!compileChecked) {
+            glGetShaderiv(shaderHandle, GL_COMPILE_STATUS, &compileResult);
+            compileChecked = true;
+        }
+
         return shaderHandle != 0 && compileResult == GL_TRUE;
     }
 
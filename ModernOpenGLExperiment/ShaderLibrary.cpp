@@ -0,0 +1,503 @@
+#include "ShaderLibrary.h"
+#include "Clock.h"
+#include "CPUProfiler.h"
+#include "GLFunctions.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <direct.h>
+#define MAKE_DIRECTORY(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MAKE_DIRECTORY(path) mkdir(path, 0755)
+#endif
+
+// KHR_parallel_shader_compile, and ARB_parallel_shader_compile before it
+#define GL_COMPLETION_STATUS 0x91B1
+
+// Let the driver use as many threads as it wants
+#define SHADER_COMPILER_THREADS 0xFFFFFFFF
+
+// ARB_get_program_binary
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH           0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS      0x87FE
+
+// "GLPB", then bumped whenever the header changes
+#define PROGRAM_CACHE_MAGIC   0x42504C47
+#define PROGRAM_CACHE_VERSION 1
+
+typedef void (CODEGEN_FUNCPTR *PFNMAXSHADERCOMPILERTHREADS)(GLuint count);
+typedef void (CODEGEN_FUNCPTR *PFNGETPROGRAMBINARY)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, GLvoid* binary);
+typedef void (CODEGEN_FUNCPTR *PFNPROGRAMBINARY)(GLuint program, GLenum binaryFormat, const GLvoid* binary, GLsizei length);
+typedef void (CODEGEN_FUNCPTR *PFNPROGRAMPARAMETERI)(GLuint program, GLenum pname, GLint value);
+
+static PFNGETPROGRAMBINARY getProgramBinary = NULL;
+static PFNPROGRAMBINARY programBinary = NULL;
+static PFNPROGRAMPARAMETERI programParameteri = NULL;
+
+/**
+ * ProgramCacheHeader_t - Starts every cached program file, followed by the binary
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+
+    // How long building the program from source took, in ns
+    uint64_t buildTime;
+
+    GLenum  format;
+    GLsizei length;
+} ProgramCacheHeader_t;
+
+// 64-bit FNV-1a, carrying on from hash
+static uint64_t Hash64(uint64_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    for (size_t i=0; i<length; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static uint64_t HashSource(uint64_t hash, ShaderType::ShaderType type, const std::string& source) {
+    uint32_t typeValue = (uint32_t)type;
+    hash = Hash64(hash, &typeValue, sizeof(typeValue));
+
+    return Hash64(hash, source.c_str(), source.size() + 1);
+}
+
+ShaderLibrary::ShaderLibrary() : initialized(false), parallelCompile(false), driverHash(0) {
+    cacheStats.hits = 0;
+    cacheStats.misses = 0;
+    cacheStats.rejected = 0;
+    cacheStats.stored = 0;
+    cacheStats.timeSaved = 0;
+}
+
+void ShaderLibrary::Initialize() {
+    if (initialized)
+        return;
+
+    initialized = true;
+
+    static const struct {
+        const char* extension;
+        const char* function;
+    } PARALLEL_COMPILE[] = {
+        {"GL_KHR_parallel_shader_compile", "glMaxShaderCompilerThreadsKHR"},
+        {"GL_ARB_parallel_shader_compile", "glMaxShaderCompilerThreadsARB"}
+    };
+
+    for (size_t i=0; i<sizeof(PARALLEL_COMPILE)/sizeof(PARALLEL_COMPILE[0]) && !parallelCompile; ++i) {
+        if (!GLFunction::HasExtension(PARALLEL_COMPILE[i].extension))
+            continue;
+
+        PFNMAXSHADERCOMPILERTHREADS maxShaderCompilerThreads =
+            (PFNMAXSHADERCOMPILERTHREADS)glfwGetProcAddress(PARALLEL_COMPILE[i].function);
+
+        if (maxShaderCompilerThreads != NULL) {
+            maxShaderCompilerThreads(SHADER_COMPILER_THREADS);
+            parallelCompile = true;
+        }
+    }
+}
+
+bool ShaderLibrary::SetCacheDirectory(const char* directory) {
+    cacheDirectory.clear();
+
+    if (!GLFunction::HasExtension("GL_ARB_get_program_binary"))
+        return false;
+
+    getProgramBinary  = (PFNGETPROGRAMBINARY)glfwGetProcAddress("glGetProgramBinary");
+    programBinary     = (PFNPROGRAMBINARY)glfwGetProcAddress("glProgramBinary");
+    programParameteri = (PFNPROGRAMPARAMETERI)glfwGetProcAddress("glProgramParameteri");
+
+    if (getProgramBinary == NULL || programBinary == NULL || programParameteri == NULL)
+        return false;
+
+    // Some drivers have the extension without any formats to save in
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats == 0)
+        return false;
+
+    // Binaries only work with exactly the driver that made them
+    const GLenum DRIVER_STRINGS[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+
+    driverHash = 14695981039346656037ull;
+    for (size_t i=0; i<sizeof(DRIVER_STRINGS)/sizeof(DRIVER_STRINGS[0]); ++i) {
+        const char* value = (const char*)glGetString(DRIVER_STRINGS[i]);
+        driverHash = Hash64(driverHash, value, strlen(value) + 1);
+    }
+
+    // Fails harmlessly if it's already there, and if it can't be made, nothing gets
+    // cached and nothing breaks
+    MAKE_DIRECTORY(directory);
+
+    cacheDirectory = directory;
+    return true;
+}
+
+std::string ShaderLibrary::GetCachePath(uint64_t key) const {
+    char fileName[32];
+    sprintf(fileName, "/%016llx.bin", (unsigned long long)key);
+
+    return cacheDirectory + fileName;
+}
+
+Program* ShaderLibrary::LoadCachedProgram(ProgramEntry_t& program) {
+    PROFILE_ZONE("ShaderLibrary::LoadCachedProgram");
+    uint64_t start = Clock::Now();
+
+    FILE* file = fopen(GetCachePath(program.cacheKey).c_str(), "rb");
+    if (file == NULL) {
+        ++cacheStats.misses;
+        return NULL;
+    }
+
+    ProgramCacheHeader_t header;
+    std::vector<uint8_t> binary;
+
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == PROGRAM_CACHE_MAGIC && header.version == PROGRAM_CACHE_VERSION &&
+        header.key == program.cacheKey && header.length > 0;
+
+    // The length comes from the file, so a damaged one could ask for anything. Only
+    // trust it if that much is actually left to read.
+    if (valid) {
+        long binaryStart = ftell(file);
+        valid = binaryStart >= 0 && fseek(file, 0, SEEK_END) == 0 &&
+            ftell(file) - binaryStart >= header.length && fseek(file, binaryStart, SEEK_SET) == 0;
+    }
+
+    if (valid) {
+        binary.resize(header.length);
+        valid = fread(&binary[0], 1, binary.size(), file) == binary.size();
+    }
+
+    fclose(file);
+
+    if (!valid) {
+        ++cacheStats.misses;
+        return NULL;
+    }
+
+    program.program = new Program();
+    programBinary(program.program->GetHandle(), header.format, &binary[0], header.length);
+
+    // A driver that doesn't like the binary fails the "link"
+    if (!program.program->FinishLink()) {
+        delete program.program;
+        program.program = NULL;
+
+        ++cacheStats.misses;
+        ++cacheStats.rejected;
+        return NULL;
+    }
+
+    program.stats.linkTime = Clock::Now() - start;
+    program.stats.cached = true;
+    program.linked = true;
+    program.finished = true;
+    program.valid = true;
+
+    ++cacheStats.hits;
+    cacheStats.timeSaved += (int64_t)header.buildTime - (int64_t)program.stats.linkTime;
+
+    return program.program;
+}
+
+void ShaderLibrary::StoreCachedProgram(const ProgramEntry_t& program) {
+    PROFILE_ZONE("ShaderLibrary::StoreCachedProgram");
+
+    GLint length = 0;
+    glGetProgramiv(program.program->GetHandle(), GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    ProgramCacheHeader_t header;
+    header.magic = PROGRAM_CACHE_MAGIC;
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = program.cacheKey;
+    header.buildTime = program.stats.compileTime + program.stats.linkTime;
+
+    std::vector<uint8_t> binary(length);
+    getProgramBinary(program.program->GetHandle(), length, &header.length, &header.format, &binary[0]);
+    if (header.length <= 0)
+        return;
+
+    FILE* file = fopen(GetCachePath(program.cacheKey).c_str(), "wb");
+    if (file == NULL)
+        return;
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(&binary[0], 1, header.length, file) == (size_t)header.length;
+
+    // A partly written file would just fail to load next time, but there's no point
+    // keeping it around
+    if (fclose(file) != 0 || !written) {
+        remove(GetCachePath(program.cacheKey).c_str());
+        return;
+    }
+
+    ++cacheStats.stored;
+}
+
+void ShaderLibrary::StartLink(Program* program) const {
+    if (IsCaching())
+        programParameteri(program->GetHandle(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    program->StartLink();
+}
+
+ShaderLibrary::~ShaderLibrary() {
+    for (size_t i=0; i<programs.size(); ++i)
+        delete programs[i].program;
+
+    for (size_t i=0; i<shaders.size(); ++i) {
+        switch (shaders[i].type) {
+            case ShaderType::VertexShader:   delete (VertexShader*)shaders[i].shader;   break;
+            case ShaderType::GeometryShader: delete (GeometryShader*)shaders[i].shader; break;
+            case ShaderType::FragmentShader: delete (FragmentShader*)shaders[i].shader; break;
+        }
+    }
+}
+
+template <ShaderType::ShaderType T>
+Shader<T>* ShaderLibrary::GetShader(const std::string& source, ProgramEntry_t& program) {
+    uint32_t hash = UniformName::Hash(source.c_str(), source.size()) ^ (uint32_t)T;
+
+    auto range = shaderIndex.equal_range(hash);
+    for (auto it=range.first; it!=range.second; ++it) {
+        const ShaderEntry_t& entry = shaders[it->second];
+
+        if (entry.type == T && entry.source == source) {
+            program.shaders.push_back(it->second);
+            ++program.stats.sharedShaders;
+
+            return (Shader<T>*)entry.shader;
+        }
+    }
+
+    uint64_t start = Clock::Now();
+    Shader<T>* shader = Shader<T>::StartCompileFromSource(source);
+    program.stats.compileTime += Clock::Now() - start;
+
+    ShaderEntry_t entry = {T, source, shader};
+    shaderIndex.insert(std::make_pair(hash, shaders.size()));
+    program.shaders.push_back(shaders.size());
+    shaders.push_back(entry);
+
+    return shader;
+}
+
+void ShaderLibrary::AddProgram(ProgramEntry_t& program, const char* name) {
+    program.stats.name = name;
+
+    programs.push_back(program);
+}
+
+Program* ShaderLibrary::AddProgram(const char* name, const std::string& vss, const std::string& fss) {
+    PROFILE_ZONE("ShaderLibrary::AddProgram");
+    Initialize();
+
+    ProgramEntry_t program = {};
+
+    if (IsCaching()) {
+        program.cacheKey = HashSource(driverHash, ShaderType::VertexShader, vss);
+        program.cacheKey = HashSource(program.cacheKey, ShaderType::FragmentShader, fss);
+
+        if (LoadCachedProgram(program) != NULL) {
+            AddProgram(program, name);
+            return program.program;
+        }
+    }
+
+    VertexShader* vs = GetShader<ShaderType::VertexShader>(vss, program);
+    FragmentShader* fs = GetShader<ShaderType::FragmentShader>(fss, program);
+
+    program.linkStart = Clock::Now();
+    program.program = new Program();
+    program.program->Attach(vs);
+    program.program->Attach(fs);
+    StartLink(program.program);
+
+    AddProgram(program, name);
+    return program.program;
+}
+
+Program* ShaderLibrary::AddProgram(const char* name, const std::string& vss, const std::string& gss, const std::string& fss) {
+    PROFILE_ZONE("ShaderLibrary::AddProgram");
+    Initialize();
+
+    ProgramEntry_t program = {};
+
+    if (IsCaching()) {
+        program.cacheKey = HashSource(driverHash, ShaderType::VertexShader, vss);
+        program.cacheKey = HashSource(program.cacheKey, ShaderType::GeometryShader, gss);
+        program.cacheKey = HashSource(program.cacheKey, ShaderType::FragmentShader, fss);
+
+        if (LoadCachedProgram(program) != NULL) {
+            AddProgram(program, name);
+            return program.program;
+        }
+    }
+
+    VertexShader* vs = GetShader<ShaderType::VertexShader>(vss, program);
+    GeometryShader* gs = GetShader<ShaderType::GeometryShader>(gss, program);
+    FragmentShader* fs = GetShader<ShaderType::FragmentShader>(fss, program);
+
+    program.linkStart = Clock::Now();
+    program.program = new Program();
+    program.program->Attach(vs);
+    program.program->Attach(gs);
+    program.program->Attach(fs);
+    StartLink(program.program);
+
+    AddProgram(program, name);
+    return program.program;
+}
+
+bool ShaderLibrary::CheckShaders(const ProgramEntry_t& program) const {
+    bool valid = true;
+
+    for (size_t i=0; i<program.shaders.size(); ++i) {
+        const ShaderEntry_t& entry = shaders[program.shaders[i]];
+        const char* typeName;
+        std::string log;
+
+        switch (entry.type) {
+            case ShaderType::VertexShader:
+                typeName = "Vertex";
+                if (((VertexShader*)entry.shader)->IsValid()) continue;
+                log = ((VertexShader*)entry.shader)->GetCompileLog();
+                break;
+
+            case ShaderType::GeometryShader:
+                typeName = "Geometry";
+                if (((GeometryShader*)entry.shader)->IsValid()) continue;
+                log = ((GeometryShader*)entry.shader)->GetCompileLog();
+                break;
+
+            default:
+                typeName = "Fragment";
+                if (((FragmentShader*)entry.shader)->IsValid()) continue;
+                log = ((FragmentShader*)entry.shader)->GetCompileLog();
+                break;
+        }
+
+        fprintf(stderr, "%s Shader Compile Error in %s:\n%s\n", typeName, program.stats.name, log.c_str());
+        valid = false;
+    }
+
+    return valid;
+}
+
+ShaderLibrary::ProgramEntry_t* ShaderLibrary::FindProgram(Program* program) {
+    for (size_t i=0; i<programs.size(); ++i) {
+        if (programs[i].program == program)
+            return &programs[i];
+    }
+
+    return NULL;
+}
+
+bool ShaderLibrary::PollCompletion(ProgramEntry_t& program) {
+    if (program.linked)
+        return true;
+
+    GLint complete = GL_FALSE;
+    glGetProgramiv(program.program->GetHandle(), GL_COMPLETION_STATUS, &complete);
+
+    if (complete) {
+        program.stats.linkTime = Clock::Now() - program.linkStart;
+        program.linked = true;
+    }
+
+    return program.linked;
+}
+
+bool ShaderLibrary::FinishProgram(ProgramEntry_t& program) {
+    if (program.finished)
+        return program.valid;
+
+    bool linked = program.program->FinishLink();
+    program.finished = true;
+
+    if (!program.linked) {
+        program.stats.linkTime = Clock::Now() - program.linkStart;
+        program.linked = true;
+    }
+
+    if (!CheckShaders(program)) {
+        program.valid = false;
+    } else if (!linked) {
+        fprintf(stderr, "Link Error in %s:\n%s\n", program.stats.name, program.program->GetLinkLog().c_str());
+        program.valid = false;
+    } else {
+        program.valid = true;
+
+        if (IsCaching())
+            StoreCachedProgram(program);
+    }
+
+    return program.valid;
+}
+
+bool ShaderLibrary::Build() {
+    PROFILE_ZONE("ShaderLibrary::Build");
+
+    // Let the driver finish everything in whatever order it likes, noting when each
+    // program is done, before asking about any of them
+    if (parallelCompile) {
+        size_t remaining = 0;
+        for (size_t i=0; i<programs.size(); ++i)
+            remaining += programs[i].linked ? 0 : 1;
+
+        while (remaining > 0) {
+            for (size_t i=0; i<programs.size(); ++i) {
+                if (!programs[i].linked && PollCompletion(programs[i]))
+                    --remaining;
+            }
+
+            if (remaining > 0)
+                std::this_thread::yield();
+        }
+    }
+
+    bool valid = true;
+
+    for (size_t i=0; i<programs.size(); ++i) {
+        if (!FinishProgram(programs[i]))
+            valid = false;
+    }
+
+    return valid;
+}
+
+bool ShaderLibrary::IsComplete(Program* program) {
+    ProgramEntry_t* entry = FindProgram(program);
+    assert(entry != NULL);
+
+    if (entry->linked)
+        return true;
+
+    return parallelCompile && PollCompletion(*entry);
+}
+
+bool ShaderLibrary::Finish(Program* program) {
+    PROFILE_ZONE("ShaderLibrary::Finish");
+
+    ProgramEntry_t* entry = FindProgram(program);
+    assert(entry != NULL);
+
+    return FinishProgram(*entry);
+}
@@ -0,0 +1,186 @@
+#ifndef SHADERLIBRARY_H
+#define SHADERLIBRARY_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Rendering.h"
+#include "Shader.h"
+#include "Program.h"
+
+/**
+ * ShaderProgramStats_t - How long one program took to build, in ns
+ */
+typedef struct {
+    const char* name;
+
+    // Spent in glCompileShader for the shaders this program was first to use. Drivers
+    // that compile in the background return from it early, and the rest of the compile
+    // ends up in linkTime.
+    uint64_t compileTime;
+
+    // From starting the link until it was known to be done
+    uint64_t linkTime;
+
+    // Shaders this program got from the library instead of compiling them itself
+    uint32_t sharedShaders;
+
+    // Loaded from the program cache, in which case linkTime is how long loading took
+    bool cached;
+} ShaderProgramStats_t;
+
+/**
+ * ShaderCacheStats_t - How the program cache did
+ */
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+
+    // Cached binaries the driver wouldn't take, e.g. after a driver update
+    uint32_t rejected;
+
+    // Binaries written for programs that missed
+    uint32_t stored;
+
+    // Build time recorded with each binary that hit, less the time loading it took, in ns
+    int64_t timeSaved;
+} ShaderCacheStats_t;
+
+/**
+ * ShaderLibrary
+ * Builds programs out of shader sources, compiling each distinct source only once no
+ * matter how many programs use it. Shaders are deduplicated by a hash of their type and
+ * source.
+ *
+ * AddProgram only starts compiles and links. Nothing asks the driver for a result until
+ * Build, so with every program added first, the driver is free to work on all of them
+ * at once. With KHR_parallel_shader_compile (or the ARB version), the driver is told to
+ * use as many threads as it likes, and Build polls for completion rather than waiting on
+ * one program at a time.
+ *
+ * With a cache directory and a driver that has ARB_get_program_binary, linked programs
+ * are also saved to disk and loaded from there next time, skipping the compile and link
+ * altogether. Binaries are keyed by a hash of every source in the program together with
+ * the GL vendor, renderer and version, so changing any of them builds afresh. Anything
+ * that goes wrong with the cache falls back to building from source without a word.
+ *
+ * The library owns its shaders and programs.
+ */
+class ShaderLibrary {
+private:
+    typedef struct {
+        ShaderType::ShaderType type;
+        std::string source;
+        void* shader;
+    } ShaderEntry_t;
+
+    typedef struct {
+        Program* program;
+        std::vector<size_t> shaders;
+        uint64_t cacheKey;
+        uint64_t linkStart;
+        bool linked;   // The driver is done with it
+        bool finished; // So are we
+        bool valid;    // And it all worked, once finished
+        ShaderProgramStats_t stats;
+    } ProgramEntry_t;
+
+    std::vector<ShaderEntry_t> shaders;
+    std::vector<ProgramEntry_t> programs;
+
+    // Hash of type and source to shader index; several sources can share a hash
+    std::multimap<uint32_t, size_t> shaderIndex;
+
+    // GL is only looked at once the first program is added
+    bool initialized;
+    bool parallelCompile;
+
+    // Where program binaries are kept, or empty if they aren't
+    std::string cacheDirectory;
+
+    // Hash of the vendor, renderer and version, which every cache key starts from
+    uint64_t driverHash;
+
+    ShaderCacheStats_t cacheStats;
+
+    std::string GetCachePath(uint64_t key) const;
+
+    // Returns the cached program for key, or NULL if there isn't a usable one
+    Program* LoadCachedProgram(ProgramEntry_t& program);
+    void StoreCachedProgram(const ProgramEntry_t& program);
+
+    // Starts linking a program built from source, retrievable if it's going in the cache
+    void StartLink(Program* program) const;
+
+    template <ShaderType::ShaderType T>
+    Shader<T>* GetShader(const std::string& source, ProgramEntry_t& program);
+
+    void AddProgram(ProgramEntry_t& program, const char* name);
+
+    // Prints the compile log of any of the program's shaders that failed
+    bool CheckShaders(const ProgramEntry_t& program) const;
+
+    void Initialize();
+    ProgramEntry_t* FindProgram(Program* program);
+
+    // Asks the driver whether it's done, without waiting
+    bool PollCompletion(ProgramEntry_t& program);
+    bool FinishProgram(ProgramEntry_t& program);
+
+public:
+    /**
+     * Can be made before there's a context. GL isn't touched until the first program is
+     * added, which needs the GL functions loaded to look for KHR_parallel_shader_compile.
+     */
+    ShaderLibrary();
+    ~ShaderLibrary();
+
+    /**
+     * SetCacheDirectory
+     * Keeps program binaries in directory, creating it if need be. Only programs added
+     * afterwards use the cache. Returns false if the driver can't provide binaries.
+     */
+    bool SetCacheDirectory(const char* directory);
+
+    /**
+     * AddProgram
+     * Starts building a program from the given sources. Returns it, but it mustn't be
+     * used until Build has finished it.
+     */
+    Program* AddProgram(const char* name, const std::string& vss, const std::string& fss);
+    Program* AddProgram(const char* name, const std::string& vss, const std::string& gss, const std::string& fss);
+
+    /**
+     * Build
+     * Waits for every program added so far to finish, printing the log of any shader or
+     * program that failed. Returns false if any did.
+     */
+    bool Build();
+
+    /**
+     * IsComplete
+     * Returns true once the driver has finished building program, without waiting for
+     * it. Without KHR_parallel_shader_compile there's no asking, so it stays false until
+     * the program is finished.
+     */
+    bool IsComplete(Program* program);
+
+    /**
+     * Finish
+     * Waits for just one program added earlier, like Build. Returns false if it failed.
+     */
+    bool Finish(Program* program);
+
+    bool IsParallelCompile() const { return parallelCompile; }
+
+    size_t GetShaderCount() const { return shaders.size(); }
+    size_t GetProgramCount() const { return programs.size(); }
+    const ShaderProgramStats_t& GetProgramStats(size_t i) const { return programs[i].stats; }
+
+    bool IsCaching() const { return !cacheDirectory.empty(); }
+    const ShaderCacheStats_t& GetCacheStats() const { return cacheStats; }
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "ShaderPermutations.h"
+#include "ShaderPreprocessor.h"
+#include "Clock.h"
+#include "CPUProfiler.h"
+
+#include <cassert>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Waits for a variant's preprocessing, helping out with jobs if we're a worker
+static void WaitForPreprocessing(JobCounter* counter) {
+    if (JobSystem::GetWorkerIndex() >= 0) {
+        JobSystem::Wait(counter);
+        return;
+    }
+
+    while (counter->pending > 0)
+        std::this_thread::yield();
+}
+
+ShaderPermutations::ShaderPermutations(ShaderLibrary* library, const ShaderPermutationDesc_t& desc) :
+    library(library), desc(desc), precompiled(0), lazyCompiles(0), stalls(0), stallTime(0) {
+
+    assert(library != NULL);
+    assert(desc.featureCount <= SHADER_MAX_FEATURES);
+    assert(desc.geometryMask == 0 || desc.geometryFile != NULL);
+}
+
+ShaderPermutations::~ShaderPermutations() {
+    for (auto it=variants.begin(); it!=variants.end(); ++it) {
+        WaitForPreprocessing(&it->second->preprocessed);
+        delete it->second;
+    }
+}
+
+void ShaderPermutations::PreprocessJob(void* data, uint32_t, uint32_t) {
+    Variant_t* variant = (Variant_t*)data;
+    variant->owner->Preprocess(variant);
+}
+
+void ShaderPermutations::Preprocess(Variant_t* variant) {
+    PROFILE_ZONE("ShaderPermutations::Preprocess");
+    uint64_t start = Clock::Now();
+
+    std::vector<const char*> defines;
+    for (uint32_t i=0; i<desc.featureCount; ++i) {
+        if (variant->mask & (1u << i))
+            defines.push_back(desc.features[i]);
+    }
+
+    bool processed =
+        ShaderPreprocessor::Process(desc.directory, desc.vertexFile, defines, variant->vertexSource, variant->error) &&
+        ShaderPreprocessor::Process(desc.directory, desc.fragmentFile, defines, variant->fragmentSource, variant->error);
+
+    if (processed && (variant->mask & desc.geometryMask) != 0)
+        ShaderPreprocessor::Process(desc.directory, desc.geometryFile, defines, variant->geometrySource, variant->error);
+
+    variant->preprocessTime = Clock::Now() - start;
+}
+
+ShaderPermutations::Variant_t* ShaderPermutations::AddVariant(uint32_t mask) {
+    assert(desc.featureCount == SHADER_MAX_FEATURES || mask < (1u << desc.featureCount));
+
+    Variant_t* variant = new Variant_t();
+    variant->owner = this;
+    variant->mask = mask;
+    variant->state = Preprocessing;
+    variant->preprocessTime = 0;
+    variant->program = NULL;
+
+    variant->name = desc.name;
+    for (uint32_t i=0; i<desc.featureCount; ++i) {
+        if (mask & (1u << i))
+            variant->name = variant->name + "+" + desc.features[i];
+    }
+
+    variants[mask] = variant;
+    return variant;
+}
+
+void ShaderPermutations::Submit(Variant_t* variant) {
+    if (!variant->error.empty()) {
+        fprintf(stderr, "Unable to preprocess %s: %s\n", variant->name.c_str(), variant->error.c_str());
+        variant->state = Failed;
+        return;
+    }
+
+    if (variant->geometrySource.empty()) {
+        variant->program = library->AddProgram(variant->name.c_str(), variant->vertexSource,
+            variant->fragmentSource);
+    } else {
+        variant->program = library->AddProgram(variant->name.c_str(), variant->vertexSource,
+            variant->geometrySource, variant->fragmentSource);
+    }
+
+    // The library keeps its own copy of every source
+    std::string().swap(variant->vertexSource);
+    std::string().swap(variant->geometrySource);
+    std::string().swap(variant->fragmentSource);
+
+    variant->state = Compiling;
+}
+
+void ShaderPermutations::Finish(Variant_t* variant) {
+    if (!library->Finish(variant->program)) {
+        variant->state = Failed;
+        return;
+    }
+
+    if (desc.onCreate != NULL)
+        desc.onCreate(variant->program, variant->mask);
+
+    variant->state = Ready;
+}
+
+void ShaderPermutations::Precompile(uint32_t mask) {
+    if (variants.find(mask) != variants.end())
+        return;
+
+    Variant_t* variant = AddVariant(mask);
+    ++precompiled;
+
+    if (JobSystem::GetWorkerIndex() >= 0)
+        JobSystem::Run(&PreprocessJob, variant, &variant->preprocessed);
+    else
+        Preprocess(variant);
+}
+
+void ShaderPermutations::Update() {
+    for (auto it=variants.begin(); it!=variants.end(); ++it) {
+        Variant_t* variant = it->second;
+
+        if (variant->state == Preprocessing && variant->preprocessed.pending == 0)
+            Submit(variant);
+
+        if (variant->state == Compiling && library->IsComplete(variant->program))
+            Finish(variant);
+    }
+}
+
+Program* ShaderPermutations::Get(uint32_t mask) {
+    auto it = variants.find(mask);
+    if (it != variants.end() && it->second->state == Ready)
+        return it->second->program;
+
+    PROFILE_ZONE("ShaderPermutations::Get");
+    uint64_t start = Clock::Now();
+
+    Variant_t* variant;
+    if (it == variants.end()) {
+        variant = AddVariant(mask);
+        Preprocess(variant);
+        ++lazyCompiles;
+    } else {
+        variant = it->second;
+    }
+
+    if (variant->state == Failed)
+        return NULL;
+
+    if (variant->state == Preprocessing) {
+        WaitForPreprocessing(&variant->preprocessed);
+        Submit(variant);
+    }
+
+    if (variant->state == Compiling)
+        Finish(variant);
+
+    ++stalls;
+    stallTime += Clock::Now() - start;
+
+    return variant->state == Ready ? variant->program : NULL;
+}
+
+ShaderPermutationStats_t ShaderPermutations::GetStats() const {
+    ShaderPermutationStats_t stats;
+    stats.variants = (uint32_t)variants.size();
+    stats.precompiled = precompiled;
+    stats.lazyCompiles = lazyCompiles;
+    stats.stalls = stalls;
+    stats.stallTime = stallTime;
+    stats.preprocessTime = 0;
+
+    for (auto it=variants.begin(); it!=variants.end(); ++it) {
+        if (it->second->preprocessed.pending == 0)
+            stats.preprocessTime += it->second->preprocessTime;
+    }
+
+    return stats;
+}
@@ -0,0 +1,161 @@
+#ifndef SHADERPERMUTATIONS_H
+#define SHADERPERMUTATIONS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "JobSystem.h"
+#include "Program.h"
+#include "ShaderLibrary.h"
+
+// Features a set of permutations can have, one bit each in a mask
+#define SHADER_MAX_FEATURES 32
+
+/**
+ * ShaderPermutationDesc_t - The shader files behind a set of permutations, and the
+ * features they can be built with
+ */
+typedef struct {
+    // Prefix for the name each variant gets in the ShaderLibrary's stats
+    const char* name;
+
+    // Directory the files, and anything they include, are read from
+    const char* directory;
+
+    const char* vertexFile;
+    const char* geometryFile; // Can be NULL if geometryMask is 0
+    const char* fragmentFile;
+
+    // Feature i is bit i of a mask, and is #defined by its name when the bit is set
+    const char* const* features;
+    uint32_t featureCount;
+
+    // Variants with any of these bits set get the geometry stage too
+    uint32_t geometryMask;
+
+    // Called with each variant once it's built, to set the uniforms that never change.
+    // Can be NULL.
+    void (*onCreate)(Program* program, uint32_t mask);
+} ShaderPermutationDesc_t;
+
+/**
+ * ShaderPermutationStats_t - How getting hold of variants went
+ */
+typedef struct {
+    uint32_t variants;
+
+    // Variants asked for by Precompile before anything needed them
+    uint32_t precompiled;
+
+    // Variants nobody saw coming, which Get had to build from scratch
+    uint32_t lazyCompiles;
+
+    // Times Get had to wait for a variant, precompiled or not, and for how long in ns
+    uint32_t stalls;
+    uint64_t stallTime;
+
+    // Spent reading and expanding files, on whichever threads did it, in ns
+    uint64_t preprocessTime;
+} ShaderPermutationStats_t;
+
+/**
+ * ShaderPermutations
+ * One set of shader files, built into as many variants as there are combinations of
+ * features anyone uses. A variant is identified by its feature bitmask, and only built
+ * the first time it's asked for, after which it's kept for good.
+ *
+ * Get builds a variant then and there if it has to. To keep that off the frame, variants
+ * that are likely to be wanted can be asked for early with Precompile, which reads and
+ * preprocesses their files on a job. Update, called once a frame on the GL thread, hands
+ * whatever has been preprocessed to the ShaderLibrary, and with KHR_parallel_shader_compile
+ * finishes variants the driver has built in the background, so by the time something
+ * draws with them Get just returns them. Without the extension, Get still has to wait
+ * for the driver, but only for the compile itself.
+ *
+ * Variants share shaders through the ShaderLibrary (which owns their programs) whenever
+ * a stage comes out the same, so features only cost compiles in the stages that use them.
+ * Everything except the preprocessing has to happen on the GL thread.
+ */
+class ShaderPermutations {
+private:
+    typedef enum {
+        Preprocessing, // Reading files, maybe on a job
+        Compiling,     // In the ShaderLibrary
+        Ready,
+        Failed
+    } VariantState_t;
+
+    typedef struct Variant_t {
+        ShaderPermutations* owner;
+        uint32_t mask;
+        std::string name;
+        VariantState_t state;
+
+        // Filled in by the preprocessing, which is done once preprocessed is 0
+        std::string vertexSource;
+        std::string geometrySource;
+        std::string fragmentSource;
+        std::string error;
+        uint64_t preprocessTime;
+        JobCounter preprocessed;
+
+        Program* program;
+    } Variant_t;
+
+    ShaderLibrary* library;
+    ShaderPermutationDesc_t desc;
+
+    std::map<uint32_t, Variant_t*> variants;
+
+    uint32_t precompiled;
+    uint32_t lazyCompiles;
+    uint32_t stalls;
+    uint64_t stallTime;
+
+    static void PreprocessJob(void* data, uint32_t begin, uint32_t end);
+    void Preprocess(Variant_t* variant);
+
+    Variant_t* AddVariant(uint32_t mask);
+
+    // Hands a preprocessed variant to the library
+    void Submit(Variant_t* variant);
+    void Finish(Variant_t* variant);
+
+public:
+    /**
+     * Variants are built in library, which has to outlive this
+     */
+    ShaderPermutations(ShaderLibrary* library, const ShaderPermutationDesc_t& desc);
+
+    /**
+     * Waits for any preprocessing still going, so needs to be on a worker thread if
+     * Precompile was
+     */
+    ~ShaderPermutations();
+
+    /**
+     * Precompile
+     * Starts building the variant for mask, if it hasn't been already. Preprocessing
+     * runs as a job when called on a worker thread, so this can be called before there's
+     * a context; the compile starts with the first Update or Get after that.
+     */
+    void Precompile(uint32_t mask);
+
+    /**
+     * Update
+     * Moves precompiled variants along without waiting on anything
+     */
+    void Update();
+
+    /**
+     * Get
+     * Returns the variant for mask, building it or waiting for it if it isn't ready yet.
+     * Returns NULL if it failed to build, having printed why.
+     */
+    Program* Get(uint32_t mask);
+
+    ShaderPermutationStats_t GetStats() const;
+};
+
+#endif
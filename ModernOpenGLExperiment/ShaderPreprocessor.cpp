@@ -0,0 +1,168 @@
+#include "ShaderPreprocessor.h"
+#include "CPUProfiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+bool ShaderPreprocessor::ReadFile(const std::string& path, std::string& contents) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+        return false;
+
+    char buffer[4096];
+    size_t read;
+
+    contents.clear();
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        contents.append(buffer, read);
+
+    fclose(file);
+    return true;
+}
+
+// Returns the name if line is #include "name", or an empty string if it's anything else
+static std::string GetInclude(const std::string& line) {
+    size_t i = line.find_first_not_of(" \t");
+    if (i == std::string::npos || line[i] != '#')
+        return std::string();
+
+    i = line.find_first_not_of(" \t", i + 1);
+    if (i == std::string::npos || line.compare(i, 7, "include") != 0)
+        return std::string();
+
+    size_t begin = line.find('"', i + 7);
+    size_t end = begin == std::string::npos ? begin : line.find('"', begin + 1);
+    if (end == std::string::npos)
+        return std::string();
+
+    return line.substr(begin + 1, end - begin - 1);
+}
+
+// True if name appears in source as a whole identifier, not just part of one
+static bool ContainsIdentifier(const std::string& source, const char* name) {
+    std::string word(name);
+
+    for (size_t i=source.find(word); i!=std::string::npos; i=source.find(word, i + 1)) {
+        size_t end = i + word.size();
+        bool startsWord = i == 0 || !(isalnum((unsigned char)source[i - 1]) || source[i - 1] == '_');
+        bool endsWord = end == source.size() || !(isalnum((unsigned char)source[end]) || source[end] == '_');
+
+        if (startsWord && endsWord)
+            return true;
+    }
+
+    return false;
+}
+
+bool ShaderPreprocessor::Expand(const std::string& directory, const std::string& fileName, uint32_t sourceIndex,
+    std::vector<std::string>& files, std::vector<std::string>& includes, std::string& output, std::string& error) {
+
+    std::string contents;
+    if (!ReadFile(directory + "/" + fileName, contents)) {
+        error = "Unable to read " + directory + "/" + fileName;
+        return false;
+    }
+
+    uint32_t lineNumber = 0;
+    size_t begin = 0;
+
+    while (begin < contents.size()) {
+        size_t end = contents.find('\n', begin);
+        if (end == std::string::npos)
+            end = contents.size();
+
+        std::string line = contents.substr(begin, end - begin);
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+
+        begin = end + 1;
+        ++lineNumber;
+
+        std::string include = GetInclude(line);
+        if (include.empty()) {
+            output += line;
+            output += '\n';
+            continue;
+        }
+
+        char location[64];
+        sprintf(location, ", included from line %u of ", lineNumber);
+
+        if (include == fileName || std::find(includes.begin(), includes.end(), include) != includes.end()) {
+            error = include + " includes itself" + location + fileName;
+            return false;
+        }
+
+        auto seen = std::find(files.begin(), files.end(), include);
+        uint32_t includeIndex = (uint32_t)(seen - files.begin());
+        if (seen == files.end())
+            files.push_back(include);
+
+        char lineDirective[32];
+        sprintf(lineDirective, "#line 1 %u\n", includeIndex);
+        output += lineDirective;
+
+        includes.push_back(fileName);
+        bool expanded = Expand(directory, include, includeIndex, files, includes, output, error);
+        includes.pop_back();
+
+        if (!expanded) {
+            error += location + fileName;
+            return false;
+        }
+
+        sprintf(lineDirective, "#line %u %u\n", lineNumber + 1, sourceIndex);
+        output += lineDirective;
+    }
+
+    return true;
+}
+
+bool ShaderPreprocessor::Process(const char* directory, const char* fileName, const std::vector<const char*>& defines,
+    std::string& output, std::string& error) {
+
+    PROFILE_ZONE("ShaderPreprocessor::Process");
+
+    std::vector<std::string> files;
+    files.push_back(fileName);
+
+    std::vector<std::string> includes;
+    std::string expanded;
+    if (!Expand(directory, fileName, 0, files, includes, expanded, error))
+        return false;
+
+    // Nothing but comments may come before #version, so the defines go after it
+    size_t versionEnd = 0;
+    uint32_t versionLine = 0;
+
+    for (size_t begin=0; begin<expanded.size(); ) {
+        size_t end = expanded.find('\n', begin);
+        size_t i = expanded.find_first_not_of(" \t", begin);
+        ++versionLine;
+
+        if (i < end && expanded.compare(i, 8, "#version") == 0) {
+            versionEnd = end + 1;
+            break;
+        }
+
+        begin = end + 1;
+    }
+
+    std::string defineLines;
+    for (size_t i=0; i<defines.size(); ++i) {
+        if (ContainsIdentifier(expanded, defines[i]))
+            defineLines = defineLines + "#define " + defines[i] + "\n";
+    }
+
+    if (versionEnd == 0 || defineLines.empty()) {
+        output = defineLines + expanded;
+        return true;
+    }
+
+    char lineDirective[32];
+    sprintf(lineDirective, "#line %u 0\n", versionLine + 1);
+
+    output = expanded.substr(0, versionEnd) + defineLines + lineDirective + expanded.substr(versionEnd);
+    return true;
+}
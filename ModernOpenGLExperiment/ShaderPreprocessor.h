@@ -0,0 +1,48 @@
+#ifndef SHADERPREPROCESSOR_H
+#define SHADERPREPROCESSOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * ShaderPreprocessor
+ * Turns a shader file into a source the driver can compile, doing the parts of the job
+ * GLSL leaves out.
+ *
+ * #include "file" lines are replaced with the file, read from the same directory as the
+ * top-level shader. A file can be included any number of times, e.g. for the members of
+ * an interface block that's declared both in and out, but a file that ends up including
+ * itself is an error. #line directives are written around every include, with each file
+ * getting its own source string number (the top-level file is 0, includes count up from
+ * 1 in the order they were first seen), so compile errors still point at the right line.
+ *
+ * Defines are inserted straight after #version. Only those whose names actually appear
+ * in the expanded source are, so a stage that doesn't care about a feature comes out
+ * byte for byte the same whether or not it's on, and the ShaderLibrary only compiles it
+ * once.
+ *
+ * Touches nothing but the files it reads, so it's safe to run on any thread.
+ */
+class ShaderPreprocessor {
+private:
+    static bool ReadFile(const std::string& path, std::string& contents);
+
+    // files holds every file seen so far, in source string order, and includes the ones
+    // currently being expanded
+    static bool Expand(const std::string& directory, const std::string& fileName, uint32_t sourceIndex,
+        std::vector<std::string>& files, std::vector<std::string>& includes, std::string& output, std::string& error);
+
+    ShaderPreprocessor() {}
+
+public:
+    /**
+     * Process
+     * Expands directory/fileName into output with the given names defined. Returns false
+     * with a message in error if it or anything it includes can't be read.
+     */
+    static bool Process(const char* directory, const char* fileName, const std::vector<const char*>& defines,
+        std::string& output, std::string& error);
+};
+
+#endif
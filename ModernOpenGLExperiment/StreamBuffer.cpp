@@ -0,0 +1,59 @@
+#include "StreamBuffer.h"
+#include "GLState.h"
+
+#include <cstring>
+
+StreamBuffer::StreamBuffer(GLenum target, GLsizeiptr segmentSize) :
+    bufferHandle(0), target(target), segmentSize(segmentSize), mapped(false) {
+
+    glGenBuffers(1, &bufferHandle);
+    GLState::BindBuffer(target, bufferHandle);
+    glBufferData(target, segmentSize * FRAMES_IN_FLIGHT, NULL, GL_STREAM_DRAW);
+}
+
+StreamBuffer::~StreamBuffer() {
+    if (mapped)
+        Unmap();
+
+    GLState::ForgetBuffer(bufferHandle);
+    glDeleteBuffers(1, &bufferHandle);
+}
+
+void* StreamBuffer::Map(GLintptr offset, GLsizeiptr size) {
+    return MapSegment(FrameSync::GetFrameIndex(), offset, size);
+}
+
+void* StreamBuffer::MapSegment(GLuint segment, GLintptr offset, GLsizeiptr size) {
+    assert(!mapped);
+    assert(segment < FRAMES_IN_FLIGHT);
+    assert(offset + size <= segmentSize);
+
+    GLState::BindBuffer(target, bufferHandle);
+
+    void* data = glMapBufferRange(target, segment * segmentSize + offset, size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+    mapped = data != NULL;
+    return data;
+}
+
+void StreamBuffer::Unmap() {
+    assert(mapped);
+
+    GLState::BindBuffer(target, bufferHandle);
+    glUnmapBuffer(target);
+
+    mapped = false;
+}
+
+void StreamBuffer::Write(GLintptr offset, GLsizeiptr size, const void* data) {
+    if (size <= 0)
+        return;
+
+    void* dst = Map(offset, size);
+    if (dst == NULL)
+        return;
+
+    memcpy(dst, data, size);
+    Unmap();
+}
@@ -0,0 +1,61 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include "Rendering.h"
+#include "FrameSync.h"
+
+/**
+ * StreamBuffer
+ * A buffer object holding FRAMES_IN_FLIGHT copies ("segments") of some data that changes
+ * from frame to frame. Each frame only writes the segment for FrameSync's current frame
+ * index, which FrameSync guarantees the GPU is done reading. That lets us map it with
+ * GL_MAP_UNSYNCHRONIZED_BIT, so the driver never has to stall or make a copy.
+ */
+class StreamBuffer {
+private:
+    GLuint bufferHandle;
+    GLenum target;
+    GLsizeiptr segmentSize;
+
+    bool mapped;
+
+public:
+    StreamBuffer(GLenum target, GLsizeiptr segmentSize);
+    ~StreamBuffer();
+
+    /**
+     * Map
+     * Maps a range of this frame's segment for writing. Whatever was in the range
+     * before is discarded, so all of it has to be written.
+     *
+     * offset - Offset in bytes from the start of the segment
+     * size   - Size in bytes of the range to map
+     */
+    void* Map(GLintptr offset, GLsizeiptr size);
+
+    /**
+     * MapSegment
+     * Maps a range of any segment. Only safe to use on segments the GPU has never
+     * read from, i.e. when initializing the buffer.
+     */
+    void* MapSegment(GLuint segment, GLintptr offset, GLsizeiptr size);
+
+    void Unmap();
+
+    /**
+     * Write
+     * Copies data into a range of this frame's segment
+     */
+    void Write(GLintptr offset, GLsizeiptr size, const void* data);
+
+    GLuint GetHandle() const { return bufferHandle; }
+    GLsizeiptr GetSegmentSize() const { return segmentSize; }
+
+    /**
+     * GetSegmentOffset
+     * Offset in bytes of this frame's segment from the start of the buffer
+     */
+    GLintptr GetSegmentOffset() const { return FrameSync::GetFrameIndex() * segmentSize; }
+};
+
+#endif
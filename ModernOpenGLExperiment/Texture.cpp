@@ -1,10 +1,10 @@
 #include "Texture.h"
+#include "CPUProfiler.h"
 
 void Texture::Bind(GLuint i, Texture* texture) {
     assert(texture != NULL);
 
-    glActiveTexture(GL_TEXTURE0 + i);
-    glBindTexture(GL_TEXTURE_2D, texture->id);
+    GLState::BindTexture(i, texture->id);
 }
 
 void Texture::SetFilters(GLenum magFilter, GLenum minFilter) {
@@ -18,6 +18,8 @@ void Texture::SetRepeat(GLenum wrapS, GLenum wrapT) {
 }
 
 Texture* Texture::LoadFromFile(const char* filename) {
+    PROFILE_ZONE("Texture::LoadFromFile");
+
     // I'm just going to assume for now that the texture is a TGA
     // which GLFW has a builtin procedure for reading
 
@@ -26,6 +28,15 @@ Texture* Texture::LoadFromFile(const char* filename) {
     if (!glfwReadImage(filename, &image, GLFW_ORIGIN_UL_BIT))
         return NULL;
 
+    Texture* tex = CreateFromImage(image);
+    glfwFreeImage(&image);
+
+    return tex;
+}
+
+Texture* Texture::CreateFromImage(const GLFWimage& image) {
+    PROFILE_ZONE("Texture::CreateFromImage");
+
     Texture* tex = new Texture();
     tex->SetFilters(GL_LINEAR, GL_LINEAR);
     tex->SetRepeat(GL_REPEAT, GL_REPEAT);
@@ -42,7 +53,5 @@ Texture* Texture::LoadFromFile(const char* filename) {
         (void*)image.Data
     );
 
-    glfwFreeImage(&image);
-
     return tex;
 }
@@ -2,6 +2,7 @@
 #define TEXTURE_H
 
 #include "Rendering.h"
+#include "GLState.h"
 
 class Texture {
 private:
@@ -18,17 +19,27 @@ private:
 public:
     static Texture* LoadFromFile(const char* filename);
 
+    /**
+     * Uploads an image that has already been read, e.g. on another thread. The image
+     * still belongs to the caller.
+     */
+    static Texture* CreateFromImage(const GLFWimage& image);
+
     /**
      * Binds the given texture to the specified texture unit
      */
     static void Bind(GLuint i, Texture* texture);
 
     ~Texture() { 
+        GLState::ForgetTexture(id);
         glDeleteTextures(1, &id);
     }
 
+    /**
+     * Binds this texture to the currently active texture unit
+     */
     void Bind() const {
-        glBindTexture(GL_TEXTURE_2D, id);
+        GLState::BindTexture(id);
     }
 
     GLuint GetID() const { return id; }
@@ -26,25 +26,36 @@ glm::mat4 Trackball::GetRotationMatrix() const {
     if (!dragging)
         return view;
 
+    return GetRotationMatrix(dragStop);
+}
+
+glm::mat4 Trackball::GetLatchedRotationMatrix(int i, int j) const {
+    if (!dragging)
+        return view;
+
+    return GetRotationMatrix(ScreenToTrackballCoordinates(i,j));
+}
+
+glm::mat4 Trackball::GetRotationMatrix(const glm::vec3& stop) const {
     // If start = end, the in-progress rotation we apply
     // will be the additive identity (0 matrix), which will
     // not jive well with the view.
-    if (dragStart[0] == dragStop[0] &&
-        dragStart[1] == dragStop[1]) {
+    if (dragStart[0] == stop[0] &&
+        dragStart[1] == stop[1]) {
         
         return view;
     }
 
-    glm::vec3 axis = glm::cross(dragStart, dragStop);
+    glm::vec3 axis = glm::cross(dragStart, stop);
     
     // Make sure that the input to the acos function is <= 1
     // by normalizing the dot product of the two vectors
     // (since the ScreenToTrackballCoordinates does not
     //  guarantee normalized coordinates).
-    float mag     = glm::length(dragStart) * glm::length(dragStop);
-    float normDot = glm::dot(dragStart, dragStop) / mag;
+    float mag     = glm::length(dragStart) * glm::length(stop);
+    float normDot = glm::dot(dragStart, stop) / mag;
 
-    //float dot   = glm::dot(dragStart, dragStop);
+    //float dot   = glm::dot(dragStart, stop);
     float angle = glm::acos(normDot) * (180.0f / 3.14159f);
     
     glm::mat4 rot = glm::rotate(glm::mat4(), angle, axis);
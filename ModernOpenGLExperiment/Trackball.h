@@ -33,7 +33,17 @@ private:
      */
     glm::vec3 ScreenToTrackballCoordinates(int i, int j) const;
 
+    /**
+     * GetRotationMatrix
+     * Gets the rotation matrix for the current drag ending at stop
+     */
+    glm::mat4 GetRotationMatrix(const glm::vec3& stop) const;
+
 public:
+    Trackball()
+        : resW(1), resH(1), r2(1.0f),
+          dragging(false) {};
+
     Trackball(int resW, int resH, float r, glm::mat4 view)
         : resW(resW), resH(resH), r2(r*r),
           dragging(false), view(view) {};
@@ -46,6 +56,14 @@ public:
      */
     glm::mat4 GetRotationMatrix() const;
 
+    /**
+     * GetLatchedRotationMatrix
+     * Gets the rotation matrix as it would be with the mouse at (i,j), without
+     * updating anything. Lets the camera follow the very latest mouse position
+     * while the trackball itself is updated less often.
+     */
+    glm::mat4 GetLatchedRotationMatrix(int i, int j) const;
+
     /**
      * MouseUpdate
      * Updates the trackball interface with new mouse input
@@ -0,0 +1,41 @@
+#ifndef UNIFORMBLOCKS_H
+#define UNIFORMBLOCKS_H
+
+#include "Rendering.h"
+
+// CPU-side mirrors of the std140 uniform blocks declared in the shaders. Under std140,
+// a vec3 takes up as much room as a vec4, and a mat3 is laid out as three vec4 columns.
+
+/**
+ * FrameBlock_t - "Frame" block, written once per frame
+ */
+typedef struct {
+    glm::mat4 viewTransform;          // World to clip space
+    glm::vec4 viewNormalTransform[3]; // mat3, world to view space normals
+} FrameBlock_t;
+
+/**
+ * TransformBlock_t - "Transform" block, written once per draw
+ */
+typedef struct {
+    glm::mat4 modelTransform;     // Object to world space
+    glm::vec4 normalTransform[3]; // mat3, object to world space normals
+} TransformBlock_t;
+
+/**
+ * LightBlock_t - "Light" block
+ */
+typedef struct {
+    glm::vec4 position;  // vec3
+    glm::vec4 intensity; // vec3
+} LightBlock_t;
+
+/**
+ * PackMat3 - Writes a mat3 out as the three vec4 columns std140 expects
+ */
+inline void PackMat3(glm::vec4* columns, const glm::mat3& m) {
+    for (int i=0; i<3; ++i)
+        columns[i] = glm::vec4(m[i], 0.0f);
+}
+
+#endif
@@ -0,0 +1,58 @@
+#include "UniformRing.h"
+
+#include <cstdio>
+
+GLint UniformRing::QueryAlignment() {
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+    return alignment;
+}
+
+UniformRing::UniformRing(GLsizeiptr frameSize) :
+    alignment(QueryAlignment()),
+    buffer(GL_UNIFORM_BUFFER, (frameSize + alignment - 1) / alignment * alignment),
+    head(0), flushed(0), overflowed(false) {
+
+    staging.resize(buffer.GetSegmentSize());
+}
+
+void UniformRing::BeginFrame() {
+    head = 0;
+    flushed = 0;
+    overflowed = false;
+}
+
+UniformRange_t UniformRing::Allocate(GLsizeiptr size, void*& data) {
+    GLsizeiptr offset = (head + alignment - 1) / alignment * alignment;
+
+    if (offset + size > buffer.GetSegmentSize()) {
+        if (!overflowed) {
+            fprintf(stderr, "UniformRing: out of space after %d bytes this frame\n", (int)head);
+            overflowed = true;
+        }
+
+        if ((GLsizeiptr)overflow.size() < size)
+            overflow.resize(size);
+
+        data = &overflow[0];
+
+        UniformRange_t empty = {buffer.GetHandle(), 0, 0};
+        return empty;
+    }
+
+    head = offset + size;
+    data = &staging[offset];
+
+    UniformRange_t range = {buffer.GetHandle(), buffer.GetSegmentOffset() + offset, size};
+    return range;
+}
+
+void UniformRing::Flush() {
+    if (flushed == head)
+        return;
+
+    buffer.Write(flushed, head - flushed, &staging[flushed]);
+
+    flushed = head;
+}
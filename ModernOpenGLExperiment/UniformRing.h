@@ -0,0 +1,89 @@
+#ifndef UNIFORMRING_H
+#define UNIFORMRING_H
+
+#include <cstring>
+#include <vector>
+
+#include "Rendering.h"
+#include "GLState.h"
+#include "StreamBuffer.h"
+
+/**
+ * UniformRing
+ * One large uniform buffer that per-frame and per-draw uniform data gets suballocated from.
+ *
+ * The buffer is a StreamBuffer, so each frame writes into its own segment while the GPU
+ * may still be reading the previous frames' data. Within a frame, allocations are simply
+ * bumped off the end of a CPU-side staging copy of the segment, and Flush copies
+ * everything allocated since the last flush into the segment in one go.
+ *
+ * Allocations are aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, so every one of them can
+ * be handed to glBindBufferRange directly.
+ */
+class UniformRing {
+private:
+    GLint alignment;
+
+    // Sized to a multiple of the alignment, so every segment starts aligned
+    StreamBuffer buffer;
+
+    static GLint QueryAlignment();
+
+    // Staging copy of the current segment, and how much of it is allocated/uploaded
+    std::vector<char> staging;
+    GLsizeiptr head;
+    GLsizeiptr flushed;
+
+    // Allocations that don't fit are written here and thrown away
+    std::vector<char> overflow;
+    bool overflowed;
+
+public:
+    /**
+     * frameSize - Bytes available for allocation per frame
+     */
+    UniformRing(GLsizeiptr frameSize);
+
+    /**
+     * BeginFrame
+     * Starts allocating from the start of this frame's segment. Must come after
+     * FrameSync::BeginFrame.
+     */
+    void BeginFrame();
+
+    /**
+     * Allocate
+     * Reserves size bytes for this frame and points data at where to write them.
+     * The data only reaches the GPU on the next Flush.
+     */
+    UniformRange_t Allocate(GLsizeiptr size, void*& data);
+
+    /**
+     * Push
+     * Allocates room for value and copies it in
+     */
+    template <typename T>
+    UniformRange_t Push(const T& value) {
+        void* data;
+        UniformRange_t range = Allocate(sizeof(T), data);
+        memcpy(data, &value, sizeof(T));
+
+        return range;
+    }
+
+    /**
+     * Flush
+     * Uploads everything allocated since the last flush
+     */
+    void Flush();
+
+    GLsizeiptr GetFrameBytes() const { return head; }
+    GLuint GetHandle() const { return buffer.GetHandle(); }
+
+    static void Bind(GLuint binding, const UniformRange_t& range) {
+        if (range.size > 0)
+            GLState::BindUniformRange(binding, range);
+    }
+};
+
+#endif
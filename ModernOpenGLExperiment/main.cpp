@@ -1,26 +1,135 @@
 #include <cstdio>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 
 #include "Rendering.h"
 
 #include "Shader.h"
 #include "Program.h"
+#include "ShaderLibrary.h"
+#include "ShaderPermutations.h"
 #include "Mesh.h"
+#include "Model.h"
 #include "Texture.h"
+#include "RenderQueue.h"
+#include "CommandList.h"
+#include "GLState.h"
+#include "NullGL.h"
+#include "LazyGL.h"
+#include "GLCapture.h"
+#include "GLReplay.h"
+#include "GLDebugOutput.h"
+#include "UniformRing.h"
+#include "UniformBlocks.h"
+#include "FrameSync.h"
+#include "GPUProfiler.h"
+#include "FrameExchange.h"
+#include "Clock.h"
+#include "CPUProfiler.h"
+#include "FramePacer.h"
+#include "Redraw.h"
+#include "JobSystem.h"
+#include "JobBenchmark.h"
+#include "SceneBenchmark.h"
 
 #include "MD3Model.h"
 #include "OBJModel.h"
 
 #include "Trackball.h"
 
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace std;
 
+// Render queue passes, drawn in this order
+#define PASS_TEXTURED 0
+#define PASS_NORMALS  1
+#define PASS_COUNT    2
+
+// Frames rendered and simulation steps taken per second
+#define FRAME_RATE      60.0
+#define SIMULATION_RATE 120.0
+
+// Most simulation time to catch up on in one frame, after a hitch
+#define MAX_SIMULATION_CATCHUP 0.25
+
+// Seconds between GPU timing dumps with --profile-gpu
+#define GPU_PROFILE_INTERVAL 5.0
+
+// Frames drawn with --null-gl, unless --frames says otherwise
+#define NULL_GL_FRAMES 1000
+
+// GL entry points listed with --null-gl, most called first
+#define NULL_GL_TOP_CALLS 10
+
+// Repeated state changes listed after --replay, most repeated first
+#define REPLAY_TOP_REPEATS 10
+
+// Scene benchmark defaults, unless --frames and --grid say otherwise
+#define SCENE_BENCH_FRAMES        600
+#define SCENE_BENCH_WARMUP_FRAMES 60
+#define SCENE_BENCH_GRID_SIZE     8
+#define SCENE_BENCH_SPACING       48.0f
+
+// Where linked program binaries are kept between runs
+#define SHADER_CACHE_DIRECTORY "shadercache"
+
+// Surface shader features, as bits of a permutation mask. Without any, surfaces are
+// drawn in their vertex colors.
+#define SURFACE_TEXTURED (1 << 0)
+
+// Length of the lines drawn along vertex normals, in model units, and the key that
+// shows or hides them
+#define NORMAL_LINE_LENGTH 2.0f
+#define NORMAL_TOGGLE_KEY  'N'
+
+// Bytes of uniform data we can write per frame
+#define UNIFORM_RING_SIZE (256*1024)
+
+// Room to make up front in the model geometry arena; it grows as needed
+#define ARENA_VERTEX_CAPACITY (64*1024)
+#define ARENA_INDEX_CAPACITY  (192*1024)
+
+// Everything the simulation hands over to the renderer for one frame
+typedef struct {
+    FrameBlock_t frameBlock;
+    LightBlock_t lightBlock;
+    TransformBlock_t transformBlock;
+
+    // The trackball as of the last step, for late latching the camera
+    Trackball trackball;
+
+    uint64_t producedAt;
+    uint64_t steppedAt; // When the simulation last took a step
+    uint64_t inputTime; // When the input that step saw arrived
+
+    // Whether the simulation has come to rest, i.e. the next frame would look the same
+    bool settled;
+} FrameState_t;
+
+// Latest input, filled in by GLFW callbacks as events arrive. GLFW can
+// only be polled from the thread that opened the window, so the render
+// thread pumps events and everyone else reads them from here.
+typedef struct {
+    std::atomic<int> mouseX;
+    std::atomic<int> mouseY;
+    std::atomic<bool> mouseDown;
+
+    // When the last input that matters to the trackball arrived
+    std::atomic<uint64_t> timestamp;
+} InputState_t;
+
+static InputState_t input;
+
+// Whether the normals pass is drawn, flipped by NORMAL_TOGGLE_KEY
+static bool showNormals = false;
+
 #define PRINTMAT4X4(x) printf( \
     "[%f %f %f %f\n %f %f %f %f\n %f %f %f %f\n %f %f %f %f]\n", \
     x[0][0], x[0][1], x[0][2], x[0][3], \
@@ -67,9 +176,12 @@ int acquireContext(int width, int height) {
     return 1;
 }
 
-int acquireFunctions() {
+int acquireFunctions(bool nullGL, bool lazyGL) {
+    PROFILE_ZONE("Load GL functions");
+
     // Function loading
-    int oglLoadResult = ogl_LoadFunctions();
+    int oglLoadResult = nullGL ? NullGL::LoadFunctions() :
+                        lazyGL ? LazyGL::LoadFunctions() : ogl_LoadFunctions();
     if (oglLoadResult != ogl_LOAD_SUCCEEDED) {
         fprintf(stderr, "Unable to load OpenGL functions!\n");
 
@@ -96,101 +208,6 @@ void setupOpenGL() {
     glProvokingVertex(GL_FIRST_VERTEX_CONVENTION);
 }
 
-string readFile(const char* fileName) {
-    ifstream in(fileName);
-    if (!in) throw(errno);
-
-    string contents = string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
-
-    in.close();
-
-    return contents;
-}
-
-// TODO: Consolidate these two functions which are very repetitive
-Program* MakeProgram(const string& vss, const string& fss) {
-    VertexShader* vs = VertexShader::CompileFromSource(vss);
-    if (!vs->IsValid()) {
-        fprintf(stderr, "Vertex Shader Compile Error:\n%s\n", vs->GetCompileLog().c_str());
-        delete vs;
-        return NULL;
-    }
-    
-    FragmentShader* fs = FragmentShader::CompileFromSource(fss);
-    if (!fs->IsValid()) {
-        fprintf(stderr, "Fragment Shader Compile Error:\n%s\n", fs->GetCompileLog().c_str());
-
-        delete vs;
-        delete fs;
-
-        return NULL;
-    }
-
-    Program* program = Program::CreateFromShaders(vs, fs);
-
-    // Don't need shaders after the program is linked
-    delete vs;
-    delete fs;
-    
-    if (!program->IsValid()) {
-        fprintf(stderr, "Link Error:\n%s\n", program->GetLinkLog().c_str());
-        
-        delete program;
-
-        return NULL;
-    }
-
-    return program;
-}
-Program* MakeProgram(const string& vss, const string& gss, const string& fss) {
-    VertexShader* vs = VertexShader::CompileFromSource(vss);
-    if (!vs->IsValid()) {
-        fprintf(stderr, "Vertex Shader Compile Error:\n%s\n", vs->GetCompileLog().c_str());
-
-        delete vs;
-
-        return NULL;
-    }
-    
-    GeometryShader* gs = GeometryShader::CompileFromSource(gss);
-    if (!gs->IsValid()) {
-        fprintf(stderr, "Geometry Shader Compile Error:\n%s\n", gs->GetCompileLog().c_str());
-
-        delete vs;
-        delete gs;
-
-        return NULL;
-    }
-
-    FragmentShader* fs = FragmentShader::CompileFromSource(fss);
-    if (!fs->IsValid()) {
-        fprintf(stderr, "Fragment Compile Error:\n%s\n", fs->GetCompileLog().c_str());
-
-        delete vs;
-        delete gs;
-        delete fs;
-
-        return NULL;
-    }
-
-    Program* program = Program::CreateFromShaders(vs, gs, fs);
-
-    // Don't need shaders after the program is linked
-    delete vs;
-    delete gs;
-    delete fs;
-    
-    if (!program->IsValid()) {
-        fprintf(stderr, "Link Error:\n%s\n", program->GetLinkLog().c_str());
-        
-        delete program;
-
-        return NULL;
-    }
-
-    return program;
-}
-
 Mesh* MakeAxisMesh(Program* program) {
     float data[] = {
         0.0f, 0.0f, 0.0f,   0.0f, 0.0f, 0.0f,
@@ -248,15 +265,27 @@ Mesh* MakeAABBMesh(Program* program) {
     return mesh;
 }
 
-Mesh* LoadMesh(const Program* program, const ModelLoader* model, uint32_t meshIndex) {
-    MeshVertex_t* vertexData = NULL;
-    GLushort* indexData = NULL;
-    uint32_t vertexCount, triangleCount, indexCount;
+Mesh* MakeNormalLinesMesh(Program* program, vector<GLfloat>& data) {
+    GLuint vertexCount = (GLuint)(data.size() / 6);
+
+    vector<GLuint> indices(vertexCount);
+    for (GLuint i=0; i<vertexCount; ++i)
+        indices[i] = i;
+
+    GLsizei stride = 6*sizeof(GLfloat);
+    VertexAttributeBinding_t vertFmt[] = {
+        {program->GetAttributeID("coord"), 3, GL_FLOAT, GL_FALSE, stride, BUFFER_OFFSET(0)},
+        {program->GetAttributeID("color"), 3, GL_FLOAT, GL_FALSE, stride, BUFFER_OFFSET(3*sizeof(GLfloat))}
+    };
+
+    Mesh* mesh = new Mesh(PrimitiveType::LinesPrimitive, vertFmt, 2);
+    mesh->SetVertexData(vertexCount, (GLuint)(data.size()*sizeof(GLfloat)), &data[0]);
+    mesh->SetIndexData(IndexType::UnsignedIntIndex, vertexCount, vertexCount*sizeof(GLuint), &indices[0]);
 
-    model->GetVertices(meshIndex, vertexData, vertexCount);
-    model->GetIndices(meshIndex,  indexData,  triangleCount);
-    indexCount = triangleCount * 3;
+    return mesh;
+}
 
+GeometryArena* MakeModelArena() {
     GLsizei stride = 8*sizeof(GLfloat);
     VertexAttributeBinding_t vertFmt[] = {
         {0, 3, GL_FLOAT, GL_FALSE, stride, BUFFER_OFFSET(0)},
@@ -264,37 +293,236 @@ Mesh* LoadMesh(const Program* program, const ModelLoader* model, uint32_t meshIn
         {2, 2, GL_FLOAT, GL_FALSE, stride, BUFFER_OFFSET(6*sizeof(GLfloat))}
     };
 
-    Mesh* mesh = new Mesh(PrimitiveType::TrianglesPrimitive, vertFmt, 3);
-    mesh->SetVertexData(vertexCount, vertexCount*stride, vertexData);
-    mesh->SetIndexData(IndexType::UnsignedShortIndex, indexCount, indexCount*sizeof(GLushort), indexData);
+    return new GeometryArena(vertFmt, 3, IndexType::UnsignedShortIndex,
+        ARENA_VERTEX_CAPACITY, ARENA_INDEX_CAPACITY);
+}
+
+// Sets the uniforms that never change in a surface shader variant
+void setupSurfaceShader(Program* program, uint32_t mask) {
+    if (mask & SURFACE_TEXTURED) {
+        program->Bind();
+        Program::SetUniform(program->GetUniform("diffuseSampler"), (GLint)0);
+    }
+}
+
+const char* SURFACE_FEATURES[] = {"TEXTURED"};
+
+const ShaderPermutationDesc_t SURFACE_SHADERS = {
+    "Surface", "glsl",
+    "default.vert", NULL, "surface.frag",
+    SURFACE_FEATURES, sizeof(SURFACE_FEATURES)/sizeof(SURFACE_FEATURES[0]),
+    0,
+    &setupSurfaceShader
+};
+
+/**
+ * Startup loads - File reads and decoding that don't need GL. They run as jobs while the
+ * window and context are being created, so only the uploads are left for the main thread.
+ */
+typedef struct {
+    const char* fileName;
+    GLFWimage image;
+    bool loaded;
+} ImageLoad_t;
+
+typedef struct {
+    MeshVertex_t* vertexData;
+    GLushort* indexData;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+} MeshData_t;
+
+typedef struct {
+    const char* fileName;
+    vector<MeshData_t> meshes;
+
+    // A line along every vertex normal in the model, as the coord and color of each
+    // end. Only uploaded if the normals get shown.
+    vector<GLfloat> normalLines;
+
+    bool loaded;
+} ModelLoad_t;
+
+// Time spent in startup loads across all workers, in ns
+std::atomic<uint64_t> startupLoadTime(0);
+
+void loadImage(void* data, uint32_t, uint32_t) {
+    PROFILE_ZONE("Decode image");
+    uint64_t start = Clock::Now();
+
+    ImageLoad_t* load = (ImageLoad_t*)data;
+    load->loaded = glfwReadImage(load->fileName, &load->image, GLFW_ORIGIN_UL_BIT) != 0;
+
+    startupLoadTime += Clock::Now() - start;
+}
 
-    delete[] vertexData;
-    delete[] indexData;
+void loadModel(void* data, uint32_t, uint32_t) {
+    PROFILE_ZONE("Parse model");
+    uint64_t start = Clock::Now();
 
-    return mesh;
+    ModelLoad_t* load = (ModelLoad_t*)data;
+    ModelLoader* model = NULL;
+
+    try {
+        model = MD3Model::LoadFromFile(load->fileName);
+    } catch (int) {
+        model = NULL;
+    }
+
+    load->loaded = model != NULL && model->IsValid();
+
+    // Unpack every surface into plain arrays, ready to be copied into the arena
+    for (uint32_t i=0; load->loaded && i<model->GetMeshCount(); ++i) {
+        MeshData_t mesh;
+        uint32_t triangleCount;
+
+        model->GetVertices(i, mesh.vertexData, mesh.vertexCount);
+        model->GetIndices(i,  mesh.indexData,  triangleCount);
+        mesh.indexCount = triangleCount * 3;
+
+        load->meshes.push_back(mesh);
+
+        // Red at the vertex, blue at the end of the normal
+        for (uint32_t j=0; j<mesh.vertexCount; ++j) {
+            const MeshVertex_t& vertex = mesh.vertexData[j];
+            glm::vec3 end = vertex.coord + NORMAL_LINE_LENGTH * vertex.normal;
+
+            GLfloat line[] = {
+                vertex.coord.x, vertex.coord.y, vertex.coord.z,   1.0f, 0.0f, 0.0f,
+                end.x,          end.y,          end.z,            0.0f, 0.0f, 1.0f
+            };
+
+            load->normalLines.insert(load->normalLines.end(), line, line + sizeof(line)/sizeof(line[0]));
+        }
+    }
+
+    delete model;
+
+    startupLoadTime += Clock::Now() - start;
 }
 
 void LoadModel(
-    const Program* program,
-    const ModelLoader* model,
-    const vector<string>& textureFiles,
+    GeometryArena* arena,
+    ModelLoad_t& model,
+    ImageLoad_t* images,
+    size_t imageCount,
     vector<Mesh*>& meshes,
     vector<Texture*>& textures
 ) {
-    // Load all the meshes from the model file
-    for (size_t i=0; i<model->GetMeshCount(); ++i)
-        meshes.push_back(LoadMesh(program, model, i));
+    PROFILE_ZONE("LoadModel");
+
+    // Upload all the meshes from the model file
+    for (size_t i=0; i<model.meshes.size(); ++i) {
+        MeshData_t& data = model.meshes[i];
+
+        meshes.push_back(Mesh::CreateInArena(arena, PrimitiveType::TrianglesPrimitive,
+            data.vertexCount, data.vertexData, data.indexCount, data.indexData));
+
+        delete[] data.vertexData;
+        delete[] data.indexData;
+    }
+
+    model.meshes.clear();
+
+    // Upload the list of textures
+    for (size_t i=0; i<imageCount; ++i) {
+        if (!images[i].loaded) {
+            fprintf(stderr, "Unable to load %s\n", images[i].fileName);
+            textures.push_back(NULL);
+            continue;
+        }
+
+        textures.push_back(Texture::CreateFromImage(images[i].image));
+        glfwFreeImage(&images[i].image);
+    }
+}
+
+/**
+ * Waits for the startup loads, frees anything they left that LoadModel didn't, and stops
+ * the workers. Every way out of the demo goes through here once the job system is up,
+ * before GLFW is terminated.
+ */
+void cleanupStartup(
+    JobCounter* startupLoads,
+    ImageLoad_t* images,
+    size_t imageCount,
+    ModelLoad_t& model,
+    ShaderPermutations* surfaceShaders,
+    ShaderLibrary* shaderLibrary
+) {
+    JobSystem::Wait(startupLoads);
+
+    for (size_t i=0; i<imageCount; ++i) {
+        if (images[i].loaded)
+            glfwFreeImage(&images[i].image);
+    }
+
+    for (size_t i=0; i<model.meshes.size(); ++i) {
+        delete[] model.meshes[i].vertexData;
+        delete[] model.meshes[i].indexData;
+    }
+
+    model.meshes.clear();
+
+    // Waits for any preprocessing that's still going, which needs the workers
+    delete surfaceShaders;
+    delete shaderLibrary;
+
+    JobSystem::Shutdown();
+}
+
+void GLFWCALL onKey(int key, int action) {
+    if (key != NORMAL_TOGGLE_KEY || action != GLFW_PRESS)
+        return;
+
+    showNormals = !showNormals;
+    Redraw::Request(RedrawReason::Input);
+}
+
+void GLFWCALL onWindowRefresh() {
+    Redraw::Request(RedrawReason::Expose);
+}
+
+void GLFWCALL onMousePos(int x, int y) {
+    input.mouseX.store(x);
+    input.mouseY.store(y);
 
-    // Load the list of textures
-    for (auto it=textureFiles.begin(); it!=textureFiles.end(); ++it)
-        textures.push_back(Texture::LoadFromFile(it->c_str()));
+    // Moving the mouse only matters to the trackball while dragging
+    if (input.mouseDown.load()) {
+        input.timestamp.store(Clock::Now());
+        Redraw::Request(RedrawReason::Input);
+    }
 }
 
-void setup(int width, int height) {
+void GLFWCALL onMouseButton(int button, int action) {
+    if (button != GLFW_MOUSE_BUTTON_LEFT)
+        return;
+
+    input.mouseDown.store(action == GLFW_PRESS);
+    input.timestamp.store(Clock::Now());
+    Redraw::Request(RedrawReason::Input);
+}
+
+bool setup(int width, int height, bool nullGL, bool lazyGL, const char* captureFile, const char* glLogFile) {
     printf("GLFW %d.%d.%d\n", GLFW_VERSION_MAJOR, GLFW_VERSION_MINOR, GLFW_VERSION_REVISION);
 
-    if (!acquireContext(width, height)) exit(EXIT_FAILURE);
-    if (!acquireFunctions()) exit(EXIT_FAILURE);
+    if (nullGL) {
+        // No window or context, but GLFW still reads our images
+        if (!glfwInit()) {
+            fprintf(stderr, "Unable to initialize GLFW!\n");
+            return false;
+        }
+    } else if (!acquireContext(width, height)) {
+        return false;
+    }
+
+    uint64_t loadStart = Clock::Now();
+    if (!acquireFunctions(nullGL, lazyGL)) return false;
+    printf("Loaded GL functions in %.3fms%s\n", Clock::ToMilliseconds(Clock::Now() - loadStart),
+        nullGL ? " (null driver)" : lazyGL ? " (lazily)" : "");
+
+    // Capture has to start before anything is created, for replay to recreate it all
+    if (captureFile != NULL && !GLCapture::Begin(captureFile)) return false;
     
     setupOpenGL();
 
@@ -304,130 +532,742 @@ void setup(int width, int height) {
     printf("  [GL_RENDERER]:   %s;\n", glGetString(GL_RENDERER));
     printf("  [GL_VERSION]:    %s;\n", glGetString(GL_VERSION));
 
+    // Driver messages go to stderr unless --gl-log says otherwise
+    bool debugOutput = GLDebugOutput::Startup(glLogFile);
+    printf("  [Debug output]:  %s;\n", debugOutput ? "GL_ARB_debug_output" : "unavailable");
+
+    return true;
+}
+
+void reportLazyGL(const char* functionsFile) {
+    printf("Lazy GL: resolved %u of %u functions in %.3fms\n",
+        LazyGL::GetResolvedCount(), (uint32_t)GLFunction::Count, Clock::ToMilliseconds(LazyGL::GetResolveTime()));
+
+    if (functionsFile == NULL)
+        return;
+
+    if (LazyGL::WriteFunctionList(functionsFile))
+        printf("Wrote the functions used to %s\n", functionsFile);
+    else
+        fprintf(stderr, "Couldn't write the functions used to %s\n", functionsFile);
+}
+
+void onReplayFrame() {
+    GLDebugOutput::EndFrame();
+    glfwSwapBuffers();
+    glfwPollEvents();
+}
+
+int runReplay(const char* replayFile, bool paced, bool nullGL, bool lazyGL, const char* glFunctionsFile) {
+    GLReplayStats_t stats;
+    bool replayed = GLReplay::Run(replayFile, paced, nullGL ? NULL : &onReplayFrame, stats);
+
+    if (replayed && stats.frames > 0) {
+        printf("Replayed %llu frames%s: %.3fms average, %.3fms min, %.3fms max\n",
+            (unsigned long long)stats.frames, paced ? " (paced)" : "",
+            Clock::ToMilliseconds(stats.totalTime) / stats.frames,
+            Clock::ToMilliseconds(stats.minFrameTime), Clock::ToMilliseconds(stats.maxFrameTime));
+
+        printf("%.1f calls per frame, %llu skipped, %llu repeated state changes\n",
+            (double)stats.calls / stats.frames,
+            (unsigned long long)stats.skippedCalls, (unsigned long long)stats.repeatedCalls);
+
+        std::vector<GLCallCount_t> repeats;
+        GLReplay::GetRepeatedCalls(repeats);
+
+        for (size_t i=0; i<repeats.size() && i<REPLAY_TOP_REPEATS; ++i)
+            printf("  %-28s %8.2f repeats per frame\n", repeats[i].name, (double)repeats[i].calls / stats.frames);
+    }
+
+    GLDebugOutput::Dump();
+    GLDebugOutput::Shutdown();
+
+    if (lazyGL)
+        reportLazyGL(glFunctionsFile);
+
+    if (nullGL)
+        NullGL::Shutdown();
+
+    glfwTerminate();
+    return replayed ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 int main(int argc, char* argv[]) {
+    uint64_t startupBegin = Clock::Now();
+
+    if (argc > 1 && strcmp(argv[1], "--bench-jobs") == 0)
+        return RunJobBenchmark("models/rocketam.md3");
+
+    // Only draw frames when something changed, rather than at a steady frame rate
+    bool onDemand = false;
+
+    // Aim the camera with the latest mouse position right before drawing,
+    // rather than with whatever the simulation saw a frame earlier
+    bool lateLatch = true;
+
+    // Print how long each part of the frame takes on the GPU every few seconds
+    bool profileGPU = false;
+
+    // Record CPU zones and write them out as a Chrome trace on exit
+    const char* traceFile = NULL;
+
+    // Render through the null driver, with no window or GPU, as fast as possible
+    bool nullGL = false;
+
+    // Quit after this many frames; 0 runs until the window is closed
+    uint32_t maxFrames = 0;
+
+    // Record every GL call into a trace file
+    const char* captureFile = NULL;
+
+    // Play a captured trace back instead of running the demo, as fast as possible
+    // or at the pace it was captured
+    const char* replayFile = NULL;
+    bool replayPaced = false;
+
+    // Build every program from source, rather than loading binaries from the last run
+    bool shaderCache = true;
+
+    // Look GL functions up as they're first called, and optionally list the ones that were
+    bool lazyGL = false;
+    const char* glFunctionsFile = NULL;
+
+    // Where driver debug messages and performance warnings are logged, instead of stderr
+    const char* glLogFile = NULL;
+
+    // Draw a grid of models along a fixed camera path and report frame times as JSON
+    bool benchScene = false;
+    SceneBenchmarkConfig_t sceneConfig;
+    sceneConfig.gridSize = SCENE_BENCH_GRID_SIZE;
+    sceneConfig.spacing = SCENE_BENCH_SPACING;
+    sceneConfig.warmupFrames = SCENE_BENCH_WARMUP_FRAMES;
+    sceneConfig.outputFile = NULL;
+
+    for (int i=1; i<argc; ++i) {
+        if (strcmp(argv[i], "--on-demand") == 0)
+            onDemand = true;
+        else if (strcmp(argv[i], "--no-late-latch") == 0)
+            lateLatch = false;
+        else if (strcmp(argv[i], "--normals") == 0)
+            showNormals = true;
+        else if (strcmp(argv[i], "--profile-gpu") == 0)
+            profileGPU = true;
+        else if (strcmp(argv[i], "--trace") == 0 && i+1 < argc)
+            traceFile = argv[++i];
+        else if (strcmp(argv[i], "--null-gl") == 0)
+            nullGL = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i+1 < argc)
+            maxFrames = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--capture") == 0 && i+1 < argc)
+            captureFile = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i+1 < argc)
+            replayFile = argv[++i];
+        else if (strcmp(argv[i], "--replay-paced") == 0)
+            replayPaced = true;
+        else if (strcmp(argv[i], "--no-shader-cache") == 0)
+            shaderCache = false;
+        else if (strcmp(argv[i], "--lazy-gl") == 0)
+            lazyGL = true;
+        else if (strcmp(argv[i], "--gl-functions") == 0 && i+1 < argc)
+            glFunctionsFile = argv[++i];
+        else if (strcmp(argv[i], "--gl-log") == 0 && i+1 < argc)
+            glLogFile = argv[++i];
+        else if (strcmp(argv[i], "--bench-scene") == 0)
+            benchScene = true;
+        else if (strcmp(argv[i], "--grid") == 0 && i+1 < argc)
+            sceneConfig.gridSize = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--obj") == 0 && i+1 < argc)
+            sceneConfig.objFiles.push_back(argv[++i]);
+        else if (strcmp(argv[i], "--bench-out") == 0 && i+1 < argc)
+            sceneConfig.outputFile = argv[++i];
+    }
+
+    if (nullGL && maxFrames == 0 && !benchScene)
+        maxFrames = NULL_GL_FRAMES;
+
+    CPUProfiler::Enable(traceFile != NULL);
+    CPUProfiler::SetThreadName("Main");
+
     int width = 800, height = 600;
-    setup(width, height);
 
-    // Load shaders
-    Program* textureShader = MakeProgram(
-        readFile("glsl/default.vert"),
-        readFile("glsl/shaded.frag")
-    );
+    // Replays and the scene benchmark load what they need themselves
+    bool runDemo = replayFile == NULL && !benchScene;
 
-    Program* normalShader = MakeProgram(
-        readFile("glsl/default.vert"),
-        readFile("glsl/debugNormals.geom"),
-        readFile("glsl/flatShade.frag")
-    );
+    // One set of surface shaders, with the features picked by defines
+    ShaderLibrary* shaderLibrary = NULL;
+    ShaderPermutations* surfaceShaders = NULL;
+
+    ImageLoad_t images[] = {
+        {"textures/rockammo.tga"},
+        {"textures/rockammo2.tga"}
+    };
+    const size_t imageCount = sizeof(images)/sizeof(images[0]);
+
+    ModelLoad_t modelLoad;
+    modelLoad.fileName = "models/rocketam.md3";
+
+    JobCounter startupLoads;
+
+    if (runDemo) {
+        // The main thread doubles as worker 0, and is busy creating the context while
+        // the other workers read and decode everything that doesn't need GL. GLFW has to
+        // be initialized before it will read images.
+        JobSystem::Startup();
+        glfwInit();
+
+        // The library doesn't touch GL until the first program goes in, so the variants
+        // can be preprocessed before there's a context. The untextured one is only for
+        // the normals, but building it in the background means showing them never waits.
+        shaderLibrary = new ShaderLibrary();
+        surfaceShaders = new ShaderPermutations(shaderLibrary, SURFACE_SHADERS);
+
+        surfaceShaders->Precompile(SURFACE_TEXTURED);
+        surfaceShaders->Precompile(0);
+
+        for (size_t i=0; i<imageCount; ++i)
+            JobSystem::Run(&loadImage, &images[i], &startupLoads);
+
+        JobSystem::Run(&loadModel, &modelLoad, &startupLoads);
+    }
+
+    if (!setup(width, height, nullGL, lazyGL, replayFile == NULL ? captureFile : NULL, glLogFile)) {
+        if (runDemo)
+            cleanupStartup(&startupLoads, images, imageCount, modelLoad, surfaceShaders, shaderLibrary);
 
-    if (textureShader == NULL || normalShader == NULL) {
         glfwTerminate();
         return EXIT_FAILURE;
     }
-    
-    // Setup uniforms that are constant over lifetime of shader
-    textureShader->Bind();
-    Program::SetUniform(textureShader->GetUniform("diffuseSampler"), (GLuint)0);
+    uint64_t contextReady = Clock::Now();
 
-    // Setup objects
-    ModelLoader* model = MD3Model::LoadFromFile("models/rocketam.md3");
+    if (replayFile != NULL)
+        return runReplay(replayFile, replayPaced, nullGL, lazyGL, glFunctionsFile);
+
+    if (benchScene) {
+        sceneConfig.frames = maxFrames != 0 ? maxFrames : SCENE_BENCH_FRAMES;
+        sceneConfig.width = width;
+        sceneConfig.height = height;
+        sceneConfig.nullGL = nullGL;
+
+        int result = RunSceneBenchmark(sceneConfig);
+
+        if (lazyGL)
+            reportLazyGL(glFunctionsFile);
 
-    if (model == NULL) {
+        GLDebugOutput::Dump();
+        GLDebugOutput::Shutdown();
+        GLCapture::End();
+        if (nullGL)
+            NullGL::Shutdown();
+
+        glfwTerminate();
+        return result;
+    }
+
+    glfwSetWindowRefreshCallback(&onWindowRefresh);
+    glfwSetMousePosCallback(&onMousePos);
+    glfwSetMouseButtonCallback(&onMouseButton);
+    glfwSetKeyCallback(&onKey);
+
+    // Whatever hasn't finished loading by now is on the critical path
+    {
+        PROFILE_ZONE("Wait for startup loads");
+        JobSystem::Wait(&startupLoads);
+    }
+    uint64_t loadsReady = Clock::Now();
+
+    // Programs loaded from binaries never get created from source, which a capture needs
+    // to be able to replay them
+    if (shaderCache && !GLCapture::IsCapturing())
+        shaderLibrary->SetCacheDirectory(SHADER_CACHE_DIRECTORY);
+    Program* textureShader;
+    {
+        PROFILE_ZONE("Compile shaders");
+
+        // Start compiling everything that's been preprocessed before waiting on any of
+        // it, so the driver can build the variants side by side
+        surfaceShaders->Update();
+
+        textureShader = surfaceShaders->Get(SURFACE_TEXTURED);
+    }
+
+    if (textureShader == NULL) {
+        cleanupStartup(&startupLoads, images, imageCount, modelLoad, surfaceShaders, shaderLibrary);
         glfwTerminate();
         return EXIT_FAILURE;
     }
 
-    string textureFiles[] = {
-        "textures/rockammo.tga",
-        "textures/rockammo2.tga"
-    };
+    printf("Shaders: %u compiled for %u programs%s\n", (uint32_t)shaderLibrary->GetShaderCount(),
+        (uint32_t)shaderLibrary->GetProgramCount(), shaderLibrary->IsParallelCompile() ? ", in parallel" : "");
+
+    for (size_t i=0; i<shaderLibrary->GetProgramCount(); ++i) {
+        const ShaderProgramStats_t& programStats = shaderLibrary->GetProgramStats(i);
+
+        if (programStats.cached) {
+            printf("  %-12s loaded from cache in %.3fms\n", programStats.name, Clock::ToMilliseconds(programStats.linkTime));
+        } else {
+            printf("  %-12s compile %.3fms, link %.3fms, %u shared shaders\n", programStats.name,
+                Clock::ToMilliseconds(programStats.compileTime), Clock::ToMilliseconds(programStats.linkTime),
+                programStats.sharedShaders);
+        }
+    }
+
+    if (shaderLibrary->IsCaching()) {
+        const ShaderCacheStats_t& cacheStats = shaderLibrary->GetCacheStats();
+        uint32_t lookups = cacheStats.hits + cacheStats.misses;
+
+        printf("Program cache: %u hits, %u misses (%.0f%% hit rate, %u rejected by the driver), %u stored, %.3fms saved\n",
+            cacheStats.hits, cacheStats.misses, lookups > 0 ? 100.0 * cacheStats.hits / lookups : 0.0,
+            cacheStats.rejected, cacheStats.stored, cacheStats.timeSaved / 1000000.0);
+    }
+    uint64_t shadersReady = Clock::Now();
+
+    // Setup objects
+    if (!modelLoad.loaded) {
+        fprintf(stderr, "Unable to load %s\n", modelLoad.fileName);
+        cleanupStartup(&startupLoads, images, imageCount, modelLoad, surfaceShaders, shaderLibrary);
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
 
     vector<Mesh*> meshes;
     vector<Texture*> textures;
 
-    LoadModel(textureShader, model, vector<string>(textureFiles, textureFiles + 2), meshes, textures);
+    GeometryArena* modelArena = MakeModelArena();
+    LoadModel(modelArena, modelLoad, images, imageCount, meshes, textures);
+    uint64_t uploadsReady = Clock::Now();
+
+    ArenaStats_t arenaStats = modelArena->GetStats();
+    printf("Geometry arena: %u meshes, %u/%u vertices (%.0f%% fragmented), %u/%u indices (%.0f%% fragmented)\n",
+        arenaStats.allocations,
+        arenaStats.verticesUsed, arenaStats.vertexCapacity, 100.0f * arenaStats.vertexFragmentation,
+        arenaStats.indicesUsed,  arenaStats.indexCapacity,  100.0f * arenaStats.indexFragmentation);
     float cameraDistance = 48.0f;
 
-    delete model;
+    // Group surfaces by texture so that each group is a single draw
+    Model* drawModel = new Model(modelArena);
+    for (size_t i=0; i<meshes.size(); ++i) {
+        size_t texIndex = glm::min(textures.size()-1, i);
+        drawModel->AddSurface(meshes[i], textures[texIndex]);
+    }
 
-    // Setup trackball interface
-    Trackball trackball(width, height, 1.0f, glm::mat4());
+    // Uploaded the first time the normals are shown
+    Program* normalShader = NULL;
+    Mesh* normalLines = NULL;
 
     glm::mat4 project = glm::perspectiveFov(70.0f, (float) width, (float) height, 1.0f, 1024.0f);
     glm::mat4 viewTranslate = glm::translate(glm::mat4(), glm::vec3(0.0f, 0.0f, -cameraDistance));
-    glm::mat4 viewRotate = glm::mat4();
     
     glm::vec4 lightPos = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f) * viewTranslate;
 
-    float time(0.0f), lastTime(0.0f);
+    // Each pass is sorted and recorded as a job of its own
+    RenderQueue passQueues[PASS_COUNT];
+    CommandList passCommands[PASS_COUNT];
+    CommandList* passCommandLists[PASS_COUNT] = {&passCommands[PASS_TEXTURED], &passCommands[PASS_NORMALS]};
+
+    UniformRange_t noTransform = {0, 0, 0};
+    UniformRing* uniformRing = new UniformRing(UNIFORM_RING_SIZE);
+
+    // The simulation runs a frame ahead of the renderer on its own thread
+    FrameExchange<FrameState_t> frames;
+
+    uint64_t simTime = 0, renderTime = 0;
+    uint32_t simFrames = 0, simSteps = 0, renderFrames = 0;
+
+    std::thread simulation([&]() {
+        CPUProfiler::SetThreadName("Simulation");
+
+        // Setup trackball interface
+        Trackball trackball(width, height, 1.0f, glm::mat4());
+
+        // The simulation advances in fixed steps, and each frame shows the state
+        // interpolated between the last two steps by however far into the next
+        // step the frame falls
+        uint64_t step = Clock::FromSeconds(1.0 / SIMULATION_RATE);
+        uint64_t maxCatchup = Clock::FromSeconds(MAX_SIMULATION_CATCHUP);
+        uint64_t accumulator = 0;
+        uint64_t lastTime = Clock::Now();
+        uint64_t steppedAt = 0;
+        uint64_t inputTime = 0;
+
+        glm::quat previousRotation, currentRotation;
+
+        FrameState_t* state;
+        while ((state = frames.BeginWrite()) != NULL) {
+            PROFILE_ZONE("Simulate");
+
+            uint64_t start = Clock::Now();
+
+            accumulator += std::min(start - lastTime, maxCatchup);
+            lastTime = start;
+
+            while (accumulator >= step) {
+                previousRotation = currentRotation;
+
+                // Update trackball state
+                inputTime = input.timestamp.load();
+                trackball.MouseUpdate(input.mouseDown.load(), input.mouseX.load(), input.mouseY.load());
+                currentRotation = glm::quat_cast(trackball.GetRotationMatrix());
+
+                accumulator -= step;
+                ++simSteps;
+
+                steppedAt = start;
+            }
+
+            float alpha = (float)accumulator / step;
+
+            // Update the transformation matrix
+            glm::mat4 viewRotate = glm::mat4_cast(glm::mix(previousRotation, currentRotation, alpha));
+
+            // Camera and light data is shared by every program, so it's
+            // uploaded once and bound once for the whole frame
+            state->frameBlock.viewTransform = project * viewTranslate * viewRotate;
+
+            // Since viewRotate is orthonormal, its inverse transpose equals itself
+            PackMat3(state->frameBlock.viewNormalTransform, glm::mat3(viewRotate));
+
+            state->lightBlock.position  = lightPos;
+            state->lightBlock.intensity = glm::vec4(1.0f);
+
+            // The model sits at the origin
+            state->transformBlock.modelTransform = glm::mat4();
+            PackMat3(state->transformBlock.normalTransform, glm::mat3());
+
+            state->trackball = trackball;
+            state->steppedAt = steppedAt;
+            state->inputTime = inputTime;
+            state->settled =
+                previousRotation.w == currentRotation.w &&
+                previousRotation.x == currentRotation.x &&
+                previousRotation.y == currentRotation.y &&
+                previousRotation.z == currentRotation.z;
+
+            state->producedAt = Clock::Now();
+            simTime += state->producedAt - start;
+            ++simFrames;
+
+            frames.EndWrite();
+        }
+    });
+
+    FramePacer pacer(FRAME_RATE);
+
+    if (profileGPU)
+        GPUProfiler::SetDumpInterval(GPU_PROFILE_INTERVAL);
+
+    // Only count the calls the frames themselves make
+    if (nullGL)
+        NullGL::ResetCallCounts();
+
+    uint64_t firstFrame = Clock::Now();
+
+    // Time from the input the camera was aimed with arriving to the frame being
+    // submitted, over frames that had new input
+    uint64_t latencyTotal = 0, latencyMax = 0, lastLatchedInput = 0;
+    uint32_t latencyFrames = 0;
+
+    // There's always a first frame to draw
+    Redraw::Request(RedrawReason::Expose);
 
     do {
-        time = (float) glfwGetTime();
+        PROFILE_ZONE("Frame");
 
-        glfwPollEvents();
+        bool idled = false;
 
-        // Update trackball state
-        int mouseX, mouseY;
-        glfwGetMousePos(&mouseX, &mouseY);
-        trackball.MouseUpdate(
-            glfwGetMouseButton(GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS,
-            mouseX, mouseY
-        );
+        if (onDemand && !Redraw::IsPending()) {
+            PROFILE_ZONE("Wait for events");
 
-        // Only render up to 60FPS
-        if (time - lastTime < 1/60.0f) continue;
+            // Nothing to draw, so sleep until something happens. Whatever woke
+            // us up gets drawn straight away, without waiting for the pacer.
+            Redraw::WaitForEvents(1.0 / FRAME_RATE);
+            pacer.Reset();
+            idled = true;
+        } else {
+            PROFILE_ZONE("Wait for frame");
 
-        // Update the transformation matrix
-        viewRotate = trackball.GetRotationMatrix();
-        
-        // Since viewRotate is orthonormal, its inverse transpose equals itself
-        glm::mat3 normalTransform(viewRotate);
-        glm::mat4 modelTransform = project * viewTranslate * viewRotate;
+            // Sleeps most of the way to the next frame instead of spinning. There's
+            // no display to keep pace with under the null driver.
+            if (!nullGL)
+                pacer.Wait();
+
+            glfwPollEvents();
+        }
+
+        if (onDemand && Redraw::Take() == 0)
+            continue;
+
+        const FrameState_t* state = frames.BeginRead();
+
+        // Anything the simulation made while we were idle is out of date
+        uint64_t resumeTime = idled ? Clock::Now() : 0;
+        while (state != NULL && state->producedAt < resumeTime) {
+            frames.EndRead();
+            state = frames.BeginRead();
+        }
+
+        if (state == NULL)
+            break;
+
+        // Keep drawing until the simulation has caught up with the latest input and settled
+        bool animating = !state->settled || state->steppedAt < input.timestamp.load();
+
+        uint64_t start = Clock::Now();
+
+        // Pick up any variants that have finished in the background
+        surfaceShaders->Update();
+
+        // Events can still flip the toggle later in the frame, so this frame goes with
+        // whatever it is now
+        bool drawNormals = showNormals;
+
+        if (drawNormals && normalLines == NULL) {
+            PROFILE_ZONE("Upload normal lines");
+
+            normalShader = surfaceShaders->Get(0);
+            if (normalShader != NULL) {
+                normalLines = MakeNormalLinesMesh(normalShader, modelLoad.normalLines);
+                vector<GLfloat>().swap(modelLoad.normalLines);
+            } else {
+                showNormals = drawNormals = false;
+            }
+        }
+
+        FrameSync::BeginFrame();
+        GPUProfiler::BeginFrame();
+        GLState::BeginFrame();
+        uniformRing->BeginFrame();
+
+        UniformRange_t lightRange = uniformRing->Push(state->lightBlock);
+
+        auto recordTextured = [&]() {
+            PROFILE_ZONE("Record textured pass");
+
+            RenderQueue& queue = passQueues[PASS_TEXTURED];
+            CommandList& commands = passCommands[PASS_TEXTURED];
+
+            commands.BeginGPUScope("Textured pass");
+            commands.SetUniformData(UniformBlockBinding::TransformBlock, state->transformBlock);
+
+            for (size_t i=0; i<drawModel->GetTextureBatchCount(); ++i) {
+                queue.Push(PASS_TEXTURED, textureShader, drawModel->GetBatchTexture(i),
+                    drawModel->GetTextureBatch(i), noTransform);
+            }
+
+            queue.Record(commands);
+            commands.EndGPUScope();
+        };
+
+        auto recordNormals = [&]() {
+            PROFILE_ZONE("Record normals pass");
+
+            RenderQueue& queue = passQueues[PASS_NORMALS];
+            CommandList& commands = passCommands[PASS_NORMALS];
+
+            commands.BeginGPUScope("Normals pass");
+            commands.SetUniformData(UniformBlockBinding::TransformBlock, state->transformBlock);
+
+            queue.Push(PASS_NORMALS, normalShader, NULL, normalLines, noTransform);
+            queue.Record(commands);
+            commands.EndGPUScope();
+        };
+
+        JobCounter recorders;
+        JobSystem::Run(recordTextured, &recorders);
+        if (drawNormals)
+            JobSystem::Run(recordNormals, &recorders);
+        JobSystem::Wait(&recorders);
+
+        FrameBlock_t frameBlock = state->frameBlock;
+        Trackball trackball = state->trackball;
+        uint64_t latchedInput = state->inputTime;
+
+        // Everything we need from the frame state has been copied out by now
+        frames.EndRead();
+
+        if (lateLatch) {
+            // Pick up any input that arrived while we were recording, and aim the
+            // camera at where the mouse is now. The camera block is the last thing
+            // written before the draws go out.
+            glfwPollEvents();
+
+            latchedInput = input.timestamp.load();
+            glm::mat4 viewRotate = trackball.GetLatchedRotationMatrix(input.mouseX.load(), input.mouseY.load());
+
+            frameBlock.viewTransform = project * viewTranslate * viewRotate;
+            PackMat3(frameBlock.viewNormalTransform, glm::mat3(viewRotate));
+        }
+
+        UniformRange_t frameRange = uniformRing->Push(frameBlock);
+
+        UniformRing::Bind(UniformBlockBinding::FrameBlock, frameRange);
+        UniformRing::Bind(UniformBlockBinding::LightBlock, lightRange);
+
+        GPUProfiler::BeginScope("Frame");
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Render model
-        //*
-        textureShader->Bind();
-        Program::SetUniform(textureShader->GetUniform("modelTransform"),  modelTransform);
-        Program::SetUniform(textureShader->GetUniform("normalTransform"), normalTransform);
+        uint64_t submitTime = Clock::Now();
+        if (latchedInput > lastLatchedInput) {
+            uint64_t latency = submitTime - latchedInput;
 
-        for (size_t i=0; i<meshes.size(); ++i) {
-            size_t texIndex = glm::min(textures.size()-1, i);
+            latencyTotal += latency;
+            latencyMax = std::max(latencyMax, latency);
+            ++latencyFrames;
 
-            Texture::Bind(0, textures[texIndex]);
-            meshes[i]->Render();
+            lastLatchedInput = latchedInput;
         }
-        //*/
 
-        //*
-        normalShader->Bind();
-        Program::SetUniform(normalShader->GetUniform("modelTransform"),  modelTransform);
-        Program::SetUniform(normalShader->GetUniform("normalTransform"), normalTransform);
+        {
+            PROFILE_ZONE("Submit");
+
+            // Uploads the recorded uniform data along with the frame's own, then draws.
+            // The normals pass is the last, so leaving it out is one list fewer.
+            CommandList::Submit(passCommandLists, drawNormals ? PASS_COUNT : PASS_NORMALS, *uniformRing);
+        }
+
+        GPUProfiler::EndScope();
+
+        for (int i=0; i<PASS_COUNT; ++i)
+            passCommands[i].Clear();
 
-        for (size_t i=0; i<meshes.size(); ++i)
-            meshes[i]->Render();
-        //*/
+        FrameSync::EndFrame();
 
-        glfwSwapBuffers();
-        lastTime = time;
+        renderTime += Clock::Now() - start;
+        ++renderFrames;
+
+        {
+            PROFILE_ZONE("Swap buffers");
+            GLDebugOutput::EndFrame();
+            GLCapture::EndFrame();
+            glfwSwapBuffers();
+        }
+
+        if (renderFrames == 1) {
+            uint64_t firstFrameReady = Clock::Now();
+
+            printf("Time to first frame %.1fms: context %.1fms, waiting on loads %.1fms, shaders %.1fms, uploads %.1fms, setup and first frame %.1fms\n",
+                Clock::ToMilliseconds(firstFrameReady - startupBegin),
+                Clock::ToMilliseconds(contextReady - startupBegin),
+                Clock::ToMilliseconds(loadsReady - contextReady),
+                Clock::ToMilliseconds(shadersReady - loadsReady),
+                Clock::ToMilliseconds(uploadsReady - shadersReady),
+                Clock::ToMilliseconds(firstFrameReady - uploadsReady));
+
+            printf("Startup loads: %.1fms of reads, decoding and shader preprocessing across %u workers\n",
+                Clock::ToMilliseconds(startupLoadTime.load() + surfaceShaders->GetStats().preprocessTime),
+                JobSystem::GetWorkerCount());
+        }
+
+        if (onDemand && animating)
+            Redraw::Request(RedrawReason::Animation);
 
     } while (
-        !glfwGetKey(GLFW_KEY_ESC) && 
-        glfwGetWindowParam(GLFW_OPENED)
+        (maxFrames == 0 || renderFrames < maxFrames) &&
+        (nullGL || (!glfwGetKey(GLFW_KEY_ESC) && glfwGetWindowParam(GLFW_OPENED)))
     );
 
+    frames.Close();
+    simulation.join();
+
+    if (renderFrames > 0) {
+        printf("Average CPU time per frame: simulation %.3fms, render %.3fms, frame %.3fms\n",
+            Clock::ToMilliseconds(simTime) / simFrames,
+            Clock::ToMilliseconds(renderTime) / renderFrames,
+            Clock::ToMilliseconds(Clock::Now() - firstFrame) / renderFrames);
+    }
+
+    if (renderFrames > 0 && !nullGL) {
+        const FramePacerStats_t& pacing = pacer.GetStats();
+        printf("Frame pacing: interval %.3fms +/- %.3fms (max %.3fms), lateness %.3fms (max %.3fms), %u missed\n",
+            Clock::ToMilliseconds((uint64_t)pacing.meanInterval),
+            Clock::ToMilliseconds((uint64_t)pacing.intervalStdDev),
+            Clock::ToMilliseconds(pacing.maxInterval),
+            Clock::ToMilliseconds((uint64_t)pacing.meanLateness),
+            Clock::ToMilliseconds(pacing.maxLateness),
+            pacing.missedFrames);
+
+        printf("Slept %.1fms and spun %.1fms in total; %u simulation steps\n",
+            Clock::ToMilliseconds(pacing.sleepTime), Clock::ToMilliseconds(pacing.spinTime), simSteps);
+    }
+
+    if (nullGL && renderFrames > 0) {
+        printf("Null GL: %.1f calls per frame over %u frames\n",
+            (double)NullGL::GetTotalCalls() / renderFrames, renderFrames);
+
+        std::vector<GLCallCount_t> calls;
+        NullGL::GetCallCounts(calls);
+
+        for (size_t i=0; i<calls.size() && i<NULL_GL_TOP_CALLS; ++i)
+            printf("  %-28s %8.2f per frame\n", calls[i].name, (double)calls[i].calls / renderFrames);
+    }
+
+    if (latencyFrames > 0) {
+        printf("Input to submit latency%s: %.3fms average, %.3fms max, over %u frames with new input\n",
+            lateLatch ? " (late latched)" : "",
+            Clock::ToMilliseconds(latencyTotal) / latencyFrames,
+            Clock::ToMilliseconds(latencyMax), latencyFrames);
+    }
+
+    if (profileGPU)
+        GPUProfiler::Dump();
+
+    GLDebugOutput::Dump();
+
+    if (lazyGL)
+        reportLazyGL(glFunctionsFile);
+
+    if (traceFile != NULL) {
+        if (CPUProfiler::WriteChromeTrace(traceFile))
+            printf("Wrote CPU trace to %s\n", traceFile);
+        else
+            fprintf(stderr, "Couldn't write CPU trace to %s\n", traceFile);
+    }
+
+    ShaderPermutationStats_t permutations = surfaceShaders->GetStats();
+    printf("Surface shaders: %u variants, %u precompiled, %u compiled on first use, %u stalls (%.3fms)\n",
+        permutations.variants, permutations.precompiled, permutations.lazyCompiles,
+        permutations.stalls, Clock::ToMilliseconds(permutations.stallTime));
+
+    if (onDemand) {
+        const RedrawStats_t& redraws = Redraw::GetStats();
+        printf("On demand: %u frames (input %u, animation %u, resource load %u, expose %u), idle %.1fs over %u waits\n",
+            redraws.frames,
+            redraws.framesByReason[0], redraws.framesByReason[1],
+            redraws.framesByReason[2], redraws.framesByReason[3],
+            Clock::ToSeconds(redraws.idleTime), redraws.idleWaits);
+    }
+
     // Cleanup
+    delete drawModel;
+    delete normalLines;
+
     for (auto it=meshes.begin(); it!=meshes.end(); ++it)
         delete (*it);
 
+    delete modelArena;
+
     for (size_t i=0; i<textures.size(); ++i)
         delete textures[i];
 
-    delete textureShader;
-    delete normalShader;
+    delete uniformRing;
+    GPUProfiler::Shutdown();
+    GLDebugOutput::Shutdown();
+    FrameSync::Shutdown();
+
+    cleanupStartup(&startupLoads, images, imageCount, modelLoad, surfaceShaders, shaderLibrary);
+    CPUProfiler::Shutdown();
+
+    if (GLCapture::IsCapturing()) {
+        const GLCaptureStats_t& capture = GLCapture::GetStats();
+        GLCapture::End();
+
+        printf("Captured %llu frames, %llu calls (%llu can't be replayed), %.1fMB to %s\n",
+            (unsigned long long)capture.frames, (unsigned long long)capture.calls,
+            (unsigned long long)capture.uncapturedCalls, capture.bytesWritten / (1024.0 * 1024.0), captureFile);
+    }
+
+    if (nullGL)
+        NullGL::Shutdown();
 
     glfwTerminate();
     return EXIT_SUCCESS;
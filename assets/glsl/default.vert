@@ -1,9 +1,14 @@
 #version 330 core
 
-//uniform Transform {
-uniform mat4 modelTransform;
-uniform mat3 normalTransform;
-//};// transform;
+layout(std140) uniform Frame {
+    mat4 viewTransform;
+    mat3 viewNormalTransform;
+};
+
+layout(std140) uniform Transform {
+    mat4 modelTransform;
+    mat3 normalTransform;
+};
 
 in VertexIn {
     vec4 coord;
@@ -13,17 +18,14 @@ in VertexIn {
 };
 
 out VertexData {
-    vec4 coord;
-    vec4 normal;
-    vec2 texCoord;
-    vec4 color;
+#include "vertexData.glsl"
 } vertexOut;
 
 void main(void) {
-    gl_Position         = modelTransform * coord;
+    gl_Position         = viewTransform * modelTransform * coord;
     
     vertexOut.coord     = gl_Position;
-    vertexOut.normal    = vec4(normalize(normalTransform * normal), 0.0);
+    vertexOut.normal    = vec4(normalize(viewNormalTransform * normalTransform * normal), 0.0);
     vertexOut.texCoord  = texCoord;
     vertexOut.color     = color;
 }
\ No newline at end of file
@@ -0,0 +1,24 @@
+#version 330 core
+
+#ifdef TEXTURED
+uniform sampler2D diffuseSampler;
+#endif
+
+layout(std140) uniform Light {
+    vec3 position;
+    vec3 intensity;
+} light;
+
+in VertexData {
+#include "vertexData.glsl"
+} fragIn;
+
+out vec4 color;
+
+void main(void) {
+#ifdef TEXTURED
+    color = texture(diffuseSampler, fragIn.texCoord);
+#else
+    color = fragIn.color;
+#endif
+}
@@ -0,0 +1,5 @@
+// Members of the VertexData block every stage hands to the next
+vec4 coord;
+vec4 normal;
+vec2 texCoord;
+vec4 color;